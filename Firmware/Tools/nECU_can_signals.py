@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+"""
+CAN signal database of nECU (Tools/nECU_can.dbc).
+
+Generates 'static inline' packers and unpackers for the firmware, and decodes
+captured frames on the host with the very same description, so adding a signal
+means editing the .dbc file only. Only plain DBC messages and signals are
+understood (BO_ / SG_ lines, no multiplexing).
+
+Usage:
+    nECU_can_signals.py gen                        (rewrite nECU/Inc/nECU_can_signals.h)
+    nECU_can_signals.py gen --check                (fail if header is out of date, for pre-build step)
+    nECU_can_signals.py decode candump.log         (candump or 'ID#DATA' lines, '-' for stdin)
+"""
+
+import argparse
+import os
+import re
+import sys
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DBC_PATH = os.path.join(TOOLS_DIR, "nECU_can.dbc")
+HEADER_PATH = os.path.join(TOOLS_DIR, "..", "nECU", "Inc", "nECU_can_signals.h")
+
+MESSAGE_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+SIGNAL_RE = re.compile(
+    r"^SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(([-+0-9.eE]+),([-+0-9.eE]+)\)\s*\[([-+0-9.eE]+)\|([-+0-9.eE]+)\]\s*\"([^\"]*)\"")
+
+
+class Signal:
+    def __init__(self, name, start, length, little_endian, signed, scale, offset, minimum, maximum, unit):
+        self.name = name
+        self.start = start
+        self.length = length
+        self.little_endian = little_endian
+        self.signed = signed
+        self.scale = scale
+        self.offset = offset
+        self.minimum = minimum
+        self.maximum = maximum
+        self.unit = unit
+
+    def bits(self):
+        """Returns payload bit positions (byte * 8 + bit) ordered from LSB to MSB of value."""
+        if self.little_endian:
+            return [self.start + index for index in range(self.length)]
+        position, result = self.start, []
+        for _ in range(self.length):  # Motorola, start bit is MSB
+            result.append(position)
+            position = position + 15 if position % 8 == 0 else position - 1
+        return result[::-1]
+
+    def chunks(self):
+        """Returns [(byte, shift in byte, shift in value, width)] covering whole signal."""
+        result = []
+        for value_bit, position in enumerate(self.bits()):
+            byte, bit = divmod(position, 8)
+            if result:
+                last_byte, last_shift, last_value, width = result[-1]
+                if last_byte == byte and last_shift + width == bit and last_value + width == value_bit:
+                    result[-1] = (last_byte, last_shift, last_value, width + 1)
+                    continue
+            result.append((byte, bit, value_bit, 1))
+        return result
+
+    def is_identity(self):
+        return self.scale == 1 and self.offset == 0
+
+    def is_integer(self):
+        return self.scale == 1 and float(self.offset).is_integer()
+
+    def c_type(self):
+        size = 8 if self.length <= 8 else 16 if self.length <= 16 else 32
+        return ("int%d_t" if self.signed else "uint%d_t") % size
+
+    def raw_range(self):
+        if self.signed:
+            return -(1 << (self.length - 1)), (1 << (self.length - 1)) - 1
+        return 0, (1 << self.length) - 1
+
+    def decode(self, data):
+        raw = 0
+        for byte, shift, value_shift, width in self.chunks():
+            raw |= ((data[byte] >> shift) & ((1 << width) - 1)) << value_shift
+        if self.signed and raw & (1 << (self.length - 1)):
+            raw -= 1 << self.length
+        return raw * self.scale + self.offset
+
+
+class Message:
+    def __init__(self, frame_id, name, dlc):
+        self.frame_id = frame_id
+        self.name = name
+        self.dlc = dlc
+        self.signals = []
+
+
+def number(text):
+    value = float(text)
+    return int(value) if value.is_integer() else value
+
+
+def read_dbc(path):
+    messages = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            match = MESSAGE_RE.match(line)
+            if match:
+                messages.append(Message(int(match[1]), match[2], int(match[3])))
+                continue
+            match = SIGNAL_RE.match(line)
+            if match:
+                if not messages:
+                    raise ValueError("signal %s outside of message" % match[1])
+                messages[-1].signals.append(Signal(
+                    match[1], int(match[2]), int(match[3]), match[4] == "1", match[5] == "-",
+                    number(match[6]), number(match[7]), number(match[8]), number(match[9]), match[10]))
+
+    for message in messages:  # signals must fit and must not overlap
+        used = set()
+        for signal in message.signals:
+            for position in signal.bits():
+                if position >= message.dlc * 8 or position in used:
+                    raise ValueError("signal %s.%s overlaps or exceeds DLC" % (message.name, signal.name))
+                used.add(position)
+    return messages
+
+
+def aligned(lines):
+    """Returns lines with trailing '//' comments aligned, as in hand written headers."""
+    width = max(len(line.split(" // ")[0]) for line in lines)
+    return [("%-*s // %s" % (width, *line.split(" // ", 1))) if " // " in line else line for line in lines]
+
+
+def c_number(value):
+    return "%d" % value if isinstance(value, int) else "%ff" % value
+
+
+def generate_header(messages):
+    out = []
+    emit = out.append
+    emit("/**")
+    emit(" ******************************************************************************")
+    emit(" * @file    nECU_can_signals.h")
+    emit(" * @brief   Packing of CAN frames described in Tools/nECU_can.dbc.")
+    emit(" *          Generated by Tools/nECU_can_signals.py, do not edit by hand.")
+    emit(" */")
+    emit("#ifndef _NECU_CAN_SIGNALS_H_")
+    emit("#define _NECU_CAN_SIGNALS_H_")
+    emit("")
+    emit("#ifdef __cplusplus")
+    emit("extern \"C\"")
+    emit("{")
+    emit("#endif")
+    emit("")
+    emit("/* Includes */")
+    emit("#include \"stdint.h\"")
+    emit("")
+    emit("/* Definitions */")
+    definitions = []
+    for message in messages:
+        definitions.append("#define CAN_MSG_%s_ID 0x%03X // CAN ID of %s frame" % (message.name.upper(), message.frame_id, message.name))
+        definitions.append("#define CAN_MSG_%s_DLC %d // payload length of %s frame" % (message.name.upper(), message.dlc, message.name))
+    out.extend(aligned(definitions))
+
+    for message in messages:
+        prefix = "nECU_CAN_%s" % message.name
+        emit("")
+        emit("    /* %s 0x%03X */" % (message.name, message.frame_id))
+        emit("    typedef struct")
+        emit("    {")
+        fields = []
+        for signal in message.signals:
+            low, high = signal.raw_range()
+            fields.append("        %s %s; // raw [%d|%d]%s" % (signal.c_type(), signal.name, low, high,
+                                                             ", %s" % signal.unit if signal.unit else ""))
+        out.extend(aligned(fields))
+        emit("    } %s_Signals;" % prefix)
+
+        # every byte written once, shifts and masks are constants
+        emit("    static inline void %s_Pack(uint8_t *data, %s_Signals const *signals) // fill payload with raw values"
+             % (prefix, prefix))
+        emit("    {")
+        for byte in range(message.dlc):
+            terms = []
+            for signal in message.signals:
+                for chunk_byte, shift, value_shift, width in signal.chunks():
+                    if chunk_byte != byte:
+                        continue
+                    term = "(uint32_t)signals->%s" % signal.name
+                    if value_shift:
+                        term = "(%s >> %d)" % (term, value_shift)
+                    term = "(%s & 0x%X)" % (term, (1 << width) - 1)
+                    if shift:
+                        term = "(%s << %d)" % (term, shift)
+                    terms.append(term)
+            emit("        data[%d] = (uint8_t)(%s);" % (byte, " | ".join(terms) if terms else "0"))
+        emit("    }")
+
+        emit("    static inline void %s_Unpack(%s_Signals *signals, uint8_t const *data) // read raw values from payload"
+             % (prefix, prefix))
+        emit("    {")
+        for signal in message.signals:
+            terms = []
+            for byte, shift, value_shift, width in signal.chunks():
+                term = "(uint32_t)data[%d]" % byte
+                if shift:
+                    term = "(%s >> %d)" % (term, shift)
+                term = "(%s & 0x%X)" % (term, (1 << width) - 1)
+                if value_shift:
+                    term = "(%s << %d)" % (term, value_shift)
+                terms.append(term)
+            expression = " | ".join(terms)
+            if signal.signed:  # sign extension by shifting to the top of 32 bits
+                expression = "(int32_t)((%s) << %d) >> %d" % (expression, 32 - signal.length, 32 - signal.length)
+            emit("        signals->%s = (%s)(%s);" % (signal.name, signal.c_type(), expression))
+        emit("    }")
+
+        for signal in message.signals:
+            if signal.is_identity():
+                continue
+            low, high = signal.raw_range()
+            name = "%s_%s" % (prefix, signal.name)
+            if signal.is_integer():
+                emit("    static inline %s %s_Encode(int32_t physical) // physical value to raw, saturated"
+                     % (signal.c_type(), name))
+                emit("    {")
+                emit("        int32_t raw = physical - (%d);" % signal.offset)
+            else:
+                emit("    static inline %s %s_Encode(float physical) // physical value to raw, saturated"
+                     % (signal.c_type(), name))
+                emit("    {")
+                emit("        float scaled = (physical - (%s)) * %s;" % (c_number(float(signal.offset)),
+                                                                     c_number(1.0 / signal.scale)))
+                emit("        int32_t raw = (int32_t)(scaled + ((scaled < 0) ? -0.5f : 0.5f));")
+            emit("        raw = (raw < %d) ? %d : raw;" % (low, low))
+            emit("        raw = (raw > %d) ? %d : raw;" % (high, high))
+            emit("        return (%s)raw;" % signal.c_type())
+            emit("    }")
+            if signal.is_integer():
+                emit("    static inline int32_t %s_Decode(%s raw) // raw value to physical" % (name, signal.c_type()))
+                emit("    {")
+                emit("        return (int32_t)raw + (%d);" % signal.offset)
+            else:
+                emit("    static inline float %s_Decode(%s raw) // raw value to physical" % (name, signal.c_type()))
+                emit("    {")
+                emit("        return ((float)raw * %s) + (%s);" % (c_number(float(signal.scale)),
+                                                                c_number(float(signal.offset))))
+            emit("    }")
+
+    emit("")
+    emit("#ifdef __cplusplus")
+    emit("}")
+    emit("#endif")
+    emit("")
+    emit("#endif /* _NECU_CAN_SIGNALS_H_ */")
+    emit("")
+    return "\n".join(out)
+
+
+CANDUMP_RE = re.compile(r"([0-9A-Fa-f]{3,8})\s+\[(\d)\]\s+((?:[0-9A-Fa-f]{2}\s*)*)")
+COMPACT_RE = re.compile(r"([0-9A-Fa-f]{3,8})#([0-9A-Fa-f]*)")
+
+
+def decode(messages, stream):
+    by_id = {message.frame_id: message for message in messages}
+    for line in stream:
+        match = COMPACT_RE.search(line) or CANDUMP_RE.search(line)
+        if not match:
+            continue
+        frame_id = int(match[1], 16)
+        payload = match[match.lastindex]
+        data = bytes.fromhex(payload.replace(" ", ""))
+        message = by_id.get(frame_id)
+        if message is None or len(data) < message.dlc:
+            continue
+        values = []
+        for signal in message.signals:
+            value = signal.decode(data)
+            values.append("%s=%s%s" % (signal.name, value, signal.unit if signal.unit else ""))
+        print("0x%03X %s: %s" % (frame_id, message.name, " ".join(values)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="nECU CAN signal database tool")
+    parser.add_argument("--dbc", default=DBC_PATH, help="signal database")
+    commands = parser.add_subparsers(dest="command", required=True)
+    gen = commands.add_parser("gen", help="generate C header")
+    gen.add_argument("--output", default=HEADER_PATH)
+    gen.add_argument("--check", action="store_true", help="only verify that header is up to date")
+    dec = commands.add_parser("decode", help="decode captured frames")
+    dec.add_argument("capture", help="candump log, '-' for stdin")
+    args = parser.parse_args()
+
+    messages = read_dbc(args.dbc)
+    if args.command == "gen":
+        text = generate_header(messages)
+        if args.check:
+            current = open(args.output).read() if os.path.exists(args.output) else ""
+            if current != text:
+                sys.exit("%s is out of date, run: %s gen" % (args.output, sys.argv[0]))
+            return
+        with open(args.output, "w", newline="\n") as f:
+            f.write(text)
+    else:
+        stream = sys.stdin if args.capture == "-" else open(args.capture)
+        decode(messages, stream)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ * @file    nECU_isotp_loopback.c
+ * @brief   Host loopback test of nECU/Src/nECU_isotp_link.c.
+ *          Two links talk over virtual bus, tick and cycle counter are stubbed
+ *          so separation time and timeouts run on virtual time.
+ *
+ *          Build and run from Firmware directory:
+ *          gcc -O2 -DSTM32F415xx -DUSE_HAL_DRIVER -InECU/Inc -ICore/Inc
+ *              -IDrivers/STM32F4xx_HAL_Driver/Inc -IDrivers/CMSIS/Device/ST/STM32F4xx/Include
+ *              -IDrivers/CMSIS/Include Tools/nECU_isotp_loopback.c nECU/Src/nECU_isotp_link.c
+ *              -o isotp_loopback && ./isotp_loopback
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "nECU_isotp_link.h"
+
+#define LOOPBACK_BUS_LEN 8        // frames held by virtual bus, like TX queue of 'hcan1'
+#define LOOPBACK_STEP_US 100      // virtual time passed while bus is idle [us]
+#define LOOPBACK_STEPS_MAX 100000 // idle steps after which transfer is considered stuck
+#define LOOPBACK_RANDOM 1000      // messages of random length and flow control
+#define LOOPBACK_CLOCK 168000000  // core clock of target [Hz]
+
+/* Stubs of target timing */
+uint32_t SystemCoreClock = LOOPBACK_CLOCK;
+static uint64_t virtual_us = 0; // time since start of test [us]
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(virtual_us / 1000);
+}
+uint32_t nECU_CycleCounter_Get(void)
+{
+    return (uint32_t)(virtual_us * (LOOPBACK_CLOCK / 1000000));
+}
+uint32_t nECU_CycleCounter_toUs(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+/* Virtual bus */
+static struct
+{
+    uint32_t ID[LOOPBACK_BUS_LEN];
+    uint8_t data[LOOPBACK_BUS_LEN][8];
+    uint8_t count;
+    uint32_t drop;       // frame number to be lost on bus (0 - none)
+    uint32_t delivered;  // frames taken from bus
+    uint64_t last_CF_us; // time of previous consecutive frame
+    uint32_t min_CF_gap; // shortest time between consecutive frames of one block [us]
+} bus;
+
+static bool loopback_Bus_Send(uint32_t ID, uint8_t const *data) // output of both links
+{
+    if (bus.count >= LOOPBACK_BUS_LEN)
+        return true; // like full TX queue, sender retries on next TX callback
+    bus.ID[bus.count] = ID;
+    memcpy(bus.data[bus.count], data, 8);
+    bus.count++;
+    return false;
+}
+static void loopback_Bus_Reset(void)
+{
+    memset(&bus, 0, sizeof(bus));
+    bus.min_CF_gap = UINT32_MAX;
+}
+static bool loopback_Bus_Run(nECU_ISOTP_Link *A, nECU_ISOTP_Link *B) // deliver frames and pass time until both links are quiet, returns false if they never settle
+{
+    for (uint32_t step = 0; step < LOOPBACK_STEPS_MAX; step++)
+    {
+        if (bus.count == 0)
+        {
+            if (A->tx_state != ISOTP_STATE_SENDING && B->tx_state != ISOTP_STATE_SENDING)
+                return true;
+            virtual_us += LOOPBACK_STEP_US; // separation time, routine tries again
+            nECU_ISOTP_Link_Continue(A);
+            nECU_ISOTP_Link_Continue(B);
+            continue;
+        }
+
+        uint32_t ID = bus.ID[0];
+        uint8_t data[8];
+        memcpy(data, bus.data[0], sizeof(data));
+        bus.count--;
+        memmove(&bus.ID[0], &bus.ID[1], bus.count * sizeof(bus.ID[0]));
+        memmove(bus.data[0], bus.data[1], bus.count * sizeof(bus.data[0]));
+
+        nECU_ISOTP_Link *receiver = (ID == A->rx_ID) ? A : B;
+        nECU_ISOTP_Link *sender = (ID == A->rx_ID) ? B : A;
+        if (++bus.delivered != bus.drop || bus.drop == 0)
+        {
+            if ((data[0] >> 4) == ISOTP_PCI_CONSECUTIVE)
+            {
+                if (bus.last_CF_us && (virtual_us - bus.last_CF_us) < bus.min_CF_gap)
+                    bus.min_CF_gap = virtual_us - bus.last_CF_us;
+                bus.last_CF_us = virtual_us;
+            }
+            else
+                bus.last_CF_us = 0; // gap after flow control is not limited
+            nECU_ISOTP_Link_Frame(receiver, data, sizeof(data));
+        }
+        nECU_ISOTP_Link_Continue(sender); // frame left the bus, like TX mailbox interrupt
+    }
+    return false;
+}
+
+/* Tests */
+static nECU_ISOTP_Link A, B;
+static uint8_t A_buffer[ISOTP_MESSAGE_MAX], B_buffer[ISOTP_MESSAGE_MAX], message[ISOTP_MESSAGE_MAX];
+
+static void loopback_Init(uint16_t B_size) // fresh links, B receives into buffer of given size
+{
+    loopback_Bus_Reset();
+    nECU_ISOTP_Link_Init(&A, 0x7E0, 0x7E8, loopback_Bus_Send, A_buffer, sizeof(A_buffer));
+    nECU_ISOTP_Link_Init(&B, 0x7E8, 0x7E0, loopback_Bus_Send, B_buffer, B_size);
+    memset(B_buffer, 0, sizeof(B_buffer));
+}
+static bool loopback_Transfer(uint16_t length) // send message from A to B, returns true if it arrived intact
+{
+    return !nECU_ISOTP_Link_Send(&A, message, length) && loopback_Bus_Run(&A, &B) &&
+           A.tx_state == ISOTP_STATE_IDLE && B.rx_done == length && !memcmp(B_buffer, message, length);
+}
+static bool loopback_Basic(void) // single frame, segmented message with wrapping sequence and blocks, busy link
+{
+    loopback_Init(sizeof(B_buffer));
+    B.block_size = 4;
+    bool status = loopback_Transfer(5);
+    status &= loopback_Transfer(300);
+    status &= loopback_Transfer(ISOTP_MESSAGE_MAX);
+
+    status &= !nECU_ISOTP_Link_Send(&A, message, 100) && nECU_ISOTP_Link_Send(&A, message, 10); // second message refused while first is sent
+    status &= loopback_Bus_Run(&A, &B);
+    status &= nECU_ISOTP_Link_Send(&A, message, 0) && nECU_ISOTP_Link_Send(&A, message, ISOTP_MESSAGE_MAX + 1); // invalid lengths
+
+    status &= (A.tx_count == 4) && (B.rx_count == 4) && (A.error_count == 0) && (B.error_count == 0);
+    printf("Basic: %s\n", status ? "passed" : "failed");
+    return status;
+}
+static bool loopback_Separation(void) // consecutive frames respect STmin of receiver
+{
+    loopback_Init(sizeof(B_buffer));
+    B.block_size = 8;
+    B.STmin = 5; // [ms]
+    bool status = loopback_Transfer(200);
+    status &= (bus.min_CF_gap >= 5000);
+
+    loopback_Init(sizeof(B_buffer));
+    B.STmin = 0xF3; // 300 us
+    status &= loopback_Transfer(200);
+    status &= (bus.min_CF_gap >= 300) && (bus.min_CF_gap < 5000);
+
+    printf("Separation time: shortest gap %lu us, %s\n", (unsigned long)bus.min_CF_gap, status ? "passed" : "failed");
+    return status;
+}
+static bool loopback_Faults(void) // overflow, lost frame and silent peer end transfers with error
+{
+    loopback_Init(50); // buffer too small
+    bool status = !nECU_ISOTP_Link_Send(&A, message, 100) && loopback_Bus_Run(&A, &B);
+    status &= (A.tx_state == ISOTP_STATE_IDLE) && (A.error_count == 1) && (B.error_count == 1) && (B.rx_done == 0);
+
+    loopback_Init(sizeof(B_buffer));
+    bus.drop = 4; // first frame, flow control, CF 1, CF 2 is lost
+    status &= !nECU_ISOTP_Link_Send(&A, message, 100) && loopback_Bus_Run(&A, &B);
+    status &= (B.error_count == 1) && (B.rx_done == 0) && (B.rx_state == ISOTP_STATE_IDLE);
+
+    loopback_Init(sizeof(B_buffer));
+    bus.drop = 2; // flow control is lost, sender waits
+    status &= !nECU_ISOTP_Link_Send(&A, message, 100) && loopback_Bus_Run(&A, &B);
+    status &= (A.tx_state == ISOTP_STATE_WAIT_FC) && (B.rx_state == ISOTP_STATE_RECEIVING);
+    virtual_us += ISOTP_TIMEOUT * 1000;
+    nECU_ISOTP_Link_Timeout(&A);
+    nECU_ISOTP_Link_Timeout(&B);
+    status &= (A.tx_state == ISOTP_STATE_WAIT_FC) && (B.rx_state == ISOTP_STATE_RECEIVING); // not after exactly timeout
+    virtual_us += 1000;
+    nECU_ISOTP_Link_Timeout(&A);
+    nECU_ISOTP_Link_Timeout(&B);
+    status &= (A.tx_state == ISOTP_STATE_IDLE) && (B.rx_state == ISOTP_STATE_IDLE) && (A.error_count == 1) && (B.error_count == 1);
+
+    printf("Faults: %s\n", status ? "passed" : "failed");
+    return status;
+}
+static bool loopback_Random(void) // messages of random length under random flow control
+{
+    srand(12345);
+    loopback_Init(sizeof(B_buffer));
+    uint32_t failed = 0;
+    for (uint16_t round = 0; round < LOOPBACK_RANDOM; round++)
+    {
+        for (uint16_t index = 0; index < sizeof(message); index++)
+            message[index] = rand();
+        B.block_size = rand() % 20;
+        B.STmin = (rand() % 4) ? 0 : (rand() % 3);
+        uint16_t length = 1 + (rand() % ISOTP_MESSAGE_MAX);
+        if (!loopback_Transfer(length))
+            failed++;
+    }
+
+    bool status = (failed == 0) && (A.error_count == 0) && (B.error_count == 0);
+    printf("Random: %u messages, %lu failed, %s\n", LOOPBACK_RANDOM, (unsigned long)failed, status ? "passed" : "failed");
+    return status;
+}
+
+int main(void)
+{
+    for (uint16_t index = 0; index < sizeof(message); index++)
+        message[index] = index * 7;
+
+    bool status = true;
+    status &= loopback_Basic();
+    status &= loopback_Separation();
+    status &= loopback_Faults();
+    status &= loopback_Random();
+
+    printf(status ? "OK\n" : "FAIL\n");
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Decoder of nECU binary log (nECU/Src/nECU_log.c).
+
+Format strings are read from '.log_fmt' section of firmware ELF, record ID is
+address of its string. Frames are searched in the byte stream, anything that is
+not a valid frame (printf output of reports) is passed through as text.
+
+Usage:
+    nECU_log_decode.py firmware.elf capture.bin
+    nECU_log_decode.py firmware.elf /dev/ttyACM0 --baud 230400   (needs pyserial)
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SYNC = 0xA5
+LOG_ARGS_MAX = 4
+LOG_HEADER_LEN = 8
+
+
+def read_formats(elf_path):
+    """Returns {ID: format string} from '.log_fmt' section of ELF32 file."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError("not a 32 bit ELF file")
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        return struct.unpack_from("<IIIIIIIIII", elf, e_shoff + index * e_shentsize)
+
+    names_offset = section(e_shstrndx)[4]
+    for index in range(e_shnum):
+        name, _, _, addr, offset, size = section(index)[:6]
+        end = elf.index(b"\0", names_offset + name)
+        if elf[names_offset + name:end] != b".log_fmt":
+            continue
+        formats = {}
+        data = elf[offset:offset + size]
+        position = 0
+        while position < len(data):
+            end = data.find(b"\0", position)
+            if end < 0:
+                end = len(data)
+            if end > position:
+                formats[(addr + position) & 0xFFFF] = data[position:end].decode("ascii", "replace")
+            position = end + 1
+        return formats
+    raise ValueError("ELF has no '.log_fmt' section, check linker script")
+
+
+def read_modules(types_path):
+    """Returns list of nECU_Module_ID names in enum order, used by '%M'."""
+    with open(types_path) as f:
+        text = f.read()
+    body = re.search(r"typedef enum\s*\{([^}]*)\}\s*nECU_Module_ID;", text).group(1)
+    body = re.sub(r"//[^\n]*", "", body)
+    return [name.strip() for name in body.split(",") if name.strip() and name.strip() != "D_ID_MAX"]
+
+
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z)?([diuxXcfeEgGsM%])")
+
+
+def format_record(fmt, args, modules):
+    """Rebuilds text like printf, arguments are raw 32 bit values."""
+    args = list(args)
+
+    def convert(match):
+        flags, _, kind = match.groups()
+        if kind == "%":
+            return "%"
+        if not args:
+            return "<missing>"
+        raw = args.pop(0)
+        if kind == "M":
+            return modules[raw] if raw < len(modules) else "block %u" % raw
+        if kind in "di":
+            return ("%" + flags + "d") % struct.unpack("<i", struct.pack("<I", raw))[0]
+        if kind == "u":
+            return ("%" + flags + "d") % raw
+        if kind in "fFeEgG":
+            return ("%" + flags + kind) % struct.unpack("<f", struct.pack("<I", raw))[0]
+        if kind == "c":
+            return chr(raw & 0xFF)
+        if kind == "s":
+            return "<string>"
+        return ("%" + flags + kind) % raw
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, formats, modules, out, follow=False):
+    """Splits byte stream into frames and text, writes decoded lines to out."""
+    buffer = bytearray()
+    text = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if follow:  # serial port timeout, keep on listening
+                continue
+            break
+        buffer += chunk
+        while buffer:
+            if buffer[0] != LOG_SYNC:
+                text.append(buffer.pop(0))
+                continue
+            if len(buffer) < LOG_HEADER_LEN:
+                break
+            argc = buffer[3]
+            length = LOG_HEADER_LEN + 4 * argc + 1
+            if argc > LOG_ARGS_MAX:
+                text.append(buffer.pop(0))
+                continue
+            if len(buffer) < length:
+                break
+            checksum = 0
+            for byte in buffer[1:length - 1]:
+                checksum ^= byte
+            if checksum != buffer[length - 1]:
+                text.append(buffer.pop(0))
+                continue
+
+            if text:
+                out.write(text.decode("ascii", "replace"))
+                text.clear()
+            format_id, _, timestamp = struct.unpack_from("<HBI", buffer, 1)
+            args = struct.unpack_from("<%dI" % argc, buffer, LOG_HEADER_LEN)
+            fmt = formats.get(format_id)
+            if fmt is None:
+                line = "unknown format 0x%04X %s" % (format_id, " ".join("0x%08X" % a for a in args))
+            else:
+                line = format_record(fmt, args, modules)
+            out.write("[%10.3f] %s\n" % (timestamp / 1000.0, line))
+            del buffer[:length]
+        out.flush()
+    if text:
+        out.write(text.decode("ascii", "replace"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode nECU binary log")
+    parser.add_argument("elf", help="firmware ELF file matching the device")
+    parser.add_argument("source", help="capture file or serial port")
+    parser.add_argument("--baud", type=int, help="open source as serial port with this baud rate")
+    parser.add_argument("--types", default=None, help="path to nECU_types.h, used to print block names ('%%M')")
+    options = parser.parse_args()
+
+    formats = read_formats(options.elf)
+    modules = read_modules(options.types) if options.types else []
+    if options.baud:
+        import serial  # pyserial
+        stream = serial.Serial(options.source, options.baud, timeout=0.1)
+    else:
+        stream = open(options.source, "rb")
+    with stream:
+        decode(stream, formats, modules, sys.stdout, follow=bool(options.baud))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,167 @@
+/**
+ ******************************************************************************
+ * @file    nECU_seqlock_stress.c
+ * @brief   Host stress test of nECU/Src/nECU_seqlock.c with threads.
+ *          Seqlock: writer thread updates data while reader threads on other
+ *          cores copy it, every copy has to be consistent with its sequence.
+ *          Snapshot: readers have to preempt writer, so signal handler running
+ *          on writer thread takes the place of interrupt reading mid update.
+ *
+ *          Build and run from Firmware directory:
+ *          gcc -O2 -pthread -DSTM32F415xx -DUSE_HAL_DRIVER -InECU/Inc -ICore/Inc
+ *              -IDrivers/STM32F4xx_HAL_Driver/Inc -IDrivers/CMSIS/Device/ST/STM32F4xx/Include
+ *              -IDrivers/CMSIS/Include Tools/nECU_seqlock_stress.c nECU/Src/nECU_seqlock.c
+ *              -o seqlock_stress && ./seqlock_stress
+ ******************************************************************************
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include "nECU_seqlock.h"
+
+#define STRESS_WORDS 16          // words of guarded data, copy of it spans many instructions
+#define STRESS_READERS 3         // reader threads of seqlock
+#define STRESS_WRITES 100000     // updates done by writer of seqlock
+#define STRESS_INTERRUPTS 10000  // signals taken by writer of snapshot
+
+typedef struct
+{
+    uint32_t word[STRESS_WORDS]; // every word holds number of update
+} stress_data;
+
+static nECU_Seqlock lock;
+static stress_data guarded;
+static nECU_Snapshot snap;
+static stress_data buffers[2];
+
+static atomic_bool writer_done;
+static atomic_uint_least32_t errors, reads, busy, interrupts;
+
+/* Seqlock */
+static void *stress_Seqlock_Writer(void *arg) // update guarded data as fast as possible
+{
+    (void)arg;
+    for (uint32_t update = 1; update <= STRESS_WRITES; update++)
+    {
+        nECU_Seqlock_Write_Begin(&lock);
+        for (uint8_t index = 0; index < STRESS_WORDS; index++)
+            ((volatile uint32_t *)guarded.word)[index] = update;
+        nECU_Seqlock_Write_End(&lock);
+    }
+    atomic_store(&writer_done, true);
+    return NULL;
+}
+static void *stress_Seqlock_Reader(void *arg) // copy data until writer is done, check every copy
+{
+    (void)arg;
+    uint32_t previous = 0;
+    while (!atomic_load(&writer_done))
+    {
+        stress_data copy;
+        uint32_t sequence;
+        if (!nECU_Seqlock_Read(&lock, &copy, &guarded, sizeof(copy), &sequence))
+        {
+            atomic_fetch_add(&busy, 1);
+            continue;
+        }
+        atomic_fetch_add(&reads, 1);
+
+        bool torn = (sequence & 1) || (sequence < previous);
+        for (uint8_t index = 0; index < STRESS_WORDS; index++)
+            torn |= (copy.word[index] != sequence / 2); // each update moves sequence by 2
+        if (torn)
+            atomic_fetch_add(&errors, 1);
+        previous = sequence;
+    }
+    return NULL;
+}
+static bool stress_Seqlock(void) // run writer against concurrent readers
+{
+    pthread_t writer, reader[STRESS_READERS];
+    atomic_store(&writer_done, false);
+    atomic_store(&errors, 0);
+    atomic_store(&reads, 0);
+    atomic_store(&busy, 0);
+
+    for (uint8_t index = 0; index < STRESS_READERS; index++)
+        pthread_create(&reader[index], NULL, stress_Seqlock_Reader, NULL);
+    pthread_create(&writer, NULL, stress_Seqlock_Writer, NULL);
+    pthread_join(writer, NULL);
+    for (uint8_t index = 0; index < STRESS_READERS; index++)
+        pthread_join(reader[index], NULL);
+
+    printf("Seqlock: %lu consistent reads, %lu gave up on busy writer, %lu torn\n",
+           (unsigned long)atomic_load(&reads), (unsigned long)atomic_load(&busy), (unsigned long)atomic_load(&errors));
+    return atomic_load(&errors) == 0 && atomic_load(&reads) > 0;
+}
+
+/* Snapshot */
+static void stress_Snapshot_Interrupt(int signal) // reader preempting writer, like CAN TX release
+{
+    (void)signal;
+    static uint32_t previous = 0; // only one handler runs at a time, it is always on writer thread
+    stress_data copy;
+    uint32_t sequence = nECU_Snapshot_Read(&snap, &copy, buffers, sizeof(copy));
+
+    bool torn = ((int32_t)(sequence - previous) < 0); // sets are published fast enough to wrap sequence
+    for (uint8_t index = 0; index < STRESS_WORDS; index++)
+        torn |= (copy.word[index] != sequence); // set published as n-th holds n
+    if (torn)
+        atomic_fetch_add(&errors, 1);
+    previous = sequence;
+    atomic_fetch_add(&reads, 1);
+}
+static void *stress_Snapshot_Writer(void *arg) // publish sets until enough interrupts were taken
+{
+    (void)arg;
+    for (uint32_t set = 1; atomic_load(&reads) < STRESS_INTERRUPTS; set++)
+    {
+        volatile uint32_t *next = nECU_Snapshot_Write_Begin(&snap, buffers, sizeof(buffers[0]));
+        for (uint8_t index = 0; index < STRESS_WORDS; index++)
+            next[index] = set;
+        nECU_Snapshot_Write_End(&snap);
+    }
+    atomic_store(&writer_done, true);
+    return NULL;
+}
+static bool stress_Snapshot(void) // interrupt writer with signals that read snapshot
+{
+    pthread_t writer;
+    atomic_store(&writer_done, false);
+    atomic_store(&errors, 0);
+    atomic_store(&reads, 0);
+    atomic_store(&interrupts, 0);
+
+    struct sigaction action = {0};
+    action.sa_handler = stress_Snapshot_Interrupt;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, NULL);
+
+    pthread_create(&writer, NULL, stress_Snapshot_Writer, NULL);
+    while (!atomic_load(&writer_done))
+    {
+        uint32_t taken = atomic_load(&reads);
+        pthread_kill(writer, SIGUSR1);
+        atomic_fetch_add(&interrupts, 1);
+        while (atomic_load(&reads) == taken && !atomic_load(&writer_done)) // next interrupt after this one was taken
+            sched_yield();
+    }
+    pthread_join(writer, NULL);
+
+    printf("Snapshot: %lu signals sent, %lu interrupting reads, %lu torn\n",
+           (unsigned long)atomic_load(&interrupts), (unsigned long)atomic_load(&reads), (unsigned long)atomic_load(&errors));
+    return atomic_load(&errors) == 0;
+}
+
+int main(void)
+{
+    bool status = true;
+    status &= nECU_Seqlock_test(true); // same checks as on target first
+    status &= stress_Seqlock();
+    status &= stress_Snapshot();
+
+    printf(status ? "OK\n" : "FAIL\n");
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -23,7 +23,9 @@
 #include "nECU_types.h"
 
 #include "nECU_adc.h"
+#include "nECU_boot.h"
 #include "nECU_button.h"
+#include "nECU_calibration.h"
 #include "nECU_can.h"
 #include "nECU_data_processing.h"
 #include "nECU_debug.h"
@@ -33,14 +35,23 @@
 #include "nECU_frames.h"
 #include "nECU_Input_Analog.h"
 #include "nECU_Input_Frequency.h"
+#include "nECU_isotp.h"
+#include "nECU_isotp_link.h"
 #include "nECU_Knock.h"
+#include "nECU_log.h"
 #include "nECU_main.h"
 #include "nECU_menu.h"
 #include "nECU_OnBoardLED.h"
 #include "nECU_PC.h"
+#include "nECU_queue.h"
+#include "nECU_scheduler.h"
+#include "nECU_scope.h"
+#include "nECU_seqlock.h"
 #include "nECU_spi.h"
 #include "nECU_stock.h"
 #include "nECU_table.h"
 #include "nECU_tests.h"
 #include "nECU_tim.h"
-#include "nECU_UART.h"
\ No newline at end of file
+#include "nECU_UART.h"
+#include "nECU_watchdog.h"
+#include "nECU_xcp.h"
\ No newline at end of file
@@ -20,6 +20,7 @@ extern "C"
 #include "nECU_spi.h"
 #include "gpio.h"
 #include "nECU_debug.h"
+#include "nECU_seqlock.h"
 
 /* Definitions */
 #define EGT_DECIMAL_POINT 0     // Specifies how many numbers should be after decimal point
@@ -34,11 +35,13 @@ extern "C"
 
     bool nECU_EGT_Start(void);         // initialize all sensors and start communication
     bool nECU_EGT_Stop(void);          // stop the routines
+    bool nECU_EGT_isReady(void);       // returns true once sensors finished their startup
     void nECU_EGT_Routine(void);       // periodic function to be called every main loop execution
     void nECU_EGT_RequestUpdate(void); // indicate that update is needed
 
     void nECU_EGT_Callback(void);       // callback from SPI_TX end callback
     void nECU_EGT_Error_Callback(void); // Callback after SPI communication fail
+    static void nECU_EGT_Next(void);    // start transfer of next working sensor
 
     static bool nECU_EGT_Start_Single(EGT_Sensor_ID ID); // Perform start for single sensor
     static bool nECU_EGT_Stop_Single(EGT_Sensor_ID ID);  // Perform stop for single sensor
@@ -46,7 +49,7 @@ extern "C"
     static bool MAX31855_Init(MAX31855 *inst, GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin); // First initialization
     static void MAX31855_collectError(MAX31855 *inst);                                 // get current error value
     static void MAX31855_UpdateSimple(MAX31855 *inst, SPI_HandleTypeDef *hspi);        // Recive data over SPI and convert it into struct, dont use while in DMA mode
-    static void MAX31855_ConvertData(MAX31855 *inst);                                  // For internal use bit decoding and data interpretation
+    static void MAX31855_ConvertData(MAX31855 *inst, uint8_t const *raw);              // For internal use bit decoding and data interpretation
 
 #ifdef __cplusplus
 }
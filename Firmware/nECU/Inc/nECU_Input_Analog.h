@@ -17,6 +17,7 @@ extern "C"
 #include "nECU_types.h"
 #include "nECU_tim.h"
 #include "nECU_debug.h"
+#include "nECU_Input_Frequency.h"
 
 /* Definitions */
 #define INTERNAL_TEMP_UPDATE_DELAY 1000 // once per second (1000ms)
@@ -24,17 +25,21 @@ extern "C"
     /* typedef */
 
     /* Function Prototypes */
+    static float nECU_InputAnalog_Vref_getFactor(void); // returns ratio of measured reference to the nominal one
     float nECU_correctToVref(float input);
 
     /*ADC 1*/
     bool nECU_InputAnalog_ADC1_Start(nECU_ADC1_ID ID);
     bool nECU_InputAnalog_ADC1_Stop(nECU_ADC1_ID ID);
     void nECU_InputAnalog_ADC1_Routine(nECU_ADC1_ID ID);
+    void nECU_InputAnalog_ADC1_Routine_Batch(void);        // update all working sensors of ADC1 in single pass
+    static void nECU_InputAnalog_ADC1_Sync_Select(void);   // connect sensors to per event results while engine is running, to averaged data otherwise
     float nECU_InputAnalog_ADC1_getValue(nECU_ADC1_ID ID); // returns output value
     /*ADC 2*/
     bool nECU_InputAnalog_ADC2_Start(nECU_ADC2_ID ID);
     bool nECU_InputAnalog_ADC2_Stop(nECU_ADC2_ID ID);
     void nECU_InputAnalog_ADC2_Routine(nECU_ADC2_ID ID);
+    void nECU_InputAnalog_ADC2_Routine_Batch(void);        // update all working sensors of ADC2 in single pass
     float nECU_InputAnalog_ADC2_getValue(nECU_ADC2_ID ID); // returns output value
 
 #ifdef __cplusplus
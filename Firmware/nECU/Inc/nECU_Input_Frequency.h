@@ -27,6 +27,8 @@ extern "C"
     bool nECU_FreqInput_Start(nECU_Freq_ID ID);
     bool nECU_FreqInput_Stop(nECU_Freq_ID ID);
     void nECU_FreqInput_Routine(nECU_Freq_ID ID);
+    void nECU_FreqInput_Routine_Batch(void);              // update all working frequency sensors in single pass
+    static void nECU_FreqInput_Snapshot(nECU_Freq_ID ID); // copy frequency written in interrupt as input of sensor bank
 
     float nECU_FreqInput_getValue(nECU_Freq_ID ID);
 
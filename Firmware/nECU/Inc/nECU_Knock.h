@@ -18,6 +18,7 @@ extern "C"
 #include "nECU_adc.h"
 #include "nECU_tim.h"
 #include "nECU_table.h"
+#include "nECU_calibration.h"
 
 /* Definitions */
 #define KNOCK_BETA 10        // value in [%/s] of knock retard regression
@@ -31,6 +32,7 @@ extern "C"
     void nECU_Knock_UpdatePeriodic(void);                 // function to calculate current retard value
     static void nECU_Knock_DetectMagn(void);              // function to detect knock based on ADC input
     static void nECU_Knock_Evaluate(float *magnitude);    // check if magnitude is of knock range
+    static void nECU_Knock_Table_Update(void);            // rebuild threshold table from calibration
     bool nECU_Knock_Stop(void);                           // stop
     uint8_t *nECU_Knock_GetPointer(void);                 // returns pointer to knock retard percentage
 
@@ -18,9 +18,25 @@ extern "C"
 #include "stdbool.h"
 #include "nECU_types.h"
 #include "nECU_UART.h"
+#include "nECU_watchdog.h"
 
 /* Definitions */
 #define PC_INDICATOR_SPEED 5 // how fast will LED blink in Hz
+#define PC_COMMAND_LEN 1      // length of command recieved from PC
+
+// Commands recieved from PC
+#define PC_CMD_SCOPE_MANUAL 'm'   // arm burst capture with manual trigger
+#define PC_CMD_SCOPE_LEVEL 'l'    // arm burst capture with level trigger
+#define PC_CMD_SCOPE_RISING 'r'   // arm burst capture with rising edge trigger
+#define PC_CMD_SCOPE_TRIGGER 't'  // trigger armed burst capture
+#define PC_CMD_SCOPE_ABORT 'x'    // drop burst capture
+#define PC_CMD_ADC_REPORT 'a'     // print ADC DMA statistics
+#define PC_CMD_PROFILE_REPORT 'p' // print execution times of program blocks
+#define PC_CMD_LOOP_REPORT 'u'    // print CPU load and loop period histogram
+#define PC_CMD_EVENT_REPORT 'q'   // print interrupt event queue statistics
+#define PC_CMD_RESET_REPORT 'w'   // print reset cause and watchdog record
+#define PC_CMD_BOOT_REPORT 'b'    // print start up time of modules
+#define PC_CMD_CAN_REPORT 'c'     // print CAN queue and reception statistics
 
 // Console colors
 #define Console_Color_Off "\[\033[0m\]" // Text Format Reset
@@ -78,6 +94,7 @@ extern "C"
     /* Flow control */
     static void nECU_PC_Transmit(void); // call to send a frame
     static void nECU_PC_Recieve(void);  // call to start listening for frames
+    static void nECU_PC_Command(uint8_t command); // execute command recieved from PC
     /* Send */
     // PUTCHAR_PROTOTYPE;
     int _write(int fd, char *ptr, int len);
@@ -25,6 +25,8 @@ extern "C"
 #define END_BYTE 0xFF         // what will be reciving software looking for to determine end of frame
 #define TEST_KNOCK_UART false // enables uart test mode, trinagluar wave sent over uart
 #define SEND_KNOCK_RAW false  // eneables RAW ADC data send
+#define UART_EVENT_RX 0       // data of EVENT_UART_ID when reception is done
+#define UART_EVENT_TX 1       // data of EVENT_UART_ID when transmission is done
 
 /* Definitions  Delta*/
 #define DELTA_PREC 16      // precision of delta (number of bits in delta output)
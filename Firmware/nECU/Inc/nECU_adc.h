@@ -30,15 +30,22 @@ Time ADC1 {/8, 12bit, 8 channels, 480 cycles each}
 */
 /* Definitions */
 #define GENERAL_ADC hadc1               // ADC responsible for general analog inputs
-#define GENERAL_SMOOTH_ALPHA (float)0.5 // strength for smoothing the data
+#define GENERAL_SMOOTH_ALPHA (float)0.5 // default strength for smoothing the data (calibration)
 
 #define SPEED_ADC hadc2               // ADC responsible for speed sensor data collection
-#define SPEED_SMOOTH_ALPHA (float)0.8 // strength for smoothing the data
+#define SPEED_SMOOTH_ALPHA (float)0.8 // default strength for smoothing the data (calibration)
+
+#define GENERAL_SYNC_TIMEOUT 100 // time in ms without ignition events after which synchronous data is considered old
+
+#define SCOPE_SAMPLETIME ADC_SAMPLETIME_56CYCLES // has to match SCOPE_ADC_SAMPLINGCYCLES
 
 #define KNOCK_ADC hadc3 // ADC responsible for knock sensor data collection
   /* Interrupt functions */
   void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
   void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc);
+  void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc);
+  void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc);
+  void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc);
 
   /* Start functions */
   bool nECU_ADC1_START(void);
@@ -56,6 +63,32 @@ Time ADC1 {/8, 12bit, 8 channels, 480 cycles each}
   uint16_t *nECU_ADC1_getPointer(nECU_ADC1_ID ID);
   uint16_t *nECU_ADC2_getPointer(nECU_ADC2_ID ID);
 
+  /* DMA statistics */
+  static void nECU_ADC_DMA_Callback(nECU_ADC_Status *status, nECU_Event_ID ID, bool full); // hand filled half to routine and count callbacks
+  static bool nECU_ADC_DMA_Take(nECU_ADC_Status *status, nECU_Event_ID ID, bool *full);    // take latest filled half and track delay between DMA callback and processing, returns false if there is none
+  nECU_ADC_Stats *nECU_ADC_Stats_getPointer(nECU_Module_ID ID);                            // returns pointer to statistics of given ADC (D_ADC1 - D_ADC3)
+  void nECU_ADC_Stats_Report(void);                                                        // print statistics of all ADCs over UART
+
+  /* Analog watchdog */
+  static uint32_t nECU_ADC_getChannel(ADC_HandleTypeDef *hadc, uint8_t rank); // returns channel number configured at given rank (1-16)
+  static bool nECU_ADC1_Protect_Start(void);                                  // configure analog watchdog and guard first limit
+  static void nECU_ADC1_Protect_Rotate(void);                                 // move analog watchdog to the next limit that is not already active
+  static void nECU_ADC1_Protect_Release(void);                                // release latched limits once averaged value is back below hysteresis
+  bool nECU_ADC1_Protect_getFlag(nECU_ADC1_Protect_ID ID);                    // returns state of given limit
+
+  /* Crank synchronous sampling */
+  bool nECU_ADC1_Sync_Start(void);                           // sample selected channels on every IGF capture
+  bool nECU_ADC1_Sync_Stop(void);                            // stop sampling on IGF capture, regular conversions continue
+  bool nECU_ADC1_Sync_isFresh(void);                         // returns true if ignition events are arriving
+  uint16_t *nECU_ADC1_Sync_getPointer(nECU_ADC1_ID ID);      // returns pointer to per event result, NULL if not sampled synchronously
+  bool *nECU_ADC1_Sync_getPointer_newData(nECU_ADC1_ID ID); // returns pointer to new event flag, NULL if not sampled synchronously
+
+  /* Burst capture (scope mode) */
+  bool nECU_ADC1_Scope_Enter(uint16_t *buffer, uint32_t length); // switch GENERAL_ADC to fast scan of scope channels into given circular buffer
+  void nECU_ADC1_Scope_Halt(void);                               // stop conversions, keeps content of burst buffer (can be called from interrupt)
+  bool nECU_ADC1_Scope_Exit(void);                               // restore normal scan and restart conversions
+  static void nECU_ADC1_Scope_Restore(void);                     // write back normal scan configuration, conversions have to be stopped
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file    nECU_boot.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_boot.c file
+ */
+#ifndef _NECU_BOOT_H_
+#define _NECU_BOOT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "stdio.h"
+#include "stdbool.h"
+#include "nECU_types.h"
+#include "nECU_flowControl.h"
+#include "nECU_tim.h"
+#include "nECU_can.h"
+#include "nECU_EGT.h"
+#include "nECU_flash.h"
+#include "nECU_frames.h"
+#include "nECU_isotp.h"
+#include "nECU_Knock.h"
+#include "nECU_log.h"
+#include "nECU_menu.h"
+#include "nECU_OnBoardLED.h"
+#include "nECU_PC.h"
+#include "nECU_scheduler.h"
+#include "nECU_scope.h"
+#include "nECU_watchdog.h"
+#include "nECU_xcp.h"
+
+/* Definitions */
+#define BOOT_TIMEOUT 1000                                                                                                               // maximal time of waiting for slow devices [ms]
+#define BOOT_DEPENDS(...) .depends = {__VA_ARGS__}, .depends_count = (sizeof((nECU_Module_ID[]){__VA_ARGS__}) / sizeof(nECU_Module_ID)) // fills dependency list of 'nECU_Module_Config'
+
+    /* Function Prototypes */
+    bool nECU_Boot_Start(nECU_Module_ID target);              // start target and its dependencies in dependency order
+    bool nECU_Boot_Stop(nECU_Module_ID target);               // stop modules that depend on target, dependents first, then target itself
+    bool nECU_Boot_Release(nECU_Module_ID target);            // stop dependencies of target that are no longer required, in reverse start order
+    bool nECU_Boot_isRequired(nECU_Module_ID ID);             // returns true if any working module depends on given one
+    nECU_Boot_Record *nECU_Boot_getRecord(nECU_Module_ID ID); // returns bring up record of given module
+    void nECU_Boot_Report(void);                              // print bring up times over UART
+
+    static bool nECU_Boot_Sort(void);                                              // build dependency order, returns true on dependency cycle
+    static bool nECU_Boot_Visit(nECU_Module_ID ID, uint8_t *mark, uint8_t *count); // depth first walk of dependencies
+    static void nECU_Boot_Require(nECU_Module_ID ID, bool *required);              // mark module and all its dependencies
+    static bool nECU_Boot_isReady(nECU_Module_ID ID);                              // returns true when module can be used by its dependents
+    static bool nECU_Boot_Dependencies_Failed(nECU_Module_ID ID);                  // returns true if any dependency failed to start
+    static bool nECU_Boot_Dependencies_Ready(nECU_Module_ID ID);                   // returns true if all dependencies are ready
+    static bool nECU_Boot_Depends(nECU_Module_ID ID, nECU_Module_ID dependency);   // returns true if ID directly depends on dependency
+
+    /* Test */
+    bool nECU_Boot_test(bool logging_enable); // Run test
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_BOOT_H_ */
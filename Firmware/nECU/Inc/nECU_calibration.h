@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @file    nECU_calibration.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_calibration.c file
+ */
+#ifndef _NECU_CALIBRATION_H_
+#define _NECU_CALIBRATION_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "stdbool.h"
+#include "string.h"
+#include "nECU_types.h"
+#include "nECU_adc.h"
+
+/* Definitions */
+#define CALIBRATION_DEFAULTS                                  \
+    {                                                         \
+        .knock_rpm = {1000, 2000, 3000, 4000, 5000},          \
+        .knock_min = {28000, 125000, 300000, 450000, 400000}, \
+        .knock_max = {50000, 150000, 400000, 550000, 500000}, \
+        .general_alpha = GENERAL_SMOOTH_ALPHA,                \
+        .speed_alpha = SPEED_SMOOTH_ALPHA,                    \
+    } // values of reference page, working page starts as its copy
+
+    /* Function Prototypes */
+    nECU_Calibration const *nECU_Calibration_get(void);                               // returns page used by ECU
+    uint32_t nECU_Calibration_getRevision(void);                                      // returns number incremented on every change of page used by ECU
+    bool nECU_Calibration_setPage(nECU_Calibration_Page page, bool ecu, bool xcp);    // select page for ECU and/or XCP access, returns true if page is invalid
+    nECU_Calibration_Page nECU_Calibration_getPage(bool xcp);                         // returns page selected for ECU or XCP access
+    bool nECU_Calibration_isInside(uint32_t address, uint8_t size);                   // returns true if range lies in calibration page
+    void nECU_Calibration_Read(uint32_t address, uint8_t *data, uint8_t size);        // copy memory, ranges inside calibration are read from page selected for XCP
+    bool nECU_Calibration_Write(uint32_t address, uint8_t const *data, uint8_t size); // write to working page, returns true if range is outside of it or reference page is selected
+    void nECU_Calibration_Reset(void);                                                // copy reference page to working page
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_CALIBRATION_H_ */
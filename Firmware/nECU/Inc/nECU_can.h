@@ -18,33 +18,81 @@ extern "C"
 #include "nECU_tim.h"
 #include "tim.h"
 #include "can.h"
+#include "nECU_seqlock.h"
+#include "nECU_can_signals.h"
 
 /* Definitions */
-#define CAN_RX_WHEELSPEED_ID 0x400 // CAN message ID for Wheel Speed
+#define CAN_RX_WHEELSPEED_ID 0x400                      // CAN message ID for Wheel Speed
+#define CAN_RX_FILTER_BANK_MAX 14                       // number of filter banks given to CAN1, rest is left for CAN2
+#define CAN_RX_FILTER_SLOTS 4                           // number of standard IDs held by single 16-bit list mode bank
+#define CAN_RX_FILTER_STDID(ID) ((uint16_t)((ID) << 5)) // standard ID in 16-bit filter layout (RTR and IDE cleared)
+#define CAN_RX_INTERVAL_LONG 20000                      // time between frames above which cycle counter could wrap, tick is used instead [ms]
+#define CAN_TX_SEND_TIMEOUT 100                         // time frame given by 'nECU_CAN_TX_Send' may wait in queue [ms]
+#define CAN_BUSOFF_BACKOFF_MIN 10                       // delay of first bus-off recovery [ms]
+#define CAN_BUSOFF_BACKOFF_MAX 2000                     // longest delay of bus-off recovery, doubled after each bus-off [ms]
+#define CAN_BUSOFF_STABLE 10000                         // time without bus-off after which recovery delay starts from minimum again [ms]
+#define CAN_LOAD_WINDOW 1000                            // bus load measurement window [ms]
+#define CAN_FRAME_BITS(DLC) (47 + (8 * (DLC)))          // standard data frame with interframe space, without stuff bits
+#define CAN_INIT_TIMEOUT 1000                           // polls of init acknowledge before bus-off recovery gives up
+#define CAN_TX_MAILBOX_FREE UINT32_MAX                  // 'mailbox_StdId' of empty mailbox
+#define CAN_TEST_SEGMENTS 8                             // frames of single ID sent by 'nECU_CAN_test_Arbitration'
 
   /* Function Prototypes */
   // General functions
   bool nECU_CAN_Start(void);                                               // start periodic transmission of EGT and Speed sensor data
-  void nECU_CAN_WriteToBuffer(nECU_CAN_TX_Frame_ID frameID, uint8_t size); // copy input data to corresponding frame buffer
   bool nECU_CAN_Stop(void);                                                // stop all CAN code, with timing
 
   // TX functions
-  void nECU_CAN_TX_CheckTime(void); // checks if it is time to send packet
+  void nECU_CAN_TX_CheckTime(void); // handle frames released by TX timer
   static bool nECU_CAN_TX_Init(nECU_CAN_TX_Frame_ID currentID);
   static bool nECU_CAN_TX_TransmitFrame(nECU_CAN_TX_Frame_ID frameID); // send selected frame over CAN
-  static uint32_t nECU_CAN_TX_FindMailbox(CAN_HandleTypeDef *hcan);    // will find empty mailbox
+  void nECU_CAN_TX_Timer_Callback(void);                                // release frames whose period elapsed, queue pre-composed payloads (called from interrupt)
+  static nECU_CAN_TX_Frame_ID nECU_CAN_TX_Identify(uint32_t StdId);     // returns periodic frame ID of given CAN ID, CAN_TX_ID_MAX for others
+  bool nECU_CAN_TX_TransmitUrgent(nECU_CAN_TX_Frame_ID frameID, uint8_t index, uint8_t bits); // send copy of the frame with given bits set, out of schedule (called from interrupt)
+  bool nECU_CAN_TX_Send(uint32_t StdId, uint8_t const *data, uint8_t length);                 // queue frame outside of periodic list, returns true if there is no room (called from interrupt)
+  void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan); // interrupt callback when mailbox 0 is free again
+  void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan); // interrupt callback when mailbox 1 is free again
+  void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan); // interrupt callback when mailbox 2 is free again
+
+  // TX queue functions
+  static bool nECU_CAN_TX_Queue_Before(nECU_CAN_TX_Entry const *first, nECU_CAN_TX_Entry const *second);                               // returns true if first entry has to be sent before second
+  static void nECU_CAN_TX_Queue_Remove(nECU_CAN_TX_Queue *queue, uint8_t index);                                                       // remove entry keeping order of others
+  static void nECU_CAN_TX_Queue_Expire(nECU_CAN_TX_Queue *queue, uint32_t tick);                                                       // remove entries after their deadline
+  static bool nECU_CAN_TX_Queue_Push(nECU_CAN_TX_Queue *queue, nECU_CAN_TxFrame const *frame, uint32_t deadline, bool replace);        // add frame by priority, returns true if frame was dropped
+  static void nECU_CAN_TX_Queue_Retry(nECU_CAN_TX_Queue *queue, nECU_CAN_TX_Entry const *entry);                                       // put frame that failed in mailbox back ahead of queued frames of its ID
+  static bool nECU_CAN_TX_Queue_Pop(nECU_CAN_TX_Queue *queue, nECU_CAN_TX_Entry *entry, uint32_t tick, uint32_t const *mailbox_StdId); // take highest priority frame that is not stale and has no frame of its ID in mailboxes
+  static void nECU_CAN_TX_Queue_Load(CAN_HandleTypeDef *hcan, nECU_CAN_TX_Queue *queue);                                               // move queued frames to free mailboxes
+  static void nECU_CAN_TX_Queue_Flush(nECU_CAN_TX_Queue *queue);                                                                       // drop all queued frames
 
   // RX functions
-  static bool nECU_CAN_RX_Init(nECU_CAN_RX_Frame_ID currentID);
-  void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan); // interrupt callback when new Rx frame in FIFO0
-  static nECU_CAN_RX_Frame_ID nECU_CAN_RX_Identify(CAN_RxHeaderTypeDef *pHeader);
-  static void nECU_CAN_RX_Update(nECU_CAN_RX_Frame_ID currentID, uint8_t *buf); // update value
-  int32_t nECU_CAN_RX_getValue(nECU_CAN_RX_Frame_ID currentID);                 // returns value of given frame
+  static bool nECU_CAN_RX_Init(void);                                                                 // pack RX IDs into 16-bit list mode filter banks, four per bank
+  void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan);                                    // interrupt callback when new Rx frame in FIFO0
+  static nECU_CAN_RX_Frame_ID nECU_CAN_RX_Identify(CAN_RxHeaderTypeDef *pHeader);                     // returns frame ID from filter match index
+  static void nECU_CAN_RX_Update(nECU_CAN_RX_Frame_ID currentID, uint8_t const *buf, uint8_t length); // store raw payload with time of reception
+  static bool nECU_CAN_RX_getSample(nECU_CAN_RX_Frame_ID currentID, nECU_CAN_RX_Sample *sample);      // copy last reception of given frame, returns false if it was not received
+  int32_t nECU_CAN_RX_getValue(nECU_CAN_RX_Frame_ID currentID);                                       // returns value of given frame, regardless of its age
+  bool nECU_CAN_RX_getValid(nECU_CAN_RX_Frame_ID currentID, int32_t *value);                          // copy value of given frame if it is not older than its timeout, otherwise 'value' is left untouched
+
+  // Health functions
+  static void nECU_CAN_Health_Init(void);               // bitrate from bit timing, clear statistics
+  static void nECU_CAN_Health_Update(void);             // read error status register and count state transitions (call with interrupts disabled)
+  static void nECU_CAN_Health_Routine(void);            // bus load window and bus-off recovery, call every 1 ms
+  static void nECU_CAN_Health_Recover(void);            // request leaving of bus-off state
+  static void nECU_CAN_Health_TX_done(uint8_t mailbox); // latency and bits of transmitted frame (called from interrupt)
+  void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan);  // interrupt callback of bus errors, state changes and failed transmissions
+  nECU_CAN_Health *nECU_CAN_Health_getPointer(void);    // returns pointer to bus health statistics
 
   // Diagnostic functions
   static uint8_t nECU_CAN_IsBusy(void); // Check if any messages are pending
+  void nECU_CAN_Report(void);           // print bus health, TX queue and RX timing statistics to PC
   bool nECU_CAN_GetError(void);         // get error state pf can periperal buisy
 
+  /* Test */
+  static bool nECU_CAN_test_Order(void);       // test priority order and replacement of queued frames
+  static bool nECU_CAN_test_Full(void);        // test dropping and expiry of queued frames
+  static bool nECU_CAN_test_Arbitration(void); // test that frames of one ID leave in order through bxCAN mailboxes, also when one of them fails
+  bool nECU_CAN_test(bool logging_enable);     // Run test
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file    nECU_can_signals.h
+ * @brief   Packing of CAN frames described in Tools/nECU_can.dbc.
+ *          Generated by Tools/nECU_can_signals.py, do not edit by hand.
+ */
+#ifndef _NECU_CAN_SIGNALS_H_
+#define _NECU_CAN_SIGNALS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "stdint.h"
+
+/* Definitions */
+#define CAN_MSG_SPEED_ID 0x500 // CAN ID of Speed frame
+#define CAN_MSG_SPEED_DLC 8    // payload length of Speed frame
+#define CAN_MSG_EGT_ID 0x501   // CAN ID of EGT frame
+#define CAN_MSG_EGT_DLC 8      // payload length of EGT frame
+#define CAN_MSG_STOCK_ID 0x502 // CAN ID of Stock frame
+#define CAN_MSG_STOCK_DLC 8    // payload length of Stock frame
+
+    /* Speed 0x500 */
+    typedef struct
+    {
+        uint8_t IgnitionKey;        // raw [0|1]
+        uint8_t Fan_ON;             // raw [0|1]
+        uint8_t Lights_ON;          // raw [0|1]
+        uint8_t Cranking;           // raw [0|1]
+        uint16_t VSS_FL;            // raw [0|4095]
+        uint8_t ClearCode;          // raw [0|1]
+        uint8_t TachoShow_MenuLvl;  // raw [0|1]
+        uint8_t TachoShow_LunchLvl; // raw [0|1]
+        uint8_t TachoShow_TuneSel;  // raw [0|1]
+        uint16_t VSS_FR;            // raw [0|4095]
+        uint8_t Antilag;            // raw [0|1]
+        uint8_t Launch_High;        // raw [0|1]
+        uint8_t Launch_Medium;      // raw [0|1]
+        uint8_t Launch_Low;         // raw [0|1]
+        uint16_t VSS_RL;            // raw [0|4095]
+        uint8_t TractionOFF;        // raw [0|1]
+        uint8_t Launch_Rolling;     // raw [0|1]
+        uint8_t Counter;            // raw [0|3]
+        uint16_t VSS_RR;            // raw [0|4095]
+    } nECU_CAN_Speed_Signals;
+    static inline void nECU_CAN_Speed_Pack(uint8_t *data, nECU_CAN_Speed_Signals const *signals) // fill payload with raw values
+    {
+        data[0] = (uint8_t)((((uint32_t)signals->IgnitionKey & 0x1) << 7) | (((uint32_t)signals->Fan_ON & 0x1) << 6) | (((uint32_t)signals->Lights_ON & 0x1) << 5) | (((uint32_t)signals->Cranking & 0x1) << 4) | (((uint32_t)signals->VSS_FL >> 8) & 0xF));
+        data[1] = (uint8_t)(((uint32_t)signals->VSS_FL & 0xFF));
+        data[2] = (uint8_t)((((uint32_t)signals->ClearCode & 0x1) << 7) | (((uint32_t)signals->TachoShow_MenuLvl & 0x1) << 6) | (((uint32_t)signals->TachoShow_LunchLvl & 0x1) << 5) | (((uint32_t)signals->TachoShow_TuneSel & 0x1) << 4) | (((uint32_t)signals->VSS_FR >> 8) & 0xF));
+        data[3] = (uint8_t)(((uint32_t)signals->VSS_FR & 0xFF));
+        data[4] = (uint8_t)((((uint32_t)signals->Antilag & 0x1) << 7) | (((uint32_t)signals->Launch_High & 0x1) << 6) | (((uint32_t)signals->Launch_Medium & 0x1) << 5) | (((uint32_t)signals->Launch_Low & 0x1) << 4) | (((uint32_t)signals->VSS_RL >> 8) & 0xF));
+        data[5] = (uint8_t)(((uint32_t)signals->VSS_RL & 0xFF));
+        data[6] = (uint8_t)((((uint32_t)signals->TractionOFF & 0x1) << 5) | (((uint32_t)signals->Launch_Rolling & 0x1) << 4) | (((uint32_t)signals->Counter & 0x3) << 6) | (((uint32_t)signals->VSS_RR >> 8) & 0xF));
+        data[7] = (uint8_t)(((uint32_t)signals->VSS_RR & 0xFF));
+    }
+    static inline void nECU_CAN_Speed_Unpack(nECU_CAN_Speed_Signals *signals, uint8_t const *data) // read raw values from payload
+    {
+        signals->IgnitionKey = (uint8_t)((((uint32_t)data[0] >> 7) & 0x1));
+        signals->Fan_ON = (uint8_t)((((uint32_t)data[0] >> 6) & 0x1));
+        signals->Lights_ON = (uint8_t)((((uint32_t)data[0] >> 5) & 0x1));
+        signals->Cranking = (uint8_t)((((uint32_t)data[0] >> 4) & 0x1));
+        signals->VSS_FL = (uint16_t)(((uint32_t)data[1] & 0xFF) | (((uint32_t)data[0] & 0xF) << 8));
+        signals->ClearCode = (uint8_t)((((uint32_t)data[2] >> 7) & 0x1));
+        signals->TachoShow_MenuLvl = (uint8_t)((((uint32_t)data[2] >> 6) & 0x1));
+        signals->TachoShow_LunchLvl = (uint8_t)((((uint32_t)data[2] >> 5) & 0x1));
+        signals->TachoShow_TuneSel = (uint8_t)((((uint32_t)data[2] >> 4) & 0x1));
+        signals->VSS_FR = (uint16_t)(((uint32_t)data[3] & 0xFF) | (((uint32_t)data[2] & 0xF) << 8));
+        signals->Antilag = (uint8_t)((((uint32_t)data[4] >> 7) & 0x1));
+        signals->Launch_High = (uint8_t)((((uint32_t)data[4] >> 6) & 0x1));
+        signals->Launch_Medium = (uint8_t)((((uint32_t)data[4] >> 5) & 0x1));
+        signals->Launch_Low = (uint8_t)((((uint32_t)data[4] >> 4) & 0x1));
+        signals->VSS_RL = (uint16_t)(((uint32_t)data[5] & 0xFF) | (((uint32_t)data[4] & 0xF) << 8));
+        signals->TractionOFF = (uint8_t)((((uint32_t)data[6] >> 5) & 0x1));
+        signals->Launch_Rolling = (uint8_t)((((uint32_t)data[6] >> 4) & 0x1));
+        signals->Counter = (uint8_t)((((uint32_t)data[6] >> 6) & 0x3));
+        signals->VSS_RR = (uint16_t)(((uint32_t)data[7] & 0xFF) | (((uint32_t)data[6] & 0xF) << 8));
+    }
+
+    /* EGT 0x501 */
+    typedef struct
+    {
+        uint8_t Tacho_TuneSel;  // raw [0|63]
+        uint16_t EGT1;          // raw [0|1023], degC
+        uint8_t Tacho_LunchLvl; // raw [0|63]
+        uint16_t EGT2;          // raw [0|1023], degC
+        uint8_t Tacho_MenuLvl;  // raw [0|63]
+        uint16_t EGT3;          // raw [0|1023], degC
+        uint8_t TuneSel;        // raw [0|63]
+        uint16_t EGT4;          // raw [0|1023], degC
+    } nECU_CAN_EGT_Signals;
+    static inline void nECU_CAN_EGT_Pack(uint8_t *data, nECU_CAN_EGT_Signals const *signals) // fill payload with raw values
+    {
+        data[0] = (uint8_t)((((uint32_t)signals->Tacho_TuneSel & 0x3F) << 2) | (((uint32_t)signals->EGT1 >> 8) & 0x3));
+        data[1] = (uint8_t)(((uint32_t)signals->EGT1 & 0xFF));
+        data[2] = (uint8_t)((((uint32_t)signals->Tacho_LunchLvl & 0x3F) << 2) | (((uint32_t)signals->EGT2 >> 8) & 0x3));
+        data[3] = (uint8_t)(((uint32_t)signals->EGT2 & 0xFF));
+        data[4] = (uint8_t)((((uint32_t)signals->Tacho_MenuLvl & 0x3F) << 2) | (((uint32_t)signals->EGT3 >> 8) & 0x3));
+        data[5] = (uint8_t)(((uint32_t)signals->EGT3 & 0xFF));
+        data[6] = (uint8_t)((((uint32_t)signals->TuneSel & 0x3F) << 2) | (((uint32_t)signals->EGT4 >> 8) & 0x3));
+        data[7] = (uint8_t)(((uint32_t)signals->EGT4 & 0xFF));
+    }
+    static inline void nECU_CAN_EGT_Unpack(nECU_CAN_EGT_Signals *signals, uint8_t const *data) // read raw values from payload
+    {
+        signals->Tacho_TuneSel = (uint8_t)((((uint32_t)data[0] >> 2) & 0x3F));
+        signals->EGT1 = (uint16_t)(((uint32_t)data[1] & 0xFF) | (((uint32_t)data[0] & 0x3) << 8));
+        signals->Tacho_LunchLvl = (uint8_t)((((uint32_t)data[2] >> 2) & 0x3F));
+        signals->EGT2 = (uint16_t)(((uint32_t)data[3] & 0xFF) | (((uint32_t)data[2] & 0x3) << 8));
+        signals->Tacho_MenuLvl = (uint8_t)((((uint32_t)data[4] >> 2) & 0x3F));
+        signals->EGT3 = (uint16_t)(((uint32_t)data[5] & 0xFF) | (((uint32_t)data[4] & 0x3) << 8));
+        signals->TuneSel = (uint8_t)((((uint32_t)data[6] >> 2) & 0x3F));
+        signals->EGT4 = (uint16_t)(((uint32_t)data[7] & 0xFF) | (((uint32_t)data[6] & 0x3) << 8));
+    }
+
+    /* Stock 0x502 */
+    typedef struct
+    {
+        uint8_t Overboost;         // raw [0|1]
+        uint8_t BackpressureLimit; // raw [0|1]
+        uint8_t Counter;           // raw [0|15]
+        uint16_t MAP;              // raw [0|1023]
+        uint8_t OX;                // raw [0|255]
+        uint8_t Backpressure;      // raw [0|255]
+        uint8_t Knock;             // raw [0|255], %
+        uint8_t VSS;               // raw [0|255]
+        uint16_t LoopTime;         // raw [0|65535]
+    } nECU_CAN_Stock_Signals;
+    static inline void nECU_CAN_Stock_Pack(uint8_t *data, nECU_CAN_Stock_Signals const *signals) // fill payload with raw values
+    {
+        data[0] = (uint8_t)((((uint32_t)signals->Overboost & 0x1) << 7) | (((uint32_t)signals->BackpressureLimit & 0x1) << 6) | (((uint32_t)signals->Counter & 0xF) << 2) | (((uint32_t)signals->MAP >> 8) & 0x3));
+        data[1] = (uint8_t)(((uint32_t)signals->MAP & 0xFF));
+        data[2] = (uint8_t)(((uint32_t)signals->OX & 0xFF));
+        data[3] = (uint8_t)(((uint32_t)signals->Backpressure & 0xFF));
+        data[4] = (uint8_t)(((uint32_t)signals->Knock & 0xFF));
+        data[5] = (uint8_t)(((uint32_t)signals->VSS & 0xFF));
+        data[6] = (uint8_t)((((uint32_t)signals->LoopTime >> 8) & 0xFF));
+        data[7] = (uint8_t)(((uint32_t)signals->LoopTime & 0xFF));
+    }
+    static inline void nECU_CAN_Stock_Unpack(nECU_CAN_Stock_Signals *signals, uint8_t const *data) // read raw values from payload
+    {
+        signals->Overboost = (uint8_t)((((uint32_t)data[0] >> 7) & 0x1));
+        signals->BackpressureLimit = (uint8_t)((((uint32_t)data[0] >> 6) & 0x1));
+        signals->Counter = (uint8_t)((((uint32_t)data[0] >> 2) & 0xF));
+        signals->MAP = (uint16_t)(((uint32_t)data[1] & 0xFF) | (((uint32_t)data[0] & 0x3) << 8));
+        signals->OX = (uint8_t)(((uint32_t)data[2] & 0xFF));
+        signals->Backpressure = (uint8_t)(((uint32_t)data[3] & 0xFF));
+        signals->Knock = (uint8_t)(((uint32_t)data[4] & 0xFF));
+        signals->VSS = (uint8_t)(((uint32_t)data[5] & 0xFF));
+        signals->LoopTime = (uint16_t)(((uint32_t)data[7] & 0xFF) | (((uint32_t)data[6] & 0xFF) << 8));
+    }
+    static inline uint16_t nECU_CAN_Stock_MAP_Encode(int32_t physical) // physical value to raw, saturated
+    {
+        int32_t raw = physical - (100);
+        raw = (raw < 0) ? 0 : raw;
+        raw = (raw > 1023) ? 1023 : raw;
+        return (uint16_t)raw;
+    }
+    static inline int32_t nECU_CAN_Stock_MAP_Decode(uint16_t raw) // raw value to physical
+    {
+        return (int32_t)raw + (100);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_CAN_SIGNALS_H_ */
@@ -51,6 +51,12 @@ extern "C"
     /* Sensors */
     void nECU_Sensor_Routine(Sensor_Handle *sensor);
 
+    /* Sensor banks */
+    bool nECU_SensorBank_Attach(nECU_SensorBank *bank, uint8_t channel, uint16_t *input, SensorCalibration *calibration, float alpha, Buffer_uint16 buf, uint32_t delay); // fill channel data of the bank
+    bool nECU_SensorBank_Enable(nECU_SensorBank *bank, uint8_t channel);                                                                                                  // include channel in batch pass
+    bool nECU_SensorBank_Disable(nECU_SensorBank *bank, uint8_t channel);                                                                                                 // exclude channel from batch pass
+    void nECU_SensorBank_Routine(nECU_SensorBank *bank, uint32_t mask, float vref_factor);                                                                               // single pass over enabled channels selected by mask
+
     /* Tests */
     bool nECU_DataProcessing_test(bool logging_enable); // Run test
 #ifdef __cplusplus
@@ -17,6 +17,7 @@ extern "C"
 #include "nECU_types.h"
 #include "nECU_can.h"
 #include "nECU_spi.h"
+#include "nECU_log.h"
 
 /* Definitions */
 #define DEVICE_TEMPERATURE_MAX 55  // in deg C
@@ -35,17 +36,18 @@ extern "C"
     static void nECU_Debug_EGTTemp_Check(nECU_Debug_EGT_Temp *inst);   // check if TCs did not exceed fault value
     static bool nECU_Debug_EGTTemp_CheckSingle(uint16_t *temperature); // checks if passed temperature is in defined bound
     static void nECU_Debug_EGTsensor_error(nECU_Debug_EGT_Comm *inst); // to be called when TC sensor error occurs
-    static void nECU_Debug_CAN_Check(void);                            // checks if CAN have any error pending
     static void nECU_Debug_SPI_Check(void);                            // checks if SPI have any error pending
 
     /* Functions to call directly from other files */
     void nECU_Debug_EGTSPIcomm_error(EGT_Sensor_ID ID);                   // to be called when SPI error occurs
     void nECU_Debug_FLASH_error(nECU_Flash_Error_ID ID, bool write_read); // indicate error from flash functions
+    void nECU_Debug_CAN_Check(void);                                      // checks if CAN have any error pending, reports new error passive and bus-off events
 
     /* Debug que and messages */
     static bool nECU_Debug_Init_Que(void);                                                     // initializes que
     static void nECU_Debug_Que_Write(nECU_Debug_error_mesage *message);                        // add message to debug que
     void nECU_Debug_Que_Read(nECU_Debug_error_mesage *message);                                // read newest message from debug que
+    nECU_Debug_error_que const *nECU_Debug_Que_getPointer(void);                               // returns pointer to debug que, messages are left in place
     static void nECU_Debug_Message_Init(nECU_Debug_error_mesage *inst);                        // zeros value inside of structure
     void nECU_Debug_Message_Set(nECU_Debug_error_mesage *inst, float value, nECU_Error_ID ID); // sets error values
 
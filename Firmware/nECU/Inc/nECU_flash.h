@@ -19,6 +19,7 @@ extern "C"
 #include "stm32f4xx.h"
 #include "string.h"
 #include "nECU_debug.h"
+#include "nECU_watchdog.h"
 
 /* Definitions */
 #define FLASH_DATA_START_ADDRESS 0x080E0000                                                          // address of sector 11 of flash memory
@@ -22,26 +22,69 @@ extern "C"
     /* Definitions */
 #define PROGRAMBLOCK_TIMEOUT_DEFAULT 5 // number of seconds that will cause a timeout
 
+#if PROGRAMBLOCK_PROFILING == true
+#define nECU_PROFILE_ENTER(ID) nECU_Debug_ProgramBlock_Enter(ID) // start execution time measurement of given block
+#define nECU_PROFILE_EXIT(ID) nECU_Debug_ProgramBlock_Exit(ID)   // stop execution time measurement of given block
+#else
+#define nECU_PROFILE_ENTER(ID)
+#define nECU_PROFILE_EXIT(ID)
+#endif
+
     /* Program Block */
     void nECU_Debug_ProgramBlock_Init(void);                                                // Initialize 'ProgramBlock' tracking
-    static void nECU_Debug_ProgramBlockData_Clear(nECU_ProgramBlockData *inst);             // Clear structure 'ProgramBlockData'
+    static void nECU_Debug_ProgramBlockData_Clear(nECU_Module_ID ID);                       // Clear structure 'ProgramBlockData'
     void nECU_Debug_ProgramBlockData_Update(nECU_Module_ID ID);                             // Update tick tracking and check for timeout
     void nECU_Debug_ProgramBlockData_Check(void);                                           // Perform error check for all blocks
-    static uint8_t nECU_Debug_ProgramBlockData_Check_Single(nECU_ProgramBlockData *inst);   // returns if errors occur
+    static uint8_t nECU_Debug_ProgramBlockData_Check_Single(nECU_Module_ID ID);             // returns if errors occur
     nECU_ProgramBlockData *nECU_Debug_ProgramBlockData_getPointer_Block(nECU_Module_ID ID); // returns pointer to given ID program block
     uint32_t *nECU_Debug_ProgramBlockData_getPointer_Diff(nECU_Module_ID ID);               // returns pointer to time difference
 
+#if PROGRAMBLOCK_PROFILING == true
+    /* Program Block profiling */
+    void nECU_Debug_ProgramBlock_Enter(nECU_Module_ID ID); // store cycle counter at start of routine
+    void nECU_Debug_ProgramBlock_Exit(nECU_Module_ID ID);  // update execution time statistics at end of routine
+    void nECU_Debug_ProgramBlock_Report(void);             // print measured blocks over UART, most time consuming first
+#endif
+
     /* Flow control */
-    bool nECU_FlowControl_Stop_Check(nECU_Module_ID ID);        // Check if block has "initialized" status
-    bool nECU_FlowControl_Stop_Do(nECU_Module_ID ID);           // Write "initialized" status if possible
-    bool nECU_FlowControl_Initialize_Check(nECU_Module_ID ID);  // Check if block has "initialized" status
-    bool nECU_FlowControl_Initialize_Do(nECU_Module_ID ID);     // Write "initialized" status if possible
-    bool nECU_FlowControl_Working_Check(nECU_Module_ID ID);     // Check if block has "working" status
-    bool nECU_FlowControl_Working_Do(nECU_Module_ID ID);        // Write "working" status if possible
-    bool nECU_FlowControl_Error_Check(nECU_Module_ID ID);       // Check if block has "error" status
-    bool nECU_FlowControl_Error_Do(nECU_Module_ID ID);          // Write "error" status if possible
-    bool nECU_FlowControl_DoubleError_Check(nECU_Module_ID ID); // Check if block has "error_old" status
-    bool nECU_FlowControl_DoubleError_Do(nECU_Module_ID ID);    // Write "error_old" status if possible
+    bool nECU_FlowControl_Stop_Do(nECU_Module_ID ID);        // Write "initialized" status if possible
+    bool nECU_FlowControl_Initialize_Do(nECU_Module_ID ID);  // Write "initialized" status if possible
+    bool nECU_FlowControl_Working_Do(nECU_Module_ID ID);     // Write "working" status if possible
+    bool nECU_FlowControl_Error_Do(nECU_Module_ID ID);       // Write "error" status if possible
+    bool nECU_FlowControl_DoubleError_Do(nECU_Module_ID ID); // Write "error_old" status if possible
+    char const *nECU_FlowControl_getName(nECU_Module_ID ID); // returns printable name of block
+    static void nECU_FlowControl_Status_Change(nECU_Module_ID ID, nECU_ProgramBlock_Status set, nECU_ProgramBlock_Status clear); // update status and its bitmaps as one step
+    static void nECU_FlowControl_Bitmap_Write(atomic_uint_least32_t *bitmap, uint32_t bit, bool value);                          // set or clear single bit of bitmap word
+
+    /* Flow control checks, inlined as they start almost every routine (safe in interrupts) */
+    extern nECU_FlowControl_Bitmap FlowControl_Bitmap; // packed copy of status, defined in nECU_flowControl.c
+
+    static inline bool nECU_FlowControl_Bitmap_Read(atomic_uint_least32_t const *bitmap, nECU_Module_ID ID) // returns bit of given block
+    {
+        if (ID >= D_ID_MAX) // Break if invalid ID
+            return false;
+        return (atomic_load_explicit(&bitmap[ID / 32], memory_order_acquire) >> (ID % 32)) & 1;
+    }
+    static inline bool nECU_FlowControl_Stop_Check(nECU_Module_ID ID) // Check if block has "stop" status
+    {
+        return nECU_FlowControl_Bitmap_Read(FlowControl_Bitmap.stop, ID);
+    }
+    static inline bool nECU_FlowControl_Initialize_Check(nECU_Module_ID ID) // Check if block has "initialized" status
+    {
+        return nECU_FlowControl_Bitmap_Read(FlowControl_Bitmap.initialized, ID);
+    }
+    static inline bool nECU_FlowControl_Working_Check(nECU_Module_ID ID) // Check if block has "working" status
+    {
+        return nECU_FlowControl_Bitmap_Read(FlowControl_Bitmap.working, ID);
+    }
+    static inline bool nECU_FlowControl_Error_Check(nECU_Module_ID ID) // Check if block has "error" status
+    {
+        return nECU_FlowControl_Bitmap_Read(FlowControl_Bitmap.error, ID);
+    }
+    static inline bool nECU_FlowControl_DoubleError_Check(nECU_Module_ID ID) // Check if block has "error_old" status
+    {
+        return nECU_FlowControl_Bitmap_Read(FlowControl_Bitmap.error_old, ID);
+    }
 #ifdef __cplusplus
 }
 #endif
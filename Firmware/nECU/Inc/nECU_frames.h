@@ -18,32 +18,72 @@ extern "C"
 #include "nECU_types.h"
 #include "nECU_EGT.h"
 #include "nECU_can.h"
+#include "nECU_can_signals.h"
 #include "nECU_menu.h"
 #include "nECU_stock.h"
 #include "nECU_Input_Analog.h"
 #include "nECU_Input_Frequency.h"
+#include "nECU_adc.h"
+#include "nECU_seqlock.h"
 
 /* Definitions */
-#define MAX_VAL_10BIT 1023    // maximal possible value for a 10bit uint
-#define FRAME_MAP_OFFSET -100 // offset to the value
+#define FRAME2_PROTECT_BYTE 0                   // byte of frame 2 holding hardware limit flags (Overboost, BackpressureLimit in Tools/nECU_can.dbc)
+#define FRAME2_PROTECT_BIT(ID) (1 << (7 - (ID))) // bit 7 - overboost, bit 6 - backpressure
+
+#define FRAME_TEST_ROUNDS 256 // number of random frames packed by 'nECU_Frame_test'
 
     /* Function Prototypes */
-    bool Frame0_Start(void);                                                                                     // initialization of data structure
-    void Frame0_Routine(void);                                                                                   // update variables for frame 0
-    void Frame0_PrepareBuffer(void);                                                                             // prepare Tx buffer for CAN transmission
-    static void Frame0_ComposeWord(uint8_t *buffer, bool *B1, bool *B2, bool *B3, bool *B4, uint16_t *Val12Bit); // function to create word for use in frame 0
-
-    bool Frame1_Start(void);                                                               // initialization of data structure
-    void Frame1_Routine(void);                                                             // update variables for frame 1
-    void Frame1_PrepareBuffer(void);                                                       // prepare Tx buffer for CAN transmission
-    static void Frame1_ComposeWord(uint8_t *buffer, uint8_t *Val6Bit, uint16_t *Val10Bit); // function to create word for use in frame 1
-
-    bool Frame2_Start(void);         // initialization of data structure
-    void Frame2_Routine(void);       // update variables for frame 2
-    void Frame2_PrepareBuffer(void); // prepare Tx buffer for CAN transmission
-
-    void nECU_Frame_TX_done(nECU_CAN_TX_Frame_ID ID);        // callback after can TX is done
-    uint8_t *nECU_Frame_getPointer(nECU_CAN_TX_Frame_ID ID); // returns pointer to output buffer
+    bool Frame0_Start(void);                        // initialization of data structure
+    bool Frame0_Stop(void);                         // stop updating frame data
+    void Frame0_Routine(void);                      // update variables for frame 0
+    static uint8_t Frame0_Compose(uint8_t *buffer); // pack latest snapshot of frame 0, returns its length
+
+    bool Frame1_Start(void);                        // initialization of data structure
+    bool Frame1_Stop(void);                         // stop updating frame data
+    void Frame1_Routine(void);                      // update variables for frame 1
+    static uint8_t Frame1_Compose(uint8_t *buffer); // pack latest snapshot of frame 1, returns its length
+
+    bool Frame2_Start(void);                        // initialization of data structure
+    bool Frame2_Stop(void);                         // stop updating frame data
+    void Frame2_Routine(void);                      // update variables for frame 2
+    static uint8_t Frame2_Compose(uint8_t *buffer); // pack latest snapshot of frame 2, returns its length
+
+    /* Frame 3 (diagnostic, multiplexed by lower nibble of first byte, upper nibble is rolling counter)
+    ADC pages:
+    [1]   DMA buffers not processed in time (saturated)
+    [2]   ADC overrun errors (saturated)
+    [3-4] maximal delay from DMA callback to processing [us] (saturated)
+    [5-6] number of DMA callbacks (rolls over)
+    Loop page:
+    [1-2] CPU load [0.1%]
+    [3-4] longest main loop pass since previous frame [us] (saturated)
+    [5]   highest used bucket of loop period histogram (log2 of us)
+    [6-7] number of passes of at least 2^LOOP_SLOW_BUCKET us (saturated)
+    CAN page:
+    [1]   transmit error counter
+    [2]   receive error counter
+    [3]   bus state (0 active, 1 warning, 2 passive, 3 bus-off) | last error code << 4
+    [4-5] bus load of last window [0.1%]
+    [6]   number of bus-off events (saturated)
+    [7]   longest mailbox to TX complete latency [100 us] (saturated)
+    */
+    bool Frame3_Start(void);                                           // initialization of data structure
+    bool Frame3_Stop(void);                                            // stop updating frame data
+    static uint8_t Frame3_Compose(uint8_t *buffer);                    // pack current page of frame 3, returns its length
+    static void Frame3_ComposeADC(uint8_t *buffer, nECU_Module_ID ID); // fill page with DMA statistics of given ADC
+    static void Frame3_ComposeLoop(uint8_t *buffer);                   // fill page with main loop timing
+    static void Frame3_ComposeCAN(uint8_t *buffer);                    // fill page with CAN bus health
+
+    void nECU_Frame_Protection_Callback(nECU_ADC1_Protect_ID ID);         // called from interrupt when hardware limit was exceeded
+    void nECU_Frame_TX_done(nECU_CAN_TX_Frame_ID ID);                     // callback after frame was released for transmission, advances state consumed by it
+    uint8_t nECU_Frame_Compose(nECU_CAN_TX_Frame_ID ID, uint8_t *buffer); // pack latest data of given frame straight into CAN buffer, returns its length (called from interrupt)
+
+    /* Test */
+    static uint32_t nECU_Frame_test_Random(uint32_t *state);                                                     // xorshift generator of test inputs
+    static void nECU_Frame_test_Legacy0(uint8_t *buffer, bool B1, bool B2, bool B3, bool B4, uint16_t Val12Bit); // hand written word of frame 0, reference for generated packing
+    static void nECU_Frame_test_Legacy1(uint8_t *buffer, uint8_t Val6Bit, uint16_t Val10Bit);                    // hand written word of frame 1, reference for generated packing
+    static void nECU_Frame_test_Legacy2(uint8_t *buffer, nECU_CAN_Stock_Signals const *signals, uint16_t MAP);   // hand written frame 2, reference for generated packing
+    bool nECU_Frame_test(bool logging_enable);                                                                   // Run test, compares generated packing with hand written one
 
 #ifdef __cplusplus
 }
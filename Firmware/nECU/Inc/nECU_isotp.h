@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file    nECU_isotp.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_isotp.c file
+ */
+#ifndef _NECU_ISOTP_H_
+#define _NECU_ISOTP_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "stdio.h"
+#include "stdbool.h"
+#include "string.h"
+#include "nECU_types.h"
+#include "nECU_flowControl.h"
+#include "nECU_tim.h"
+#include "nECU_can.h"
+#include "nECU_debug.h"
+#include "nECU_calibration.h"
+#include "nECU_isotp_link.h"
+
+/* Definitions */
+#define ISOTP_TX_ID 0x5F1       // CAN ID of frames sent by nECU
+#define ISOTP_RX_ID 0x5F0       // CAN ID of frames sent by tester
+#define ISOTP_RX_BUF_LEN 64     // maximal length of received message (requests are short)
+#define ISOTP_RESPONSE_LEN 1024 // maximal length of service response
+#define ISOTP_TEST_MESSAGE 300  // length of message sent over virtual bus by 'nECU_ISOTP_test'
+#define ISOTP_TEST_BUS_LEN 8    // number of frames held by virtual bus of 'nECU_ISOTP_test'
+
+// Services, first byte of request, response repeats it with ISOTP_SERVICE_POSITIVE set
+#define ISOTP_SERVICE_DEBUG_QUE 0x01   // raw copy of debug error que ('nECU_Debug_error_que')
+#define ISOTP_SERVICE_CALIBRATION 0x02 // raw copy of calibration page used by ECU ('nECU_Calibration')
+#define ISOTP_SERVICE_POSITIVE 0x40    // set in first byte of response
+#define ISOTP_SERVICE_NEGATIVE 0x7F    // first byte of rejection, followed by rejected service
+
+    /* Function Prototypes */
+    /* General functions */
+    bool nECU_ISOTP_Start(void);                                                              // prepare link on 'hcan1'
+    bool nECU_ISOTP_Stop(void);                                                               // abort transfers and stop link
+    void nECU_ISOTP_Routine(void);                                                            // separation time and timeouts, call periodically
+    bool nECU_ISOTP_Send(uint8_t const *data, uint16_t length);                               // start sending message, buffer has to stay valid until done, returns true if busy or invalid
+    bool nECU_ISOTP_isBusy(void);                                                             // returns true while message is being sent
+    uint16_t nECU_ISOTP_Receive(uint8_t *data, uint16_t size);                                // copy last received message, returns its length or 0 if none is waiting
+    void nECU_ISOTP_RX_Handler(nECU_CAN_RX_Frame_ID ID, uint8_t const *data, uint8_t length); // frame from 'ISOTP_RX_ID' received (called from interrupt)
+    void nECU_ISOTP_TX_Callback(void);                                                        // CAN mailbox became free (called from interrupt)
+    static bool nECU_ISOTP_CAN_Send(uint32_t ID, uint8_t const *data);                        // output of link to 'hcan1' TX queue
+    static void nECU_ISOTP_Service(void);                                                     // answer request received on link, once previous response is sent
+
+    /* Test */
+    static bool nECU_ISOTP_test_Bus_Send(uint32_t ID, uint8_t const *data);      // virtual bus output of test links
+    static bool nECU_ISOTP_test_Bus_Run(nECU_ISOTP_Link *A, nECU_ISOTP_Link *B); // deliver frames until bus is quiet, returns false if it never settles
+    bool nECU_ISOTP_test(bool logging_enable);                                   // Run test
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_ISOTP_H_ */
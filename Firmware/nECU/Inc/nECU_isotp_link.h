@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * @file    nECU_isotp_link.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_isotp_link.c file
+ */
+#ifndef _NECU_ISOTP_LINK_H_
+#define _NECU_ISOTP_LINK_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "stdbool.h"
+#include "string.h"
+#include "nECU_types.h"
+#include "nECU_tim.h"
+
+/* Definitions */
+#define ISOTP_MESSAGE_MAX 4095  // maximal message length, 12 bit length of first frame
+#define ISOTP_BLOCK_SIZE 0      // consecutive frames accepted between flow controls (0 - no limit)
+#define ISOTP_STMIN 0           // minimal separation of received consecutive frames [ms]
+#define ISOTP_TIMEOUT 1000      // N_Bs and N_Cr, time waiting for flow control or consecutive frame [ms]
+#define ISOTP_PADDING 0xCC      // value of unused bytes of frame
+
+// Protocol control information, upper nibble of first byte
+#define ISOTP_PCI_SINGLE 0x0      // single frame, lower nibble is length
+#define ISOTP_PCI_FIRST 0x1       // first frame, 12 bit length
+#define ISOTP_PCI_CONSECUTIVE 0x2 // consecutive frame, lower nibble is sequence number
+#define ISOTP_PCI_FLOW 0x3        // flow control, lower nibble is flow status
+#define ISOTP_FLOW_CTS 0x0        // continue to send
+#define ISOTP_FLOW_WAIT 0x1       // wait for next flow control
+#define ISOTP_FLOW_OVERFLOW 0x2   // message too long for receiver
+
+    /* Function Prototypes */
+    /* Link functions, work on any bus */
+    void nECU_ISOTP_Link_Init(nECU_ISOTP_Link *link, uint32_t tx_ID, uint32_t rx_ID, bool (*send)(uint32_t, uint8_t const *), uint8_t *rx_buffer, uint16_t rx_size); // prepare link structure
+    bool nECU_ISOTP_Link_Send(nECU_ISOTP_Link *link, uint8_t const *data, uint16_t length); // start sending message, returns true if busy or invalid
+    void nECU_ISOTP_Link_Frame(nECU_ISOTP_Link *link, uint8_t const *data, uint8_t length); // process received frame
+    void nECU_ISOTP_Link_Continue(nECU_ISOTP_Link *link);                                   // send consecutive frames allowed by flow control and separation time
+    void nECU_ISOTP_Link_Timeout(nECU_ISOTP_Link *link);                                    // abort transfers with silent peer
+    void nECU_ISOTP_Link_Abort(nECU_ISOTP_Link *link);                                      // drop transfers in progress
+    static void nECU_ISOTP_Link_Flow(nECU_ISOTP_Link *link, uint8_t status);                // send flow control frame
+    static uint32_t nECU_ISOTP_STmin_toUs(uint8_t STmin);                                   // decode separation time field
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_ISOTP_LINK_H_ */
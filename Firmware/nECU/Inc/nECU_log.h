@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    nECU_log.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_log.c file
+ */
+#ifndef _NECU_LOG_H_
+#define _NECU_LOG_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "usart.h"
+#include "stdbool.h"
+#include "string.h"
+#include "nECU_types.h"
+#include "nECU_flowControl.h"
+#include "nECU_queue.h"
+#include "nECU_UART.h"
+
+/* Definitions */
+#define LOG_ENABLE true                                                    // store records, when false log calls are removed
+#define LOG_QUEUE_LEN 128                                                  // records buffered between drains, power of two
+#define LOG_TX_BUFFER_LEN 128                                              // bytes sent in one UART transfer
+#define LOG_SYNC 0xA5                                                      // first byte of every frame
+#define LOG_FRAME_LEN(ARGC) (8 + (4 * (ARGC)) + 1)                         // sync, format, argc, timestamp, arguments and checksum [bytes]
+#define LOG_ARG_COUNT(...) LOG_ARG_COUNT_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0) // number of arguments given to nECU_LOG
+#define LOG_ARG_COUNT_(_0, _1, _2, _3, _4, N, ...) N
+
+/* Log call, arguments are stored raw (up to LOG_ARGS_MAX, 32 bit each, floats through nECU_Log_Float)
+   Format string is placed in '.log_fmt' section which is kept only in ELF, its address is the record ID.
+   Host decoder (Tools/nECU_log_decode.py) rebuilds the text. */
+#if LOG_ENABLE == true
+#define nECU_LOG(FORMAT, ...)                                                                                    \
+    do                                                                                                           \
+    {                                                                                                            \
+        static char const nECU_log_format[] __attribute__((section(".log_fmt"), used)) = FORMAT;                \
+        nECU_Log_Write((uint16_t)(uintptr_t)nECU_log_format, LOG_ARG_COUNT(__VA_ARGS__),                         \
+                       (uint32_t const[LOG_ARGS_MAX]){__VA_ARGS__});                                             \
+    } while (0)
+#else
+#define nECU_LOG(FORMAT, ...)
+#endif
+
+    /* Function Prototypes */
+    bool nECU_Log_Start(void);   // start sending of records
+    bool nECU_Log_Stop(void);    // stop sending, records are kept until queue is full
+    void nECU_Log_Routine(void); // send queued records over UART, one transfer at the time
+
+    void nECU_Log_Write(uint16_t format, uint8_t argc, uint32_t const *args);      // store record, safe in interrupts
+    static uint8_t nECU_Log_Encode(nECU_Log_Record const *record, uint8_t *frame); // write record as frame, returns frame length
+
+    static inline uint32_t nECU_Log_Float(float value) // pass float as raw argument
+    {
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        return raw;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_LOG_H_ */
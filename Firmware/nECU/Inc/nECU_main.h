@@ -17,6 +17,8 @@ extern "C"
 #include "nECU_types.h"
 
   /* Definitions */
+#define LOOP_LOAD_WINDOW 1000 // time over which CPU load is averaged [ms]
+#define LOOP_SLOW_BUCKET 10   // first histogram bucket considered as slow pass (2^10 us ~ 1ms)
 
   /* Unions define */
 
@@ -28,6 +30,12 @@ extern "C"
   void nECU_main(void);  // main rutine of the program
   void nECU_Stop(void);  // stop all peripherals (no interrupts will generate)
 
+  /* Loop statistics */
+  static void nECU_Loop_Update(bool busy);                  // account time of finished pass
+  nECU_LoopStats *nECU_Loop_getPointer(void);               // returns pointer to loop statistics
+  uint32_t nECU_Loop_getPeriodMax(nECU_Loop_Reader reader); // returns longest pass since last call of the same reader [us]
+  void nECU_Loop_Report(void);                              // print loop statistics over UART
+
 #ifdef __cplusplus
 }
 #endif
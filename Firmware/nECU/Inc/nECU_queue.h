@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ * @file    nECU_queue.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_queue.c file
+ */
+#ifndef _NECU_QUEUE_H_
+#define _NECU_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "stdbool.h"
+#include "stdatomic.h"
+#include "string.h"
+#include "stdio.h"
+#include "nECU_types.h"
+
+/* Definitions */
+#define QUEUE_IS_POW2(LEN) (((LEN) != 0) && (((LEN) & ((LEN) - 1)) == 0)) // check if length can be used for queue
+// initializer of queue over array, array length has to be power of two
+#define QUEUE_STATIC_INIT(BUFFER) {.buffer = (uint8_t *)(BUFFER), .element_size = sizeof((BUFFER)[0]), .mask = (sizeof(BUFFER) / sizeof((BUFFER)[0])) - 1}
+
+    /* Function Prototypes */
+    bool nECU_Queue_Init(nECU_Queue *queue, void *buffer, uint16_t element_size, uint32_t length); // prepare queue over given buffer, returns true on error
+
+    /* Producer side (single interrupt or thread) */
+    bool nECU_Queue_Push(nECU_Queue *queue, void const *element); // copy element into queue, returns false if queue was full
+
+    /* Consumer side (single interrupt or thread) */
+    bool nECU_Queue_Pop(nECU_Queue *queue, void *element); // copy oldest element out of queue, returns false if queue was empty
+    void nECU_Queue_Flush(nECU_Queue *queue);              // drop all queued elements
+
+    /* Any side */
+    uint32_t nECU_Queue_Count(nECU_Queue *queue); // returns number of queued elements
+
+    /* Test */
+    bool nECU_Queue_test(bool logging_enable); // Run test
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_QUEUE_H_ */
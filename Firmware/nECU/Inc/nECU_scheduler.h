@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * @file    nECU_scheduler.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_scheduler.c file
+ */
+#ifndef _NECU_SCHEDULER_H_
+#define _NECU_SCHEDULER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "nECU_types.h"
+#include "nECU_queue.h"
+#include "nECU_tim.h"
+#include "nECU_watchdog.h"
+#include "nECU_log.h"
+
+/* Definitions */
+#define SCHEDULER_SLEEP true              // wait for interrupt (WFI) when no task is released
+#define SCHEDULER_EVENT(ID) (1UL << (ID)) // bit of given nECU_Event_ID
+#define EVENT_QUEUE_LEN 16                // events buffered per source, power of two
+
+    /* Function Prototypes */
+    bool nECU_Scheduler_Start(void);
+    bool nECU_Scheduler_Stop(void);
+    bool nECU_Scheduler_Run(void);              // serve highest priority released task, returns false if nothing was due
+    void nECU_Scheduler_Sleep(void);            // wait for next interrupt if nothing is pending
+    static bool nECU_Scheduler_isPending(void); // returns true if any task or event waits for dispatcher
+
+    /* Interrupt functions */
+    void nECU_Scheduler_Tick(void);                             // release tasks, to be called from 1ms timer interrupt
+    bool nECU_Scheduler_Event(nECU_Event_ID ID, uint16_t data); // queue timestamped event, to be called only from interrupt of given source, returns false if event was lost
+
+    /* Event queues */
+    bool nECU_Scheduler_Event_Get(nECU_Event_ID ID, nECU_Event *event); // take oldest event of given source, returns false if none
+    void nECU_Scheduler_Event_Flush(nECU_Event_ID ID);                  // drop queued events of given source
+    static void nECU_Scheduler_Event_Drain(void);                       // take events which are not consumed by module routines
+    void nECU_Scheduler_Event_Report(void);                             // print queue statistics to PC
+
+    nECU_Task *nECU_Scheduler_getPointer(nECU_Task_ID ID);        // returns pointer to task statistics
+    nECU_Queue *nECU_Scheduler_Event_getPointer(nECU_Event_ID ID); // returns pointer to event queue
+    nECU_Module_ID nECU_Scheduler_getRunning(void);                // returns block of task being executed, D_ID_MAX if none
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_SCHEDULER_H_ */
@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file    nECU_scope.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_scope.c file
+ */
+#ifndef _NECU_SCOPE_H_
+#define _NECU_SCOPE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "nECU_types.h"
+#include "nECU_adc.h"
+#include "nECU_UART.h"
+
+/* Definitions */
+#define SCOPE_SYNC_BYTE_1 0xA5 // first byte of capture header
+#define SCOPE_SYNC_BYTE_2 0x5A // second byte of capture header
+#define SCOPE_FORMAT_VERSION 1 // increment on any change of transmitted format
+#define SCOPE_HEADER_LEN 20    // length of capture header in bytes
+#define SCOPE_SAMPLE_RATE (APB2_CLOCK / (GENERAL_ADC_CLOCKDIVIDER * (GENERAL_ADC_RESOLUTIONCYCLES + SCOPE_ADC_SAMPLINGCYCLES) * SCOPE_CHANNEL_COUNT)) // sample sets per second
+
+#define SCOPE_DEFAULT_CHANNEL ADC1_MAP_ID // channel checked for trigger when armed from PC
+#define SCOPE_DEFAULT_LEVEL 2500          // trigger level when armed from PC [ADC counts]
+#define SCOPE_DEFAULT_PRE 512             // sample sets before trigger when armed from PC
+#define SCOPE_DEFAULT_POST 1504           // sample sets after trigger when armed from PC
+
+    /* Capture format (little endian)
+    Header:
+    [0-1]   SCOPE_SYNC_BYTE_1, SCOPE_SYNC_BYTE_2
+    [2]     SCOPE_FORMAT_VERSION
+    [3]     number of channels
+    [4-5]   number of sample sets
+    [6-7]   number of sample sets before trigger
+    [8]     trigger type (nECU_Scope_Trigger)
+    [9]     trigger channel (nECU_ADC1_ID)
+    [10-11] trigger level [ADC counts]
+    [12-15] sample sets per second
+    [16-19] tick of capture end [ms]
+    Payload:
+    every sample set packed into 3 bytes -> ch0[7:0], ch1[3:0]|ch0[11:8], ch1[11:4]
+    Trailer:
+    Fletcher-16 of payload (2 bytes), END_BYTE
+    */
+
+    /* Function Prototypes */
+    bool nECU_Scope_Start(void);
+    bool nECU_Scope_Stop(void);
+    void nECU_Scope_Routine(void);
+
+    /* Capture control */
+    bool nECU_Scope_Arm(nECU_Scope_Trigger trigger, nECU_ADC1_ID channel, uint16_t level, uint16_t pre, uint16_t post); // start burst capture, returns true if not possible
+    void nECU_Scope_Trigger_Manual(void);                                                                               // request trigger of armed capture
+    bool nECU_Scope_Abort(void);                                                                                        // drop capture and return to normal scanning
+    nECU_Scope_State nECU_Scope_getState(void);                                                                         // returns current state of capture
+
+    /* Interrupt functions */
+    void nECU_Scope_ADC_Callback(bool second_half); // to be called when half of burst buffer was filled
+
+    /* Transmission */
+    static void nECU_Scope_Send_Header(void);                        // compose and send capture header
+    static bool nECU_Scope_Send_Payload(void);                       // compose and send next chunk of samples (trailer after last one), returns true when all sent
+    static void nECU_Scope_Transmit(uint16_t length);                // send prepared part of capture
+    static void nECU_Scope_Checksum_Update(uint8_t *data, uint16_t len); // Fletcher-16 over sent payload
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_SCOPE_H_ */
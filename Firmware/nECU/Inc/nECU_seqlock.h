@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ * @file    nECU_seqlock.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_seqlock.c file
+ */
+#ifndef _NECU_SEQLOCK_H_
+#define _NECU_SEQLOCK_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "stdbool.h"
+#include "stdatomic.h"
+#include "string.h"
+#include "stdio.h"
+#include "nECU_types.h"
+
+/* Definitions */
+#define SEQLOCK_READ_RETRIES 4 // attempts of reader before it gives up (writer active for long, like SPI transfer)
+
+    /* Function Prototypes */
+    /* Writer side (single interrupt or thread) */
+    void nECU_Seqlock_Write_Begin(nECU_Seqlock *lock);                                       // mark guarded data as being modified
+    void nECU_Seqlock_Write_End(nECU_Seqlock *lock);                                         // publish modified data
+    void nECU_Seqlock_Write(nECU_Seqlock *lock, void *dest, void const *src, uint16_t size); // copy whole data under lock
+
+    /* Reader side (any number, never blocks writer) */
+    uint32_t nECU_Seqlock_Read_Begin(nECU_Seqlock *lock);                                                       // returns sequence to be checked after data was copied
+    bool nECU_Seqlock_Read_Retry(nECU_Seqlock *lock, uint32_t start);                                           // returns true if copy was torn and has to be repeated
+    bool nECU_Seqlock_Read(nECU_Seqlock *lock, void *dest, void const *src, uint16_t size, uint32_t *sequence); // copy consistent snapshot, returns false if writer did not let it
+    static void nECU_Seqlock_Copy(volatile uint8_t *dest, volatile uint8_t const *src, uint16_t size);          // byte copy that compiler can not merge or move
+
+    /* Double-buffered snapshot (single writer, readers interrupt it or run in its context) */
+    void *nECU_Snapshot_Write_Begin(nECU_Snapshot *snap, void *buffers, uint16_t size);               // returns buffer hidden from readers, to be filled with complete set
+    void nECU_Snapshot_Write_End(nECU_Snapshot *snap);                                                // publish filled buffer
+    uint32_t nECU_Snapshot_Read(nECU_Snapshot *snap, void *dest, void const *buffers, uint16_t size); // copy latest published set, returns its sequence (0 - nothing published yet)
+
+    /* Test */
+    bool nECU_Seqlock_test(bool logging_enable); // Run test
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_SEQLOCK_H_ */
@@ -18,11 +18,12 @@ extern "C"
 #include "nECU_Input_Analog.h"
 
     /* Definitions */
-#define OXYGEN_HEATER_MAX 90   // maximum % infill of heater PWM
-#define OXYGEN_HEATER_MIN 0    // maximum % infill of heater PWM
-#define OXYGEN_COOLANT_MAX 80  // maximum degrees that will couse minimum infill
-#define OXYGEN_COOLANT_MIN 40  // minimum degrees that will couse maximum infill
-#define OXYGEN_DECIMAL_POINT 2 // how many numbers after decimal point
+#define OXYGEN_HEATER_MAX 90                      // maximum % infill of heater PWM
+#define OXYGEN_HEATER_MIN 0                       // maximum % infill of heater PWM
+#define OXYGEN_COOLANT_MAX 80                     // maximum degrees that will couse minimum infill
+#define OXYGEN_COOLANT_MIN 40                     // minimum degrees that will couse maximum infill
+#define OXYGEN_COOLANT_DEFAULT OXYGEN_COOLANT_MAX // degrees assumed when coolant temperature from CAN is stale (least heating)
+#define OXYGEN_DECIMAL_POINT 2                    // how many numbers after decimal point
 
     /* Oxygen Sensor */
     bool nECU_OX_Start(void);   // initialize narrowband lambda structure
@@ -25,6 +25,9 @@ extern "C"
 #include "nECU_flash.h"
 #include "nECU_debug.h"
 #include "nECU_adc.h"
+#include "nECU_queue.h"
+#include "nECU_seqlock.h"
+#include "nECU_boot.h"
 
 /* Definitions */
 #define TEST_ENABLE true       // turn all tests on
@@ -16,6 +16,7 @@ extern "C"
 #include "main.h"
 #include "nECU_types.h"
 #include "tim.h"
+#include "nECU_seqlock.h"
 #include "nECU_can.h"
 #include "nECU_button.h"
 #include "nECU_Knock.h"
@@ -28,9 +29,10 @@ extern "C"
   /* Function Prototypes */
   uint8_t nECU_Get_FrameTimer(void); // get current value of frame timer
 
-  static nECU_TIM_ID nECU_TIM_Identify(TIM_HandleTypeDef *htim);               // returns ID of given input
-  TIM_HandleTypeDef *nECU_TIM_getPointer(nECU_TIM_ID ID);                      // returns pointer to timer
-  nECU_InputCapture *nECU_TIM_IC_getPointer(nECU_TIM_ID ID, uint32_t Channel); // pointer to IC stucture
+  static nECU_TIM_ID nECU_TIM_Identify(TIM_HandleTypeDef *htim);                                  // returns ID of given input
+  TIM_HandleTypeDef *nECU_TIM_getPointer(nECU_TIM_ID ID);                                         // returns pointer to timer
+  nECU_InputCapture *nECU_TIM_IC_getPointer(nECU_TIM_ID ID, uint32_t Channel);                    // pointer to IC stucture
+  bool nECU_TIM_IC_Read(nECU_InputCapture *ic, nECU_InputCapture_Data *data, uint32_t *sequence); // copy consistent IC data, returns true if it changed since given sequence
 
   /* Callback functions */
   void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
@@ -41,6 +43,11 @@ extern "C"
   bool nECU_TickTrack_Init(nECU_TickTrack *inst);   // initialize structure
   bool nECU_TickTrack_Update(nECU_TickTrack *inst); // callback to get difference
 
+  /* Cycle counter */
+  void nECU_CycleCounter_Init(void);                // enable DWT cycle counter
+  uint32_t nECU_CycleCounter_Get(void);             // returns current CPU cycle count (wraps around)
+  uint32_t nECU_CycleCounter_toUs(uint32_t cycles); // convert number of cycles to microseconds
+
   /* Non-blocking delay */
   bool *nECU_Delay_DoneFlag(nECU_Delay *inst);           // return done flag pointer of non-blocking delay
   bool nECU_Delay_Start(nECU_Delay *inst);               // start non-blocking delay
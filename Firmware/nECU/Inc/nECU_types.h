@@ -9,7 +9,9 @@
 #define _nECU_types_H_
 
 #include "stdbool.h"
+#include "stdatomic.h"
 #include "main.h"
+#include "nECU_can_signals.h"
 
 #define ARM_MATH_CM4
 #include "arm_math.h"
@@ -25,6 +27,17 @@
 #define GENERAL_TARGET_UPDATE 25                                                                                                                                                                                                         // time in ms how often should values be updated
 #define GENERAL_DMA_LEN (((uint16_t)(((APB2_CLOCK * GENERAL_TARGET_UPDATE) / 1000) / ((GENERAL_ADC_RESOLUTIONCYCLES + GENERAL_ADC_SAMPLINGCYCLES) * GENERAL_ADC_CLOCKDIVIDER * GENERAL_CHANNEL_COUNT))) / 2) * 2 * GENERAL_CHANNEL_COUNT // length of DMA buffer for GENERAL_ADC, '2' for divisibility by two
 
+#define GENERAL_SYNC_CHANNEL_COUNT 2 // number of channels of GENERAL_ADC sampled synchronously to ignition (injected group)
+#define GENERAL_SYNC_SAMPLES 2       // number of samples per ignition event (IGF captured on both edges)
+
+#define SCOPE_CHANNEL_COUNT 2                                 // number of GENERAL_ADC channels scanned during burst capture (first ranks: MAP, BackPressure)
+#define SCOPE_ADC_SAMPLINGCYCLES 56                           // number of cycles that it takes to convert single channel during burst capture
+#define SCOPE_DEPTH 4096                                      // number of sample sets (one sample per channel) held in ring buffer
+#define SCOPE_DMA_LEN (SCOPE_DEPTH * SCOPE_CHANNEL_COUNT)     // length of DMA buffer for burst capture
+#define SCOPE_WINDOW_MAX ((SCOPE_DEPTH / 2) - 32)             // maximal pre + post trigger sample sets, leaves room for DMA running on while stopping
+#define SCOPE_UART_CHUNK 64                                   // number of sample sets sent in one UART transmission
+#define SCOPE_UART_BUF_LEN (((SCOPE_UART_CHUNK * 3 * SCOPE_CHANNEL_COUNT) / 2) + 3) // length of UART buffer, two 12bit samples packed into 3 bytes, +3 for trailer
+
 #define SPEED_CHANNEL_COUNT 4                                                                                                                                                                                              // number of initialized channels of SPEED_ADC
 #define SPEED_ADC_CLOCKDIVIDER 8                                                                                                                                                                                           // values of a clock divider for this peripheral
 #define SPEED_ADC_SAMPLINGCYCLES 480                                                                                                                                                                                       // number of cycles that it takes to conver single channel
@@ -39,7 +52,19 @@
 
 #define PC_UART_BUF_LEN 128 // length of buffer for UART transmission to PC
 
+#define CAN_TX_QUEUE_LEN 16 // number of frames waiting for free CAN mailbox
+
+#define XCP_DAQ_MAX 4       // number of DAQ lists
+#define XCP_ODT_MAX 4       // number of ODTs (one DTO frame each) per DAQ list
+#define XCP_ODT_ENTRY_MAX 7 // number of entries per ODT, each takes at least one byte of DTO
+
+#define SENSOR_BANK_CHANNEL_COUNT 8 // maximal number of sensors handled by single sensor bank (one per data source)
+
 #define DEBUG_QUE_LEN 50                // number of debug messages that will be stored in memory
+#define PROGRAMBLOCK_PROFILING true     // enables execution time measurement of module routines (DWT cycle counter)
+#define LOOP_HISTOGRAM_BUCKETS 16       // number of log2 spaced buckets of main loop period histogram
+#define BOOT_DEPENDENCY_MAX 12          // maximal number of direct dependencies of single module
+#define LOG_ARGS_MAX 4                  // maximal number of arguments of single binary log record
 #define ONBOARD_LED_ANIMATION_QUE_LEN 5 // number of animation access points
 
 union FloatToBytes
@@ -78,6 +103,14 @@ typedef struct
     uint32_t value;  // current value
     uint32_t preset; // preset value
 } Counter;
+typedef struct
+{
+    atomic_uint_least32_t sequence; // odd while writer modifies guarded data
+} nECU_Seqlock;
+typedef struct
+{
+    atomic_uint_least32_t sequence; // number of published sets, lowest bit selects buffer given to readers
+} nECU_Snapshot;
 
 typedef enum
 {
@@ -112,11 +145,16 @@ typedef enum
     TIM_Channel_IC = 2
 } nECU_TIM_Channel_Type;
 typedef struct
+{
+    uint32_t CCR_High, CCR_Low; // time of high and low state [timer ticks]
+    uint16_t frequency;         // of callbacks in Hz
+} nECU_InputCapture_Data;
+typedef struct
 {
     nECU_DigiInput_ID Digi_Input;
-    uint32_t CCR_High, CCR_Low, CCR_prev;
-    uint16_t frequency; // of callbacks in Hz
-    bool newData;       // flag that new data have arrived
+    uint32_t CCR_prev;           // previous capture, used only in interrupt
+    nECU_InputCapture_Data data; // written in interrupt, read with nECU_TIM_IC_Read()
+    nECU_Seqlock lock;           // guards data
 } nECU_InputCapture;
 typedef struct
 {
@@ -166,7 +204,18 @@ typedef enum
 
 typedef struct
 {
-    bool callback_half, callback_full, overflow; // callback flags to indicate DMA buffer states
+    uint32_t half_count, full_count; // number of DMA callbacks
+    uint32_t overflow_count;         // DMA half lost because it was not processed in time
+    uint32_t overrun_count;          // HAL overrun errors (conversion lost, DMA restarted)
+    uint32_t delay_max;              // maximal time from DMA callback to processing [us]
+} nECU_ADC_Stats;
+typedef struct
+{
+    bool overflow;               // filled half was lost because routine did not take it before the next one
+    volatile bool pending;       // latest filled half waits for routine
+    volatile bool full;          // latest filled half is the second one
+    volatile uint32_t timestamp; // cycle counter value of DMA callback of latest filled half
+    nECU_ADC_Stats stats;        // DMA integrity statistics
 } nECU_ADC_Status;
 typedef struct
 {
@@ -186,6 +235,65 @@ typedef struct
     nECU_ADC_Status status;            // statuses
 } nECU_ADC3;
 typedef struct
+{
+    uint16_t out_buffer[GENERAL_SYNC_CHANNEL_COUNT]; // output buffer (result of last ignition event)
+    uint32_t sum[GENERAL_SYNC_CHANNEL_COUNT];        // samples accumulated during current event
+    bool newData[GENERAL_SYNC_CHANNEL_COUNT];        // flags that new event result have arrived
+    uint8_t samples;                                 // number of samples taken in current event
+    uint32_t event_count;                            // number of completed events
+    uint32_t event_tick;                             // tick of last completed event
+} nECU_ADC1_Sync;
+typedef enum
+{
+    ADC1_PROTECT_OVERBOOST_ID,
+    ADC1_PROTECT_BACKPRESSURE_ID,
+    ADC1_PROTECT_ID_MAX
+} nECU_ADC1_Protect_ID;
+typedef struct
+{
+    nECU_ADC1_ID Channel; // guarded sensor
+    uint16_t Threshold;   // upper limit [ADC counts]
+    uint16_t Hysteresis;  // distance below the limit needed to release the flag [ADC counts]
+    volatile bool flag;   // limit exceeded, latched until released
+    uint32_t trip_count;  // number of detected violations
+} nECU_ADC_Protection;
+
+/* Scope */
+typedef enum
+{
+    SCOPE_TRIGGER_MANUAL, // on request (over UART)
+    SCOPE_TRIGGER_LEVEL,  // first sample at or above level
+    SCOPE_TRIGGER_RISING, // sample crossing level upwards
+    SCOPE_TRIGGER_MAX
+} nECU_Scope_Trigger;
+typedef enum
+{
+    SCOPE_STATE_IDLE,      // normal scanning
+    SCOPE_STATE_ARMED,     // burst scanning, looking for trigger
+    SCOPE_STATE_TRIGGERED, // burst scanning, collecting post trigger samples
+    SCOPE_STATE_CAPTURED,  // conversions stopped, waiting for restore of normal scanning
+    SCOPE_STATE_SENDING    // normal scanning, capture being sent over UART
+} nECU_Scope_State;
+typedef struct
+{
+    uint16_t in_buffer[SCOPE_DMA_LEN]; // ring buffer (from DMA), channels interleaved
+    nECU_Scope_Trigger trigger;        // trigger type
+    nECU_ADC1_ID trigger_channel;      // channel checked for trigger
+    uint16_t level;                    // trigger level [ADC counts]
+    uint16_t pre, post;                // number of sample sets before and after trigger
+    volatile nECU_Scope_State state;   // current state of capture
+    volatile bool manual_request;      // manual trigger requested
+    uint32_t written;                  // number of sample sets written since arming
+    uint32_t trigger_index;            // sample set (counted since arming) at which trigger occured
+    uint16_t previous;                 // last checked sample of trigger channel (for edge detection)
+    uint32_t capture_tick;             // tick at which capture was completed
+    bool header_sent;                  // header of current capture was sent
+    uint32_t sent;                     // number of sample sets already sent
+    uint16_t checksum_a, checksum_b;   // Fletcher-16 of sent payload
+    nECU_UART uart;
+    uint8_t out_buf[SCOPE_UART_BUF_LEN];
+} nECU_Scope;
+typedef struct
 {
     uint16_t *ADC_data;  // pointer to ADC data
     int16_t temperature; // output data (real_tem*100)
@@ -265,7 +373,10 @@ typedef enum
 typedef struct
 {
     GPIO_struct CS_pin;                              // GPIO for Chip Select
-    uint8_t in_buffer[4];                            // recived data buffer
+    uint8_t rx_buffer[4];                            // SPI transfer buffer, owned by interrupt
+    uint8_t in_buffer[4];                            // last complete reading, written in interrupt
+    nECU_Seqlock lock;                               // guards in_buffer
+    uint32_t sequence;                               // sequence of last decoded reading
     bool OC_Fault, SCG_Fault, SCV_Fault, Data_Error; // Thermocouple state / data validity
     EGT_Error_Code ErrCode;                          // code of error acording to definition
     uint8_t comm_fail;                               // communication error count to IC
@@ -277,6 +388,7 @@ typedef struct
 {
     MAX31855 TC[EGT_ID_MAX];     // sensor structures
     EGT_Sensor_ID currentSensor; // number of current sensor (for sensor asking loop)
+    bool transfer;               // SPI transfer of current sensor in progress
     nECU_Delay startup;          // used as a delay to prevent spi communication until ICs turn on properly
 } nECU_EGT;
 
@@ -332,29 +444,88 @@ typedef enum
     CAN_TX_Speed_ID,
     CAN_TX_EGT_ID,
     CAN_TX_Stock_ID,
+    CAN_TX_Diag_ID,
     CAN_TX_ID_MAX
 } nECU_CAN_TX_Frame_ID;
 typedef struct
 {
     nECU_CAN_TxFrame can_data; // peripheral data
-    nECU_Delay frame_delay;    // timing between frames
-    Buffer_uint8 buf;
+    uint16_t countdown;        // time until next release, counted by TX timer [ms]
+    bool released;             // frame was queued by TX timer, cleared by 'nECU_CAN_TX_CheckTime'
+    bool failed;               // frame could not be queued by TX timer
+    uint32_t tx_cycles;        // cycle counter value at last TX complete
+    uint32_t tx_count;         // frames transmitted
+    uint32_t jitter_last;      // deviation of last TX interval from period [us]
+    uint32_t jitter_max;       // largest deviation of TX interval from period [us]
 } nECU_CAN_Tx_Data;
 typedef struct
 {
-    uint8_t Buffer[8];                       // message content
-    bool LunchControl[LaunchControl_ID_MAX]; // flags from decoding
+    nECU_CAN_TxFrame frame; // copy of frame taken when queued
+    uint32_t deadline;      // tick after which frame is stale and will not be sent [ms]
+} nECU_CAN_TX_Entry;
+typedef struct
+{
+    nECU_CAN_TX_Entry entry[CAN_TX_QUEUE_LEN]; // sorted by priority, lowest CAN ID and earliest deadline first
+    uint8_t count;                             // number of queued frames
+    uint8_t peak;                              // high water mark of 'count'
+    uint32_t push_count;                       // number of frames passed to queue
+    uint32_t replace_count;                    // number of queued frames overwritten with newer data
+    uint32_t retry_count;                      // number of frames queued again after failed transmission
+    uint32_t drop_count;                       // number of frames lost due to full queue
+    uint32_t expire_count;                     // number of frames removed after their deadline
+} nECU_CAN_TX_Queue;
+typedef enum
+{
+    CAN_BUS_ACTIVE,  // error counters below 96
+    CAN_BUS_WARNING, // any error counter at least 96
+    CAN_BUS_PASSIVE, // any error counter above 127, no active error flags sent
+    CAN_BUS_OFF      // transmit error counter above 255, node disconnected
+} nECU_CAN_Bus_State;
+typedef struct
+{
+    nECU_CAN_Bus_State state;   // fault confinement state from error status register
+    uint8_t TEC, REC;           // transmit and receive error counters
+    uint8_t LEC;                // last error code (0 - none, 1..6 - stuff, form, ack, bit recessive, bit dominant, crc)
+    uint32_t error_code;        // HAL error flags gathered since start
+    uint32_t error_count;       // number of error interrupts
+    uint32_t warning_count;     // transitions into warning state
+    uint32_t passive_count;     // transitions into error passive state
+    uint32_t busoff_count;      // transitions into bus-off state
+    uint32_t recovery_count;    // bus-off recovery sequences started
+    uint32_t busoff_tick;       // tick of last bus-off or recovery attempt [ms]
+    uint32_t backoff;           // time before next recovery attempt [ms]
+    uint32_t mailbox_cycles[3]; // cycle counter value when frame was put into mailbox
+    uint8_t mailbox_DLC[3];     // length of frame in mailbox
+    uint8_t mailbox_frame[3];   // periodic frame in mailbox ('nECU_CAN_TX_Frame_ID'), CAN_TX_ID_MAX for others
+    uint32_t mailbox_StdId[3];  // CAN ID of frame in mailbox, only one frame of each ID is loaded at a time
+    uint32_t latency_last[3];   // time from mailbox load to TX complete of last frame [us]
+    uint32_t latency_max[3];    // longest time from mailbox load to TX complete [us]
+    uint32_t tx_count;          // frames transmitted
+    uint32_t rx_count;          // frames received (only those passing filters)
+    uint32_t bitrate;           // nominal bitrate from bit timing [bit/s]
+    uint32_t bits;              // frame bits seen in current window
+    uint32_t window_tick;       // start of current load window [ms]
+    uint16_t load;              // bus load of last window [0.1%]
+    uint16_t load_max;          // highest bus load [0.1%]
+} nECU_CAN_Health;
+typedef struct
+{
+    nECU_CAN_Speed_Signals signals[2]; // published sets, written by routine
+    nECU_Snapshot snapshot;            // selects set used for composing
+    atomic_uint_least8_t counter;      // rolling counter of composed frames
+    bool ClearCode_sent;               // ClearCode carried by last composed frame
 
     // outside variables
-    bool Stock_GPIO[DigiInput_ID_MAX], *IgnitionKey;
+    bool *IgnitionKey;
     bool *TachoShow[TACHO_ID_MAX];
     bool *Antilag, *TractionOFF, *ClearCode;
     uint16_t *LunchLvl;
-    uint16_t SpeedSensor[ADC2_ID_MAX];
 } Frame0_struct;
 typedef struct
 {
-    uint8_t Buffer[8]; // message content
+    nECU_CAN_EGT_Signals signals[2]; // published sets, written by routine
+    nECU_Snapshot snapshot;          // selects set used for composing
+
     // outside variables
     uint16_t *EGT[EGT_ID_MAX];
     uint8_t *TachoVal[TACHO_ID_MAX];
@@ -362,26 +533,52 @@ typedef struct
 } Frame1_struct;
 typedef struct
 {
-    uint8_t Buffer[8]; // message content
+    nECU_CAN_Stock_Signals signals[2]; // published sets, written by routine (limit flags are added when composing)
+    nECU_Snapshot snapshot;            // selects set used for composing
+    atomic_uint_least8_t counter;      // rolling counter of composed frames, also out of schedule ones
+
     // outside variables
-    uint8_t Backpressure, OX_Val;
-    uint16_t MAP_Stock_10bit;
     uint8_t *Knock;
-    uint8_t VSS;
     uint32_t *loop_time;
 } Frame2_struct;
 typedef enum
+{
+    FRAME3_PAGE_ADC1,
+    FRAME3_PAGE_ADC2,
+    FRAME3_PAGE_ADC3,
+    FRAME3_PAGE_LOOP,
+    FRAME3_PAGE_CAN,
+    FRAME3_PAGE_MAX
+} Frame3_Page_ID;
+typedef struct
+{
+    Frame3_Page_ID page;          // page sent in next frame (multiplexed by first byte)
+    atomic_uint_least8_t counter; // rolling counter of composed frames
+} Frame3_struct;
+typedef enum
 {
     CAN_RX_Wheel_ID,
     CAN_RX_Coolant_ID,
     CAN_RX_RPM_ID,
+    CAN_RX_ISOTP_ID,
+    CAN_RX_XCP_ID,
     CAN_RX_ID_MAX
 } nECU_CAN_RX_Frame_ID;
 typedef struct
 {
-    CAN_FilterTypeDef filter;
-    int32_t output;
+    uint8_t payload[8]; // data of last recived frame
+    uint32_t timestamp; // tick of last reception [ms]
+    uint32_t count;     // number of received frames
+} nECU_CAN_RX_Sample;
+typedef struct
+{
+    nECU_CAN_RX_Sample sample; // written in interrupt
+    nECU_Seqlock lock;         // guards sample
+    uint32_t last_cycles;      // cycle counter value of last reception
+    uint32_t interval_min;     // shortest time between frames [us]
+    uint32_t interval_max;     // longest time between frames [us]
 } nECU_CAN_Rx_Data;
+typedef void (*nECU_CAN_RX_Handler)(nECU_CAN_RX_Frame_ID ID, uint8_t const *data, uint8_t length); // decode of received frame, called from interrupt
 
 /* Input Analog */
 typedef struct
@@ -404,6 +601,22 @@ typedef struct
     uint16_t *Input;               // pointer to ADC input data
     float output;                  // resulting value in float
 } Sensor_Handle;
+typedef struct
+{
+    // per channel data, kept as arrays so that single pass goes threw memory linearly
+    uint16_t *Input[SENSOR_BANK_CHANNEL_COUNT];         // pointers to input data
+    bool *newData[SENSOR_BANK_CHANNEL_COUNT];           // pointers to new data flags (NULL if input is continuous)
+    float factor[SENSOR_BANK_CHANNEL_COUNT];            // calibration factors
+    float offset[SENSOR_BANK_CHANNEL_COUNT];            // calibration offsets
+    float smoothingAlpha[SENSOR_BANK_CHANNEL_COUNT];    // values for smoothing
+    uint16_t previous_Input[SENSOR_BANK_CHANNEL_COUNT]; // values from previous run
+    Buffer_uint16 buf[SENSOR_BANK_CHANNEL_COUNT];       // smoothing buffers
+    nECU_Delay delay[SENSOR_BANK_CHANNEL_COUNT];        // update delay structures
+    float output[SENSOR_BANK_CHANNEL_COUNT];            // resulting values in float
+    // bank data
+    uint32_t enabled;   // mask of channels included in the batch pass
+    uint32_t vref_mask; // mask of channels corrected to vref
+} nECU_SensorBank;
 
 /* Knock */
 typedef struct
@@ -424,6 +637,7 @@ typedef struct
     float RetardPerc;
 
     Knock_Interpol_Table thresholdMap;
+    uint32_t calibration_revision; // revision of calibration 'thresholdMap' was built from
 
     Knock_FFT fft;
 
@@ -470,6 +684,9 @@ typedef struct
 {
     Sensor_Handle sensor;
     nECU_InputCapture *ic; // IC data
+    uint32_t sequence;     // sequence of last snapshot taken from ic
+    uint16_t frequency;    // snapshot of frequency, input of sensor bank
+    bool newData;          // flag that new snapshot was taken
 } nECU_InputFreq;
 
 /* Timer */
@@ -483,6 +700,7 @@ typedef enum
     TIM_FRAME_ID,
     TIM_PWM_LED1_ID,
     TIM_PWM_LED2_ID,
+    TIM_CAN_TX_ID,
     TIM_ID_MAX
 } nECU_TIM_ID;
 typedef struct
@@ -540,6 +758,11 @@ typedef enum
 
     // ProgramBlock
     nECU_ERROR_PROGRAMBLOCK,
+    nECU_ERROR_WATCHDOG_ID, // previous reset was caused by watchdog, value is ID of starved module
+
+    // CAN fault confinement, value is transmit error counter (added last, IDs in flash stay valid)
+    nECU_ERROR_CAN_PASSIVE_ID,
+    nECU_ERROR_CAN_BUSOFF_ID,
 
     nECU_ERROR_NONE
 } nECU_Error_ID;
@@ -630,6 +853,7 @@ typedef enum
     D_ADC1,
     D_ADC2,
     D_ADC3,
+    D_ADC1_Sync,
     // nECU_button.c  !Have to be in the same order as 'Button_ID'!
     D_Button_Red,
     D_Button_Orange,
@@ -653,6 +877,7 @@ typedef enum
     D_Frame_Speed_ID,
     D_Frame_EGT_ID,
     D_Frame_Stock_ID,
+    D_Frame_Diag_ID,
     // nECU_Input_Analog.c !Have to be in the same order as 'nECU_ADC1_ID'!
     D_ANALOG_MAP,
     D_ANALOG_BackPressure,
@@ -670,8 +895,12 @@ typedef enum
     D_VSS,
     D_IGF,
     D_Input_Frequency,
+    // nECU_isotp.c
+    D_ISOTP,
     // nECU_Knock.c
     D_Knock,
+    // nECU_log.c
+    D_Log,
     // nECU_main.c
     D_Main,
     // nECU_menu.c
@@ -681,6 +910,10 @@ typedef enum
     D_OnboardLED,
     // nECU_PC.c
     D_PC,
+    // nECU_scheduler.c
+    D_Scheduler,
+    // nECU_scope.c
+    D_Scope,
     // nECU_stock.c
     D_DigiInput_CRANKING,
     D_DigiInput_FAN_ON,
@@ -697,15 +930,275 @@ typedef enum
     D_TIM_FRAME,
     D_TIM_PWM_LED1,
     D_TIM_PWM_LED2,
+    D_TIM_CAN_TX,
+    // nECU_watchdog.c
+    D_Watchdog,
+    // nECU_xcp.c
+    D_XCP,
     // Last value
     D_ID_MAX
 } nECU_Module_ID;
 typedef struct
+{
+    uint32_t enter_cycles;   // cycle counter value at last enter
+    uint32_t last, min, max; // execution time of last, shortest and longest call [cycles]
+    uint64_t total;          // sum of execution times, used for mean [cycles]
+    uint32_t count;          // number of measured calls
+} nECU_ProgramBlockProfile;
+typedef struct
 {
     nECU_ProgramBlock_Status Status; // Status code
     nECU_TickTrack Update_ticks;     // Ticks it taken since last update call
     uint8_t timeout_value;           // time in seconds after which error should apear
+#if PROGRAMBLOCK_PROFILING == true
+    nECU_ProgramBlockProfile profile; // execution time of routine
+#endif
 } nECU_ProgramBlockData;
+#define FLOWCONTROL_BITMAP_WORDS ((D_ID_MAX + 31) / 32) // number of 32 bit words holding one bit per block
+typedef struct
+{
+    atomic_uint_least32_t stop[FLOWCONTROL_BITMAP_WORDS];        // D_BLOCK_STOP
+    atomic_uint_least32_t initialized[FLOWCONTROL_BITMAP_WORDS]; // D_BLOCK_INITIALIZED
+    atomic_uint_least32_t working[FLOWCONTROL_BITMAP_WORDS];     // D_BLOCK_WORKING
+    atomic_uint_least32_t error_old[FLOWCONTROL_BITMAP_WORDS];   // D_BLOCK_ERROR_OLD
+    atomic_uint_least32_t error[FLOWCONTROL_BITMAP_WORDS];       // D_BLOCK_ERROR
+} nECU_FlowControl_Bitmap; // copy of 'Status' of all blocks packed by state, for constant time checks
+
+/* Queue */
+typedef struct
+{
+    uint8_t *buffer;            // element storage, length * element_size bytes
+    uint16_t element_size;      // size of single element [bytes]
+    uint32_t mask;              // length - 1, length has to be power of two
+    atomic_uint_least32_t head; // free running write index, written only by producer
+    atomic_uint_least32_t tail; // free running read index, written only by consumer
+    uint32_t push_count;        // elements queued (producer side)
+    uint32_t overflow_count;    // elements rejected because queue was full (producer side)
+    uint32_t peak;              // maximal fill level observed (producer side)
+} nECU_Queue;
+
+/* ISO-TP */
+typedef enum
+{
+    ISOTP_STATE_IDLE,      // nothing in progress
+    ISOTP_STATE_WAIT_FC,   // TX: first frame or block sent, waiting for flow control
+    ISOTP_STATE_SENDING,   // TX: sending consecutive frames
+    ISOTP_STATE_RECEIVING, // RX: collecting consecutive frames
+} nECU_ISOTP_State;
+typedef struct
+{
+    uint32_t tx_ID, rx_ID;                          // CAN IDs of outgoing and incoming frames
+    bool (*send)(uint32_t ID, uint8_t const *data); // puts 8 byte frame on the bus, returns true if there is no room now
+    uint8_t block_size, STmin;                      // flow control sent to peer (0 - no limit)
+
+    // transmission
+    nECU_ISOTP_State tx_state;
+    uint8_t const *tx_data;  // message being sent, has to stay valid until done
+    uint16_t tx_length;      // length of message being sent
+    uint16_t tx_offset;      // number of bytes already sent
+    uint8_t tx_sequence;     // sequence number of next consecutive frame
+    uint8_t tx_block_left;   // consecutive frames left in block (0 - no limit)
+    uint32_t tx_STmin;       // separation time requested by peer [us]
+    uint32_t tx_last_cycles; // cycle counter at last consecutive frame
+    uint32_t tx_tick;        // tick of last flow control wait start [ms]
+
+    // reception
+    nECU_ISOTP_State rx_state;
+    uint8_t *rx_buffer;      // storage of incoming message
+    uint16_t rx_size;        // size of 'rx_buffer'
+    uint16_t rx_length;      // length of message being received
+    uint16_t rx_offset;      // number of bytes already received
+    uint8_t rx_sequence;     // expected sequence number
+    uint8_t rx_block_left;   // consecutive frames left until next flow control
+    uint32_t rx_tick;        // tick of last received frame [ms]
+    uint16_t rx_done;        // length of last complete message, 0 if none waiting
+
+    // statistics
+    uint32_t tx_count, rx_count; // number of complete messages
+    uint32_t error_count;        // aborted transfers (timeout, sequence, overflow)
+} nECU_ISOTP_Link;
+
+/* Calibration */
+typedef struct
+{
+    float knock_rpm[FFT_THRESH_TABLE_LEN]; // RPM axis of knock threshold table
+    float knock_min[FFT_THRESH_TABLE_LEN]; // magnitude at which knock level starts
+    float knock_max[FFT_THRESH_TABLE_LEN]; // magnitude of highest knock level
+    float general_alpha;                   // smoothing of GENERAL_ADC DMA averages
+    float speed_alpha;                     // smoothing of SPEED_ADC DMA averages
+} nECU_Calibration;
+typedef enum
+{
+    CALIBRATION_PAGE_RAM,   // working page, writable over XCP
+    CALIBRATION_PAGE_FLASH, // reference page, defaults built into firmware
+    CALIBRATION_PAGE_MAX
+} nECU_Calibration_Page;
+
+/* XCP */
+typedef struct
+{
+    uint32_t address; // start of sampled variable
+    uint8_t size;     // length of sampled variable [bytes]
+} nECU_XCP_ODT_Entry;
+typedef struct
+{
+    nECU_XCP_ODT_Entry entry[XCP_ODT_ENTRY_MAX];
+    uint8_t entry_count; // allocated entries
+} nECU_XCP_ODT;
+typedef struct
+{
+    nECU_XCP_ODT odt[XCP_ODT_MAX];
+    uint8_t odt_count;       // allocated ODTs
+    uint8_t mode;            // mode bits from SET_DAQ_LIST_MODE
+    uint16_t event;          // event channel triggering sampling
+    uint8_t prescaler;       // sample every n-th event
+    uint8_t prescaler_count; // events left until next sample
+    bool selected;           // marked by START_STOP_DAQ_LIST for synchronous start
+    bool running;            // sampled on its event channel
+} nECU_XCP_DAQ;
+typedef struct
+{
+    bool (*send)(uint32_t ID, uint8_t const *data, uint8_t length); // puts frame on the bus, returns true if there is no room now
+    uint32_t DTO_ID;                                                // CAN ID of responses and DAQ frames
+    bool connected;
+    uint32_t MTA;                        // memory transfer address of UPLOAD and DOWNLOAD
+    nECU_XCP_DAQ daq[XCP_DAQ_MAX];
+    uint8_t daq_count;                   // allocated DAQ lists
+    uint8_t ptr_daq, ptr_odt, ptr_entry; // position set by SET_DAQ_PTR, advanced by WRITE_DAQ
+    uint8_t previous;                    // last command with positive response, orders allocation
+
+    // statistics
+    uint32_t command_count;  // commands processed
+    uint32_t error_count;    // negative responses
+    uint32_t dto_count;      // DAQ frames sent
+    uint32_t overload_count; // DAQ frames lost due to full TX queue
+} nECU_XCP;
+
+/* Log */
+typedef struct
+{
+    uint32_t timestamp;          // tick at which record was written [ms]
+    uint32_t args[LOG_ARGS_MAX]; // raw arguments, formatted by host decoder
+    uint16_t format;             // address of format string in '.log_fmt' section (not loaded to target)
+    uint8_t argc;                // number of used arguments
+} nECU_Log_Record;
+
+/* Scheduler */
+typedef enum
+{
+    TASK_KNOCK_ID,
+    TASK_FRAME2_ID,
+    TASK_CAN_TX_ID,
+    TASK_MENU_ID,
+    TASK_FRAME0_ID,
+    TASK_FRAME1_ID,
+    TASK_EGT_ID,
+    TASK_LED_ID,
+    TASK_PC_ID,
+    TASK_SCOPE_ID,
+    TASK_LOG_ID,
+    TASK_WATCHDOG_ID, // lowest priority, watchdog is not fed when loop is saturated
+    TASK_ID_MAX
+} nECU_Task_ID; // order is priority, lower ID is served first
+typedef enum
+{
+    EVENT_ADC1_ID,   // GENERAL_ADC DMA half filled
+    EVENT_ADC2_ID,   // SPEED_ADC DMA half filled
+    EVENT_ADC3_ID,   // KNOCK_ADC DMA half filled
+    EVENT_CAN_RX_ID, // CAN frame recieved
+    EVENT_TIM_IC_ID, // input capture
+    EVENT_SPI_ID,    // SPI transfer done
+    EVENT_UART_ID,   // UART transfer done
+    EVENT_ID_MAX
+} nECU_Event_ID;
+typedef struct
+{
+    uint32_t timestamp; // cycle counter value when event was posted
+    uint16_t data;      // event specific argument (DMA half, frame ID, channel)
+    uint8_t ID;         // nECU_Event_ID
+} nECU_Event;
+typedef struct
+{
+    void (*Routine)(void); // function called when task is released
+    uint16_t period;       // time between releases [ms]
+    uint16_t offset;       // delay of first release [ms], spreads tasks with the same period
+    uint16_t budget;       // expected maximal execution time [us]
+    nECU_Module_ID block;  // program block charged with execution time
+    uint32_t events;       // events that release the task before its period (SCHEDULER_EVENT bits)
+} nECU_Task_Config;
+typedef struct
+{
+    volatile uint16_t countdown; // ticks left to next release
+    volatile bool released;      // waiting for dispatcher
+    uint32_t run_count;          // number of executions
+    uint32_t missed_count;       // releases lost because previous one was not served yet
+    uint32_t over_budget_count;  // executions longer than budget
+    uint32_t exec_max;           // longest execution [us]
+} nECU_Task;
+
+typedef enum
+{
+    LOOP_READER_FRAME,  // diagnostic CAN frame (called from interrupt)
+    LOOP_READER_REPORT, // loop report over UART
+    LOOP_READER_MAX
+} nECU_Loop_Reader;
+typedef struct
+{
+    uint32_t last_cycles;                       // cycle counter value at end of previous pass
+    uint32_t histogram[LOOP_HISTOGRAM_BUCKETS]; // number of passes per period bucket, bucket n holds 2^n to 2^(n+1)-1 us
+    uint32_t period_max[LOOP_READER_MAX];       // longest pass since last read of given reader [us]
+    uint32_t busy_cycles, idle_cycles;          // time spent in passes that served a task and in idle passes (current window)
+    uint16_t load;                              // CPU load of last completed window [0.1%]
+} nECU_LoopStats;
+
+/* Watchdog */
+typedef enum
+{
+    RESET_CAUSE_POWER,    // power on or brown out, retained RAM is not valid
+    RESET_CAUSE_PIN,      // NRST pin
+    RESET_CAUSE_SOFTWARE, // NVIC_SystemReset()
+    RESET_CAUSE_IWDG,     // independent watchdog
+    RESET_CAUSE_WWDG,     // window watchdog
+    RESET_CAUSE_LOWPOWER, // illegal low power mode entry
+    RESET_CAUSE_UNKNOWN
+} nECU_Reset_Cause;
+typedef struct
+{
+    nECU_Module_ID ID; // module that has to check in (nECU_Debug_ProgramBlockData_Update)
+    uint16_t deadline; // maximal time between check ins [ms]
+} nECU_Watchdog_Client;
+typedef struct
+{
+    uint32_t magic;         // WATCHDOG_RECORD_MAGIC when content is valid
+    nECU_Module_ID starved; // module that missed its deadline
+    nECU_Module_ID running; // program block executed by dispatcher at that time (D_ID_MAX if none)
+    uint32_t age;           // time since last check in of starved module [ms]
+    uint32_t uptime;        // time from start to detection [ms]
+    uint32_t reset_count;   // watchdog resets since power on
+} nECU_Watchdog_Record;
+
+/* Boot */
+typedef enum
+{
+    BOOT_STATE_IDLE,    // not requested
+    BOOT_STATE_STARTED, // start function called, waiting until device is ready
+    BOOT_STATE_READY,   // working and ready
+    BOOT_STATE_FAILED   // start function or one of dependencies failed
+} nECU_Boot_State;
+typedef struct
+{
+    bool (*Start)(void);                         // brings module to working state, NULL if it is started by its owner
+    bool (*Stop)(void);                          // stops module, NULL if it is kept running until reset
+    bool (*Ready)(void);                         // returns true once slow device finished its bring up, NULL if ready right after start
+    nECU_Module_ID depends[BOOT_DEPENDENCY_MAX]; // modules that have to be ready before start
+    uint8_t depends_count;                       // number of used 'depends' slots
+} nECU_Module_Config;
+typedef struct
+{
+    nECU_Boot_State state; // progress of bring up
+    uint32_t start_time;   // duration of start function call [us]
+    uint32_t ready_tick;   // tick at which module became ready [ms since reset]
+} nECU_Boot_Record;
 
 /* Flash */
 typedef struct
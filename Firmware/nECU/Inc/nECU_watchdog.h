@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * @file    nECU_watchdog.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_watchdog.c file
+ */
+#ifndef _NECU_WATCHDOG_H_
+#define _NECU_WATCHDOG_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "nECU_types.h"
+#include "nECU_flowControl.h"
+#include "nECU_debug.h"
+#include "nECU_scheduler.h"
+#include "stdio.h"
+
+/* Definitions */
+#define WATCHDOG_ENABLE true                                  // start IWDG, once started it can not be stopped until reset
+#define WATCHDOG_TIMEOUT 200                                  // IWDG timeout [ms], LSI tolerance makes it 136 - 290ms
+#define WATCHDOG_PRESCALER 3                                  // IWDG_PR value, LSI / 32 gives ~1ms per count
+#define WATCHDOG_HOLD_PRESCALER 6                             // IWDG_PR value during long blocking operation, LSI / 256 gives ~8ms per count
+#define WATCHDOG_FLASH_ERASE_TIMEOUT 4000                     // [ms] worst case erase time of 128kB sector
+#define WATCHDOG_REPORT_TIMEOUT 500                           // [ms] longest PC report, line per module at 230400 baud blocks for ~250ms
+#define WATCHDOG_HOLD_DEPTH 4                                 // nested blocking operations with own timeout (like flash erase inside PC command)
+#define WATCHDOG_MANAGER_DEADLINE 100                         // time without manager pass after which loop is recorded as stalled [ms]
+#define WATCHDOG_RECORD_MAGIC 0x57444F47                      // marks valid content of retained record ("WDOG")
+#define WATCHDOG_KEY_START 0xCCCC                             // IWDG_KR value, starts watchdog
+#define WATCHDOG_KEY_ACCESS 0x5555                            // IWDG_KR value, unlocks IWDG_PR and IWDG_RLR
+#define WATCHDOG_KEY_REFRESH 0xAAAA                           // IWDG_KR value, reloads counter
+#define WATCHDOG_RETAINED __attribute__((section(".noinit"))) // RAM not cleared by startup code
+
+    /* Function Prototypes */
+    bool nECU_Watchdog_Start(void);            // read reset cause and start IWDG
+    bool nECU_Watchdog_Stop(void);             // stop supervision, IWDG is then fed from SysTick
+    void nECU_Watchdog_Routine(void);          // feed IWDG if every critical module checked in within its deadline
+    void nECU_Watchdog_Hold(uint16_t timeout); // allow blocking operation (like flash erase) to take up to timeout [ms], can be nested
+    void nECU_Watchdog_Release(void);          // end blocking operation, outermost one returns to normal timeout and deadlines are counted from now
+
+    static nECU_Reset_Cause nECU_Watchdog_ReadResetCause(void);                    // decode and clear RCC reset flags
+    static void nECU_Watchdog_Record_Set(nECU_Module_ID starved, uint32_t age);    // store starving module in retained RAM
+    static void nECU_Watchdog_Hardware_Start(void);                                // configure and start IWDG
+    static void nECU_Watchdog_Hardware_Config(uint8_t prescaler, uint16_t reload); // write IWDG timing and reload counter
+    static void nECU_Watchdog_Hardware_Refresh(void);                              // reload IWDG counter
+
+    /* Interrupt functions */
+    void nECU_Watchdog_Tick(void); // detect stalled main loop, to be called from 1ms timer interrupt
+
+    nECU_Reset_Cause nECU_Watchdog_getResetCause(void);  // returns cause of last reset
+    nECU_Watchdog_Record *nECU_Watchdog_getRecord(void); // returns record of watchdog reset, NULL if last reset was not caused by watchdog
+    void nECU_Watchdog_Report(void);                     // print reset cause and watchdog record over UART
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_WATCHDOG_H_ */
@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ * @file    nECU_xcp.h
+ * @brief   This file contains all the function prototypes for
+ *          the nECU_xcp.c file
+ */
+#ifndef _NECU_XCP_H_
+#define _NECU_XCP_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes */
+#include "main.h"
+#include "stdio.h"
+#include "stdbool.h"
+#include "string.h"
+#include "nECU_types.h"
+#include "nECU_flowControl.h"
+#include "nECU_can.h"
+#include "nECU_calibration.h"
+
+/* Definitions */
+#define XCP_CRO_ID 0x5E0                                         // CAN ID of commands sent by calibration tool
+#define XCP_DTO_ID 0x5E1                                         // CAN ID of responses and DAQ frames sent by nECU
+#define XCP_TIMEOUT 1000                                         // age of last command before tool is considered silent [ms]
+#define XCP_EVENT_TASK(ID) (ID)                                  // event channel of scheduler task, sampled after routine
+#define XCP_EVENT_ADC(ID) (TASK_ID_MAX + ((ID) - EVENT_ADC1_ID)) // event channel of ADC DMA callback
+#define XCP_EVENT_MAX (TASK_ID_MAX + 3)                          // number of event channels
+#define XCP_PID_MAX (XCP_DAQ_MAX * XCP_ODT_MAX)                  // absolute ODT numbers, have to stay below command PIDs
+#define XCP_DTO_PAYLOAD_MAX 7                                    // data bytes of DAQ frame after PID
+#define XCP_TEST_EVENT 0                                         // event channel used by 'nECU_XCP_test'
+#define XCP_FLASH_SIZE 0x100000                                  // readable range from FLASH_BASE
+#define XCP_SRAM_SIZE 0x20000                                    // readable range from SRAM1_BASE (SRAM1 and SRAM2)
+#define XCP_CCM_SIZE 0x10000                                     // readable range from CCMDATARAM_BASE
+
+// Packet identifiers
+#define XCP_PID_RES 0xFF // positive response
+#define XCP_PID_ERR 0xFE // negative response
+
+// Commands
+#define XCP_CMD_CONNECT 0xFF
+#define XCP_CMD_DISCONNECT 0xFE
+#define XCP_CMD_GET_STATUS 0xFD
+#define XCP_CMD_SYNCH 0xFC
+#define XCP_CMD_SET_MTA 0xF6
+#define XCP_CMD_UPLOAD 0xF5
+#define XCP_CMD_SHORT_UPLOAD 0xF4
+#define XCP_CMD_DOWNLOAD 0xF0
+#define XCP_CMD_SET_CAL_PAGE 0xEB
+#define XCP_CMD_GET_CAL_PAGE 0xEA
+#define XCP_CMD_SET_DAQ_PTR 0xE2
+#define XCP_CMD_WRITE_DAQ 0xE1
+#define XCP_CMD_SET_DAQ_LIST_MODE 0xE0
+#define XCP_CMD_START_STOP_DAQ_LIST 0xDE
+#define XCP_CMD_START_STOP_SYNCH 0xDD
+#define XCP_CMD_GET_DAQ_PROCESSOR_INFO 0xDA
+#define XCP_CMD_FREE_DAQ 0xD6
+#define XCP_CMD_ALLOC_DAQ 0xD5
+#define XCP_CMD_ALLOC_ODT 0xD4
+#define XCP_CMD_ALLOC_ODT_ENTRY 0xD3
+
+// Error codes
+#define XCP_ERR_CMD_SYNCH 0x00
+#define XCP_ERR_DAQ_ACTIVE 0x11
+#define XCP_ERR_CMD_UNKNOWN 0x20
+#define XCP_ERR_CMD_SYNTAX 0x21
+#define XCP_ERR_OUT_OF_RANGE 0x22
+#define XCP_ERR_WRITE_PROTECTED 0x23
+#define XCP_ERR_ACCESS_DENIED 0x24
+#define XCP_ERR_PAGE_NOT_VALID 0x26
+#define XCP_ERR_SEGMENT_NOT_VALID 0x28
+#define XCP_ERR_SEQUENCE 0x29
+#define XCP_ERR_DAQ_CONFIG 0x2A
+#define XCP_ERR_MEMORY_OVERFLOW 0x30
+
+// Resources and modes
+#define XCP_RESOURCE_CAL_PAG 0x01     // calibration and paging
+#define XCP_RESOURCE_DAQ 0x04         // data acquisition
+#define XCP_STATUS_DAQ_RUNNING 0x40   // session status, at least one DAQ list is running
+#define XCP_DAQ_PROPERTIES 0x03       // dynamic configuration, prescaler supported
+#define XCP_DAQ_KEY_BYTE 0x00         // absolute ODT number as PID, no address extension
+#define XCP_PAGE_MODE_ECU 0x01        // SET_CAL_PAGE applies to ECU access
+#define XCP_PAGE_MODE_XCP 0x02        // SET_CAL_PAGE applies to XCP access
+#define XCP_PAGE_MODE_ALL 0x80        // SET_CAL_PAGE applies to all segments
+#define XCP_DAQ_MODE_TIMESTAMP 0x10   // not supported
+#define XCP_START_STOP_STOP 0x00      // stop DAQ list
+#define XCP_START_STOP_START 0x01     // start DAQ list
+#define XCP_START_STOP_SELECT 0x02    // select DAQ list for START_STOP_SYNCH
+#define XCP_SYNCH_STOP_ALL 0x00       // stop all DAQ lists
+#define XCP_SYNCH_START_SELECTED 0x01 // start selected DAQ lists
+#define XCP_SYNCH_STOP_SELECTED 0x02  // stop selected DAQ lists
+
+    /* Function Prototypes */
+    /* General functions */
+    bool nECU_XCP_Start(void);                                                               // prepare slave on 'hcan1'
+    bool nECU_XCP_Stop(void);                                                                // stop DAQ and disconnect
+    void nECU_XCP_RX_Handler(nECU_CAN_RX_Frame_ID ID, uint8_t const *data, uint8_t length); // command from 'XCP_CRO_ID' received (called from interrupt)
+    void nECU_XCP_Event(uint16_t channel);                                                   // sample DAQ lists of given event channel
+
+    /* Slave functions, work on any bus */
+    void nECU_XCP_Init(nECU_XCP *xcp, uint32_t DTO_ID, bool (*send)(uint32_t, uint8_t const *, uint8_t)); // prepare slave structure
+    void nECU_XCP_Command(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length);                         // process command and send response
+    void nECU_XCP_Event_Sample(nECU_XCP *xcp, uint16_t channel);                                      // send DTOs of running DAQ lists of given event channel
+    static uint8_t nECU_XCP_Command_Memory(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t *res, uint8_t *res_length); // memory access commands, returns error code or XCP_PID_RES
+    static uint8_t nECU_XCP_Command_DAQ(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t *res, uint8_t *res_length);    // DAQ commands, returns error code or XCP_PID_RES
+    static void nECU_XCP_DAQ_Free(nECU_XCP *xcp);                                                     // stop and drop all DAQ lists
+    static bool nECU_XCP_isRunning(nECU_XCP const *xcp);                                              // returns true if any DAQ list is running
+    static bool nECU_XCP_isReadable(uint32_t address, uint8_t size);                                  // returns true if range lies in flash or RAM
+    static uint32_t nECU_XCP_getDword(uint8_t const *data);                                           // little endian address from command
+    static bool nECU_XCP_CAN_Send(uint32_t ID, uint8_t const *data, uint8_t length);                  // output of slave to 'hcan1' TX queue
+
+    /* Test */
+    static bool nECU_XCP_test_Send(uint32_t ID, uint8_t const *data, uint8_t length);                       // captures last frame of test slave
+    static bool nECU_XCP_test_Command(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t expected); // send command, returns true if response starts with expected PID
+    bool nECU_XCP_test(bool logging_enable);                                                                // Run test
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NECU_XCP_H_ */
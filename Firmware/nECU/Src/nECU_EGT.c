@@ -75,6 +75,11 @@ bool nECU_EGT_Stop(void) // stop the routines
 
     return status;
 }
+bool nECU_EGT_isReady(void) // returns true once sensors finished their startup
+{
+    nECU_Delay_Update(&(EGT_data.startup));
+    return EGT_data.startup.done;
+}
 void nECU_EGT_Routine(void) // periodic function to be called every main loop execution
 {
     if (EGT_data.startup.done == false) // Break if still in booting
@@ -82,6 +87,23 @@ void nECU_EGT_Routine(void) // periodic function to be called every main loop ex
         nECU_Delay_Update(&(EGT_data.startup));
         return;
     }
+
+    // decode readings completed in interrupt
+    for (EGT_Sensor_ID current_ID = 0; current_ID < EGT_ID_MAX; current_ID++)
+    {
+        if (!nECU_FlowControl_Working_Check(D_EGT1 + current_ID)) // Do for working sensors
+            continue;
+
+        uint8_t raw[sizeof(EGT_data.TC[current_ID].in_buffer)];
+        uint32_t sequence = 0;
+        if (!nECU_Seqlock_Read(&(EGT_data.TC[current_ID].lock), raw, EGT_data.TC[current_ID].in_buffer, sizeof(raw), &sequence))
+            continue; // reading published right now, take it next time
+        if (sequence == EGT_data.TC[current_ID].sequence) // nothing new
+            continue;
+
+        EGT_data.TC[current_ID].sequence = sequence;
+        MAX31855_ConvertData(&EGT_data.TC[current_ID], raw);
+    }
     // MAX31855_UpdateSimple(&EGT_data.TC[0], &hspi1);
     // MAX31855_UpdateSimple(&EGT_data.TC[1], &hspi1);
     // MAX31855_UpdateSimple(&EGT_data.TC[2], &hspi1);
@@ -109,17 +131,12 @@ void nECU_EGT_RequestUpdate(void) // indicate that update is needed
 
 void nECU_EGT_Callback(void) // callback from SPI_TX end callback
 {
-
-    EGT_data.currentSensor++;
-    if (EGT_data.currentSensor >= EGT_ID_MAX) // Break if invalid ID
-        return;
-    while (!nECU_FlowControl_Working_Check(D_EGT1 + (EGT_data.currentSensor))) // find next working sensor
+    if (EGT_data.transfer && EGT_data.currentSensor < EGT_ID_MAX) // publish finished reading as a whole
     {
-        EGT_data.currentSensor++;
-        if (EGT_data.currentSensor >= EGT_ID_MAX) // Break if invalid ID
-            return;
+        MAX31855 *inst = &EGT_data.TC[EGT_data.currentSensor];
+        nECU_Seqlock_Write(&(inst->lock), inst->in_buffer, inst->rx_buffer, sizeof(inst->in_buffer));
     }
-    nECU_SPI_Rx_IT_Start(&(EGT_data.TC[EGT_data.currentSensor].CS_pin), SPI_EGT_ID, (uint8_t *)EGT_data.TC[EGT_data.currentSensor].in_buffer, 4); // start reciving data
+    nECU_EGT_Next();
 }
 void nECU_EGT_Error_Callback(void) // Callback after SPI communication fail
 {
@@ -128,7 +145,22 @@ void nECU_EGT_Error_Callback(void) // Callback after SPI communication fail
         nECU_Debug_EGTSPIcomm_error(EGT_data.currentSensor);
         EGT_data.TC[EGT_data.currentSensor].comm_fail = 0;
     }
-    nECU_EGT_Callback();
+    nECU_EGT_Next();
+}
+static void nECU_EGT_Next(void) // start transfer of next working sensor
+{
+    EGT_data.transfer = false;
+    EGT_data.currentSensor++;
+    if (EGT_data.currentSensor >= EGT_ID_MAX) // Break if invalid ID
+        return;
+    while (!nECU_FlowControl_Working_Check(D_EGT1 + (EGT_data.currentSensor))) // find next working sensor
+    {
+        EGT_data.currentSensor++;
+        if (EGT_data.currentSensor >= EGT_ID_MAX) // Break if invalid ID
+            return;
+    }
+    EGT_data.transfer = true;
+    nECU_SPI_Rx_IT_Start(&(EGT_data.TC[EGT_data.currentSensor].CS_pin), SPI_EGT_ID, (uint8_t *)EGT_data.TC[EGT_data.currentSensor].rx_buffer, 4); // start reciving data
 }
 
 static bool nECU_EGT_Start_Single(EGT_Sensor_ID ID) // Perform start for single sensor
@@ -182,6 +214,8 @@ static bool MAX31855_Init(MAX31855 *inst, GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin
     inst->Data_Error = false;
     inst->InternalTemp = 0;
     inst->TcTemp = 0;
+    atomic_init(&(inst->lock.sequence), 0);
+    inst->sequence = 0;
 
     inst->CS_pin.GPIOx = GPIOx;
     inst->CS_pin.GPIO_Pin = GPIO_Pin;
@@ -220,30 +254,30 @@ static void MAX31855_UpdateSimple(MAX31855 *inst, SPI_HandleTypeDef *hspi) // Re
     status = HAL_SPI_Receive(hspi, (uint8_t *)inst->in_buffer, sizeof(inst->in_buffer), 100);
     HAL_GPIO_WritePin(inst->CS_pin.GPIOx, inst->CS_pin.GPIO_Pin, GPIO_PIN_SET);
     if (status == HAL_OK)
-        MAX31855_ConvertData(inst);
+        MAX31855_ConvertData(inst, inst->in_buffer);
     else
         return;
 }
-static void MAX31855_ConvertData(MAX31855 *inst) // For internal use bit decoding and data interpretation
+static void MAX31855_ConvertData(MAX31855 *inst, uint8_t const *raw) // For internal use bit decoding and data interpretation
 {
-    if (inst == NULL) // Break if pointers do not exist
+    if (inst == NULL || raw == NULL) // Break if pointers do not exist
         return;
 
-    inst->OC_Fault = (inst->in_buffer[3] >> 0) & 0x01;
-    inst->SCG_Fault = (inst->in_buffer[3] >> 1) & 0x01;
-    inst->SCV_Fault = (inst->in_buffer[3] >> 2) & 0x01;
-    inst->Data_Error = (inst->in_buffer[1] >> 7) & 0x01;
+    inst->OC_Fault = (raw[3] >> 0) & 0x01;
+    inst->SCG_Fault = (raw[3] >> 1) & 0x01;
+    inst->SCV_Fault = (raw[3] >> 2) & 0x01;
+    inst->Data_Error = (raw[1] >> 7) & 0x01;
     inst->InternalTemp = 130;
     inst->TcTemp = 1300;
 
     if (!(inst->Data_Error) || BENCH_MODE) // ignore errors in bench mode
     {
-        inst->TcTemp = ((inst->in_buffer[0] << 6) | (inst->in_buffer[1] >> 2)) * 0.25;
-        if (inst->in_buffer[0] & 0x80) // negative sign
+        inst->TcTemp = ((raw[0] << 6) | (raw[1] >> 2)) * 0.25;
+        if (raw[0] & 0x80) // negative sign
             inst->TcTemp = -inst->TcTemp;
 
-        inst->InternalTemp = ((inst->in_buffer[2] << 4) | (inst->in_buffer[3] >> 4)) * 0.0625;
-        if (inst->in_buffer[2] & 0x80) // negative sign
+        inst->InternalTemp = ((raw[2] << 4) | (raw[3] >> 4)) * 0.0625;
+        if (raw[2] & 0x80) // negative sign
             inst->InternalTemp = -inst->InternalTemp;
 
         inst->IC_Temperature = inst->InternalTemp; // float to int16_t
@@ -8,7 +8,7 @@
 #include "nECU_Input_Analog.h"
 
 /*ADC 1*/
-static Sensor_Handle ADC1_List[ADC1_ID_MAX] = {0}; // List of sensors ADC1
+static nECU_SensorBank ADC1_Bank = {0}; // Bank of sensors ADC1
 // Adjust below values!!
 static SensorCalibration ADC1_calib_List[ADC1_ID_MAX] = {
     [ADC1_MAP_ID] = {
@@ -86,9 +86,19 @@ static float ADC1_Alpha_List[ADC1_ID_MAX] = {
     [ADC1_MCUTemp_ID] = 1.0,
     [ADC1_VREF_ID] = 1.0,
 }; // List of alphas for smoothing
+static bool ADC1_Sync_List[ADC1_ID_MAX] = {
+    [ADC1_MAP_ID] = true,
+    [ADC1_BackPressure_ID] = false,
+    [ADC1_OX_ID] = false,
+    [ADC1_AI_1_ID] = false,
+    [ADC1_AI_2_ID] = false,
+    [ADC1_AI_3_ID] = false,
+    [ADC1_MCUTemp_ID] = false,
+    [ADC1_VREF_ID] = false,
+}; // List of sensors sampled on ignition events while engine is running (must be in ADC1 injected group)
 
 /*ADC 2*/
-static Sensor_Handle ADC2_List[ADC2_ID_MAX] = {0};                      // List of sensors ADC1
+static nECU_SensorBank ADC2_Bank = {0};                                 // Bank of sensors ADC2
 static uint16_t ADC2_Smoothing[ADC2_ID_MAX][SPEED_AVERAGE_BUFFER_SIZE]; // buffer to be filled with ADC data
 // Adjust below values!!
 static SensorCalibration ADC2_calib_List[ADC2_ID_MAX] = {
@@ -132,12 +142,15 @@ static float ADC2_Alpha_List[ADC2_ID_MAX] = {
     [ADC2_VSS_RR_ID] = 0.04,
 }; // List of alphas for smoothing
 
-float nECU_correctToVref(float input)
+static float nECU_InputAnalog_Vref_getFactor(void) // returns ratio of measured reference to the nominal one
 {
     if (!nECU_FlowControl_Working_Check(D_ANALOG_VREF))
-        return input;
-    nECU_InputAnalog_ADC1_Routine(ADC1_VREF_ID);
-    return (ADC1_List[ADC1_VREF_ID].output * input) / VREFINT_CAL_VREF;
+        return 1.0;
+    return ADC1_Bank.output[ADC1_VREF_ID] / VREFINT_CAL_VREF;
+}
+float nECU_correctToVref(float input)
+{
+    return input * nECU_InputAnalog_Vref_getFactor();
 }
 
 /*ADC 1*/
@@ -159,31 +172,32 @@ bool nECU_InputAnalog_ADC1_Start(nECU_ADC1_ID ID)
             ADC1_calib_List[ID].ADC_MeasuredMax = *(VREFINT_CAL_ADDR);
         }
 
-        // Pointers
+        // Pointers, calibration, filtering
         if (nECU_ADC1_getPointer(ID))
-            ADC1_List[ID].Input = nECU_ADC1_getPointer(ID);
+            status |= nECU_SensorBank_Attach(&ADC1_Bank, ID, nECU_ADC1_getPointer(ID), &ADC1_calib_List[ID], ADC1_Alpha_List[ID], ADC1_Buffer_List[ID], ADC1_delay_List[ID]);
         else
             status |= true;
 
-        // Calibration
-        ADC1_List[ID].calibration = ADC1_calib_List[ID];
-        nECU_calculateLinearCalibration(&(ADC1_List[ID].calibration));
+        // Vref correction for all except reference itself
+        if (ID != ADC1_VREF_ID)
+            ADC1_Bank.vref_mask |= (1 << ID);
 
-        // Filtering
-        ADC1_List[ID].filter.smoothingAlpha = ADC1_Alpha_List[ID];
-        ADC1_List[ID].filter.buf = ADC1_Buffer_List[ID];
-        status |= nECU_Delay_Set(&(ADC1_List[ID].filter.delay), ADC1_delay_List[ID]);
-
-        // Default value
-        ADC1_List[ID].output = 0.0;
+        // Crank synchronous sampling
+        if (ADC1_Sync_List[ID] && !nECU_ADC1_Sync_getPointer(ID))
+            status |= true;
 
         if (!status)
             status |= !nECU_FlowControl_Initialize_Do(D_ANALOG_MAP + ID);
     }
     if (!nECU_FlowControl_Working_Check(D_ANALOG_MAP + ID) && status == false)
     {
-        status |= nECU_Delay_Start(&(ADC1_List[ID].filter.delay));
         status |= nECU_ADC1_START();
+        if (ADC1_Sync_List[ID])
+        {
+            status |= nECU_FreqInput_Start(FREQ_IGF_ID); // source of trigger
+            status |= nECU_ADC1_Sync_Start();
+        }
+        status |= nECU_SensorBank_Enable(&ADC1_Bank, ID);
         if (!status)
             status |= !nECU_FlowControl_Working_Do(D_ANALOG_MAP + ID);
     }
@@ -200,10 +214,16 @@ bool nECU_InputAnalog_ADC1_Stop(nECU_ADC1_ID ID)
     bool status = false;
     if (nECU_FlowControl_Working_Check(D_ANALOG_MAP + ID) && status == false)
     {
-        status |= nECU_Delay_Stop(&(ADC1_List[ID].filter.delay));
+        status |= nECU_SensorBank_Disable(&ADC1_Bank, ID);
         if (!status)
             status |= !nECU_FlowControl_Stop_Do(D_ANALOG_MAP + ID);
 
+        bool sync_used = false;
+        for (nECU_ADC1_ID current_ID = 0; current_ID < ADC1_ID_MAX; current_ID++)
+            sync_used |= ADC1_Sync_List[current_ID] && nECU_FlowControl_Working_Check(D_ANALOG_MAP + current_ID);
+        if (ADC1_Sync_List[ID] && !sync_used)
+            status |= nECU_ADC1_Sync_Stop();
+
         status |= nECU_ADC1_STOP();
     }
     if (status)
@@ -223,11 +243,39 @@ void nECU_InputAnalog_ADC1_Routine(nECU_ADC1_ID ID)
     }
 
     nECU_ADC1_Routine(); // Pull new data
+    nECU_InputAnalog_ADC1_Sync_Select();
 
-    nECU_Sensor_Routine(&(ADC1_List[ID]));
+    nECU_SensorBank_Routine(&ADC1_Bank, (1 << ID), (ID == ADC1_VREF_ID) ? 1.0 : nECU_InputAnalog_Vref_getFactor());
 
     nECU_Debug_ProgramBlockData_Update(D_ANALOG_MAP + ID);
 }
+void nECU_InputAnalog_ADC1_Routine_Batch(void) // update all working sensors of ADC1 in single pass
+{
+    if (ADC1_Bank.enabled == 0) // nothing to update
+        return;
+
+    nECU_ADC1_Routine(); // Pull new data once for all sensors
+    nECU_InputAnalog_ADC1_Sync_Select();
+
+    nECU_SensorBank_Routine(&ADC1_Bank, (1 << ADC1_VREF_ID), 1.0);                                  // reference first
+    nECU_SensorBank_Routine(&ADC1_Bank, ~(1 << ADC1_VREF_ID), nECU_InputAnalog_Vref_getFactor()); // then the rest
+
+    for (uint32_t pending = ADC1_Bank.enabled; pending; pending &= pending - 1)
+        nECU_Debug_ProgramBlockData_Update(D_ANALOG_MAP + __builtin_ctz(pending));
+}
+
+static void nECU_InputAnalog_ADC1_Sync_Select(void) // connect sensors to per event results while engine is running, to averaged data otherwise
+{
+    bool fresh = nECU_ADC1_Sync_isFresh();
+    for (nECU_ADC1_ID current_ID = 0; current_ID < ADC1_ID_MAX; current_ID++)
+    {
+        if (!ADC1_Sync_List[current_ID])
+            continue;
+
+        ADC1_Bank.Input[current_ID] = fresh ? nECU_ADC1_Sync_getPointer(current_ID) : nECU_ADC1_getPointer(current_ID);
+        ADC1_Bank.newData[current_ID] = fresh ? nECU_ADC1_Sync_getPointer_newData(current_ID) : NULL;
+    }
+}
 
 float nECU_InputAnalog_ADC1_getValue(nECU_ADC1_ID ID) // returns output value
 {
@@ -240,7 +288,7 @@ float nECU_InputAnalog_ADC1_getValue(nECU_ADC1_ID ID) // returns output value
         return 0.0; // Break
     }
 
-    return ADC1_List[ID].output;
+    return ADC1_Bank.output[ID];
 }
 
 /*ADC 2*/
@@ -252,31 +300,22 @@ bool nECU_InputAnalog_ADC2_Start(nECU_ADC2_ID ID)
     bool status = false;
     if (!nECU_FlowControl_Initialize_Check(D_ANALOG_SS1 + ID) && status == false)
     {
-        // Pointers
+        // Pointers, calibration, filtering
         if (nECU_ADC2_getPointer(ID))
-            ADC2_List[ID].Input = nECU_ADC2_getPointer(ID);
+            status |= nECU_SensorBank_Attach(&ADC2_Bank, ID, nECU_ADC2_getPointer(ID), &ADC2_calib_List[ID], ADC2_Alpha_List[ID], ADC2_Buffer_List[ID], ADC2_delay_List[ID]);
         else
             status |= true;
 
-        // Calibration
-        ADC2_List[ID].calibration = ADC2_calib_List[ID];
-        nECU_calculateLinearCalibration(&(ADC2_List[ID].calibration));
-
-        // Filtering
-        ADC2_List[ID].filter.smoothingAlpha = ADC2_Alpha_List[ID];
-        ADC2_List[ID].filter.buf = ADC2_Buffer_List[ID];
-        status |= nECU_Delay_Set(&(ADC2_List[ID].filter.delay), ADC2_delay_List[ID]);
-
-        // Default value
-        ADC2_List[ID].output = 0.0;
+        // Vref correction
+        ADC2_Bank.vref_mask |= (1 << ID);
 
         if (!status)
             status |= !nECU_FlowControl_Initialize_Do(D_ANALOG_SS1 + ID);
     }
     if (!nECU_FlowControl_Working_Check(D_ANALOG_SS1 + ID) && status == false)
     {
-        status |= nECU_Delay_Start(&(ADC2_List[ID].filter.delay));
         status |= nECU_ADC2_START();
+        status |= nECU_SensorBank_Enable(&ADC2_Bank, ID);
         if (!status)
             status |= !nECU_FlowControl_Working_Do(D_ANALOG_SS1 + ID);
     }
@@ -293,7 +332,7 @@ bool nECU_InputAnalog_ADC2_Stop(nECU_ADC2_ID ID)
     bool status = false;
     if (nECU_FlowControl_Working_Check(D_ANALOG_SS1 + ID) && status == false)
     {
-        status |= nECU_Delay_Stop(&(ADC2_List[ID].filter.delay));
+        status |= nECU_SensorBank_Disable(&ADC2_Bank, ID);
         if (!status)
             status |= !nECU_FlowControl_Stop_Do(D_ANALOG_SS1 + ID);
 
@@ -317,10 +356,22 @@ void nECU_InputAnalog_ADC2_Routine(nECU_ADC2_ID ID)
 
     nECU_ADC2_Routine(); // Pull new data
 
-    nECU_Sensor_Routine(&(ADC2_List[ID]));
+    nECU_SensorBank_Routine(&ADC2_Bank, (1 << ID), nECU_InputAnalog_Vref_getFactor());
 
     nECU_Debug_ProgramBlockData_Update(D_ANALOG_SS1 + ID);
 }
+void nECU_InputAnalog_ADC2_Routine_Batch(void) // update all working sensors of ADC2 in single pass
+{
+    if (ADC2_Bank.enabled == 0) // nothing to update
+        return;
+
+    nECU_ADC2_Routine(); // Pull new data once for all sensors
+
+    nECU_SensorBank_Routine(&ADC2_Bank, UINT32_MAX, nECU_InputAnalog_Vref_getFactor());
+
+    for (uint32_t pending = ADC2_Bank.enabled; pending; pending &= pending - 1)
+        nECU_Debug_ProgramBlockData_Update(D_ANALOG_SS1 + __builtin_ctz(pending));
+}
 
 float nECU_InputAnalog_ADC2_getValue(nECU_ADC2_ID ID) // returns output value
 {
@@ -333,5 +384,5 @@ float nECU_InputAnalog_ADC2_getValue(nECU_ADC2_ID ID) // returns output value
         return 0.0; // Break
     }
 
-    return ADC2_List[ID].output;
+    return ADC2_Bank.output[ID];
 }
@@ -10,6 +10,7 @@
 static uint16_t VSS_Buffer[10] = {0};
 
 static nECU_InputFreq Sensor_List[FREQ_ID_MAX] = {0};
+static nECU_SensorBank Sensor_Bank = {0}; // Bank of frequency sensors
 static SensorCalibration Sensor_calib_List[FREQ_ID_MAX] = {
     [FREQ_VSS_ID] = {
         0, 36,   // limits of freq readout
@@ -56,17 +57,8 @@ bool nECU_FreqInput_Start(nECU_Freq_ID ID)
 
     if (!nECU_FlowControl_Initialize_Check(D_VSS + ID))
     {
-        // Calibration
-        Sensor_List[ID].sensor.calibration = Sensor_calib_List[ID];
-        nECU_calculateLinearCalibration(&(Sensor_List[ID].sensor.calibration));
-
-        // Filtering
-        Sensor_List[ID].sensor.filter.smoothingAlpha = Sensor_Alpha_List[ID];
-        Sensor_List[ID].sensor.filter.buf = Sensor_Buffer_List[ID];
-        status |= nECU_Delay_Set(&(Sensor_List[ID].sensor.filter.delay), Sensor_delay_List[ID]);
-
-        // Default value
-        Sensor_List[ID].sensor.output = 0.0;
+        // Calibration, filtering (input is connected when IC starts)
+        status |= nECU_SensorBank_Attach(&Sensor_Bank, ID, NULL, &Sensor_calib_List[ID], Sensor_Alpha_List[ID], Sensor_Buffer_List[ID], Sensor_delay_List[ID]);
 
         if (!status)
             status |= !nECU_FlowControl_Initialize_Do(D_VSS + ID);
@@ -74,7 +66,6 @@ bool nECU_FreqInput_Start(nECU_Freq_ID ID)
     if (!nECU_FlowControl_Working_Check(D_VSS + ID) && status == false)
     {
         status |= nECU_TIM_IC_Start(Timer_List[ID], Channel_List[ID], DigiInput_List[ID]);
-        status |= nECU_Delay_Start(&(Sensor_List[ID].sensor.filter.delay));
 
         // Pointers
         if (nECU_TIM_IC_getPointer(Timer_List[ID], Channel_List[ID]))
@@ -83,7 +74,14 @@ bool nECU_FreqInput_Start(nECU_Freq_ID ID)
             status |= true;
 
         // Connect frequency as input to sensor
-        Sensor_List[ID].sensor.Input = &Sensor_List[ID].ic->frequency;
+        if (!status)
+        {
+            Sensor_List[ID].sequence = 0;
+            Sensor_List[ID].newData = false;
+            Sensor_Bank.Input[ID] = &Sensor_List[ID].frequency;
+            Sensor_Bank.newData[ID] = &Sensor_List[ID].newData;
+            status |= nECU_SensorBank_Enable(&Sensor_Bank, ID);
+        }
 
         if (!status)
             status |= !nECU_FlowControl_Working_Do(D_VSS + ID);
@@ -101,7 +99,7 @@ bool nECU_FreqInput_Stop(nECU_Freq_ID ID)
     bool status = false;
     if (nECU_FlowControl_Working_Check(D_VSS + ID) && status == false)
     {
-        status |= nECU_Delay_Stop(&(Sensor_List[ID].sensor.filter.delay));
+        status |= nECU_SensorBank_Disable(&Sensor_Bank, ID);
         status |= nECU_TIM_IC_Stop(Timer_List[ID], Channel_List[ID]);
 
         if (!status)
@@ -122,13 +120,35 @@ void nECU_FreqInput_Routine(nECU_Freq_ID ID)
         nECU_FlowControl_Error_Do(D_VSS + ID);
         return; // Break
     }
-    if (Sensor_List[ID].ic->newData == false) // Check if there is new data to update
-        return;                               // Break
+    nECU_FreqInput_Snapshot(ID);
+    if (Sensor_List[ID].newData == false) // Check if there is new data to update
+        return;                           // Break
 
-    nECU_Sensor_Routine(&(Sensor_List[ID].sensor));
-    Sensor_List[ID].ic->newData = false;
+    nECU_SensorBank_Routine(&Sensor_Bank, (1 << ID), 1.0);
     nECU_Debug_ProgramBlockData_Update(D_VSS + ID);
 }
+void nECU_FreqInput_Routine_Batch(void) // update all working frequency sensors in single pass
+{
+    if (Sensor_Bank.enabled == 0) // nothing to update
+        return;
+
+    for (uint32_t pending = Sensor_Bank.enabled; pending; pending &= pending - 1)
+        nECU_FreqInput_Snapshot(__builtin_ctz(pending));
+    nECU_SensorBank_Routine(&Sensor_Bank, UINT32_MAX, 1.0);
+
+    for (uint32_t pending = Sensor_Bank.enabled; pending; pending &= pending - 1)
+        nECU_Debug_ProgramBlockData_Update(D_VSS + __builtin_ctz(pending));
+}
+
+static void nECU_FreqInput_Snapshot(nECU_Freq_ID ID) // copy frequency written in interrupt as input of sensor bank
+{
+    nECU_InputCapture_Data data;
+    if (!nECU_TIM_IC_Read(Sensor_List[ID].ic, &data, &Sensor_List[ID].sequence))
+        return;
+
+    Sensor_List[ID].frequency = data.frequency;
+    Sensor_List[ID].newData = true;
+}
 
 float nECU_FreqInput_getValue(nECU_Freq_ID ID)
 {
@@ -141,5 +161,5 @@ float nECU_FreqInput_getValue(nECU_Freq_ID ID)
         return 0.0; // Break
     }
 
-    return Sensor_List[ID].sensor.output;
+    return Sensor_Bank.output[ID];
 }
\ No newline at end of file
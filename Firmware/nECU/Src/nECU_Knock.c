@@ -26,10 +26,7 @@ bool nECU_Knock_Start(void) // initialize and start
         nECU_TickTrack_Init(&(Knock.regres));
 
         // initialize threshold table
-        const float inTable1[FFT_THRESH_TABLE_LEN] = {1000, 2000, 3000, 4000, 5000};          // RPM for mapping threshold values
-        const float inTable2[FFT_THRESH_TABLE_LEN] = {28000, 125000, 300000, 450000, 400000}; // Min Knock threashold
-        const float inTable3[FFT_THRESH_TABLE_LEN] = {50000, 150000, 400000, 550000, 500000}; // Max Knock threashold
-        nECU_Table_Set(&(Knock.thresholdMap), inTable1, inTable2, inTable3, FFT_THRESH_TABLE_LEN);
+        nECU_Knock_Table_Update();
 
         // initialize FFT module
         Knock.fft.Index = 0;
@@ -140,6 +137,8 @@ static void nECU_Knock_Evaluate(float *magnitude) // check if magnitude is of kn
     }
 
     rpm_float -= 500;
+    if (Knock.calibration_revision != nECU_Calibration_getRevision()) // table changed over XCP
+        nECU_Knock_Table_Update();
     float threshold_min, threshold_max;
     nECU_Table_Get(&rpm_float, &(Knock.thresholdMap), &threshold_min, &threshold_max);
 
@@ -154,6 +153,12 @@ static void nECU_Knock_Evaluate(float *magnitude) // check if magnitude is of kn
         nECU_Delay_Start(&(Knock.delay));
     }
 }
+static void nECU_Knock_Table_Update(void) // rebuild threshold table from calibration
+{
+    Knock.calibration_revision = nECU_Calibration_getRevision();
+    nECU_Calibration const *calibration = nECU_Calibration_get();
+    nECU_Table_Set(&(Knock.thresholdMap), calibration->knock_rpm, calibration->knock_min, calibration->knock_max, FFT_THRESH_TABLE_LEN);
+}
 bool nECU_Knock_Stop(void) // stop
 {
     bool status = false;
@@ -58,6 +58,11 @@ bool nECU_PC_Start(void) // initializes structures for PC communication over UAR
 
         if (!status)
             status |= !nECU_FlowControl_Working_Do(D_PC);
+        if (!status)
+        {
+            PC.input.length = PC_COMMAND_LEN;
+            nECU_PC_Recieve(); // listen for commands
+        }
     }
     if (status)
         nECU_FlowControl_Error_Do(D_PC);
@@ -71,6 +76,7 @@ bool nECU_PC_Stop(void) // call to stop transmission
     {
         OnBoard_LED_L_Remove_Animation(&(PC.Tx_LED));
         OnBoard_LED_L_Remove_Animation(&(PC.Rx_LED));
+        nECU_UART_Rx_Abort(&(PC.input));
         if (!status)
             status |= !nECU_FlowControl_Stop_Do(D_PC);
     }
@@ -87,6 +93,18 @@ void nECU_PC_Routine(void)
         return; // Break
     }
 
+    if (PC.input.pending) // command recieved
+    {
+        uint8_t command = PC.in_buf[0];
+        PC.input.pending = false;
+        nECU_PC_Recieve(); // listen for next command
+        nECU_PC_Command(command);
+    }
+    else if (!nECU_UART_Rx_Busy(&(PC.input))) // listening was dropped (UART error)
+    {
+        nECU_PC_Recieve();
+    }
+
     nECU_Debug_ProgramBlockData_Update(D_PC);
 }
 
@@ -158,6 +176,54 @@ static void nECU_PC_Recieve(void) // call to start listening for frames
 
     nECU_Debug_ProgramBlockData_Update(D_PC);
 }
+static void nECU_PC_Command(uint8_t command) // execute command recieved from PC
+{
+    nECU_Watchdog_Hold(WATCHDOG_REPORT_TIMEOUT); // printf waits for UART, reports block far longer than deadlines of main loop
+    switch (command)
+    {
+    case PC_CMD_SCOPE_MANUAL:
+        nECU_Scope_Arm(SCOPE_TRIGGER_MANUAL, SCOPE_DEFAULT_CHANNEL, SCOPE_DEFAULT_LEVEL, SCOPE_DEFAULT_PRE, SCOPE_DEFAULT_POST);
+        break;
+    case PC_CMD_SCOPE_LEVEL:
+        nECU_Scope_Arm(SCOPE_TRIGGER_LEVEL, SCOPE_DEFAULT_CHANNEL, SCOPE_DEFAULT_LEVEL, SCOPE_DEFAULT_PRE, SCOPE_DEFAULT_POST);
+        break;
+    case PC_CMD_SCOPE_RISING:
+        nECU_Scope_Arm(SCOPE_TRIGGER_RISING, SCOPE_DEFAULT_CHANNEL, SCOPE_DEFAULT_LEVEL, SCOPE_DEFAULT_PRE, SCOPE_DEFAULT_POST);
+        break;
+    case PC_CMD_SCOPE_TRIGGER:
+        nECU_Scope_Trigger_Manual();
+        break;
+    case PC_CMD_SCOPE_ABORT:
+        nECU_Scope_Abort();
+        break;
+    case PC_CMD_ADC_REPORT:
+        nECU_ADC_Stats_Report();
+        break;
+    case PC_CMD_LOOP_REPORT:
+        nECU_Loop_Report();
+        break;
+    case PC_CMD_EVENT_REPORT:
+        nECU_Scheduler_Event_Report();
+        break;
+    case PC_CMD_RESET_REPORT:
+        nECU_Watchdog_Report();
+        break;
+    case PC_CMD_BOOT_REPORT:
+        nECU_Boot_Report();
+        break;
+    case PC_CMD_CAN_REPORT:
+        nECU_CAN_Report();
+        break;
+#if PROGRAMBLOCK_PROFILING == true
+    case PC_CMD_PROFILE_REPORT:
+        nECU_Debug_ProgramBlock_Report();
+        break;
+#endif
+    default:
+        break;
+    }
+    nECU_Watchdog_Release();
+}
 /* Callbacks */
 void nECU_PC_Tx_Start_Callback(void) // to be called when Tx from PC has started
 {
@@ -173,5 +239,6 @@ void nECU_PC_Rx_Start_Callback(void) // to be called when Rx to PC has started
 }
 void nECU_PC_Rx_Stop_Callback(void) // to be called when Rx to PC is done
 {
+    PC.input.pending = true; // command handled in main loop
     OnBoard_LED_Animation_BlinkStart(&(PC.Rx_LED), 50, 1);
 }
\ No newline at end of file
@@ -231,6 +231,7 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) // Rx completed
     if (huart == &PC_UART)
     {
         nECU_PC_Rx_Stop_Callback();
+        nECU_Scheduler_Event(EVENT_UART_ID, UART_EVENT_RX);
     }
     else if (huart == &IMMO_UART)
     {
@@ -243,6 +244,7 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) // Tx completed
     if (huart == &PC_UART)
     {
         nECU_PC_Tx_Stop_Callback();
+        nECU_Scheduler_Event(EVENT_UART_ID, UART_EVENT_TX);
     }
     else if (huart == &IMMO_UART)
     {
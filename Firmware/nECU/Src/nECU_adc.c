@@ -6,72 +6,158 @@
  */
 
 #include "nECU_adc.h"
+#include "nECU_xcp.h"
 
 // local variables
 static nECU_ADC1 adc1_data = {0};
 static nECU_ADC2 adc2_data = {0};
 static nECU_ADC3 adc3_data = {0};
 
+// hardware limits (analog watchdog), adjust below values!!
+static nECU_ADC_Protection ADC1_Protect_List[ADC1_PROTECT_ID_MAX] = {
+    [ADC1_PROTECT_OVERBOOST_ID] = {
+        ADC1_MAP_ID, // guarded sensor
+        2950, 60,    // limit, hysteresis [ADC counts]
+        false, 0     // Place holders
+    },
+    [ADC1_PROTECT_BACKPRESSURE_ID] = {
+        ADC1_BackPressure_ID, // guarded sensor
+        3150, 60,             // limit, hysteresis [ADC counts]
+        false, 0              // Place holders
+    },
+}; // List of limits checked by analog watchdog
+static volatile nECU_ADC1_Protect_ID adc1_protect_current = ADC1_PROTECT_ID_MAX; // limit currently guarded by analog watchdog
+static volatile bool adc1_protect_active = false;                                 // analog watchdog configured and running
+
+// crank synchronous sampling (injected group)
+static nECU_ADC1_Sync adc1_sync = {0};
+static nECU_ADC1_ID const ADC1_Sync_Channel_List[GENERAL_SYNC_CHANNEL_COUNT] = {
+    [0] = ADC1_MAP_ID,
+    [1] = ADC1_BackPressure_ID,
+}; // List of sensors in injected group, in order of injected ranks
+
+// burst capture (scope mode)
+static volatile bool adc1_scope_active = false;    // GENERAL_ADC scans only scope channels
+static uint32_t adc1_scope_SQR1, adc1_scope_SMPR2; // normal scan configuration saved for restore
+
 /* Interrupt functions */
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
   if (hadc == &GENERAL_ADC) // if ADC1 perform its routine
   {
-    if (adc1_data.status.callback_full == true) // check if routine was not called
+    nECU_ADC1_Protect_Rotate(); // share analog watchdog between limits, guarded by channel also in scope mode
+    if (adc1_scope_active)      // buffer belongs to burst capture
     {
-      adc1_data.status.overflow = true;
+      nECU_Scope_ADC_Callback(true);
+      return;
     }
-    adc1_data.status.callback_half = false; // clear flag to prevent memory access while DMA working
-    adc1_data.status.callback_full = true;
+    nECU_ADC_DMA_Callback(&adc1_data.status, EVENT_ADC1_ID, true);
   }
   else if (hadc == &SPEED_ADC) // if ADC2 perform its routine
   {
-    if (adc2_data.status.callback_full == true) // check if routine was not called
-    {
-      adc2_data.status.overflow = true;
-    }
-    adc2_data.status.callback_half = false; // clear flag to prevent memory access while DMA working
-    adc2_data.status.callback_full = true;
+    nECU_ADC_DMA_Callback(&adc2_data.status, EVENT_ADC2_ID, true);
   }
   else if (hadc == &KNOCK_ADC) // if ADC3 perform its routine
   {
-    if (adc3_data.status.callback_full == true) // check if routine was not called
-    {
-      adc3_data.status.overflow = true;
-    }
-    adc3_data.status.callback_half = false; // clear flag to prevent memory access while DMA working
-    adc3_data.status.callback_full = true;
+    nECU_ADC_DMA_Callback(&adc3_data.status, EVENT_ADC3_ID, true);
   }
 }
 void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
 {
   if (hadc == &GENERAL_ADC) // if ADC1 perform its routine
   {
-    if (adc1_data.status.callback_half == true) // check if routine was not called
+    nECU_ADC1_Protect_Rotate(); // share analog watchdog between limits, guarded by channel also in scope mode
+    if (adc1_scope_active)      // buffer belongs to burst capture
     {
-      adc1_data.status.overflow = true;
+      nECU_Scope_ADC_Callback(false);
+      return;
     }
-    adc1_data.status.callback_half = true;
-    adc1_data.status.callback_full = false; // clear flag to prevent memory access while DMA working
+    nECU_ADC_DMA_Callback(&adc1_data.status, EVENT_ADC1_ID, false);
   }
   else if (hadc == &SPEED_ADC) // if ADC2 perform its routine
   {
-    if (adc2_data.status.callback_half == true) // check if routine was not called
-    {
-      adc2_data.status.overflow = true;
-    }
-    adc2_data.status.callback_half = true;
-    adc2_data.status.callback_full = false; // clear flag to prevent memory access while DMA working
+    nECU_ADC_DMA_Callback(&adc2_data.status, EVENT_ADC2_ID, false);
   }
   else if (hadc == &KNOCK_ADC) // if ADC3 perform its routine
   {
-    if (adc3_data.status.callback_half == true) // check if routine was not called
+    nECU_ADC_DMA_Callback(&adc3_data.status, EVENT_ADC3_ID, false);
+  }
+}
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
+{
+  nECU_ADC_Status *status = NULL;
+  uint16_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (hadc == &GENERAL_ADC)
+  {
+    if (adc1_scope_active) // ring buffer order is lost, drop capture
     {
-      adc3_data.status.overflow = true;
+      adc1_data.status.stats.overrun_count += ((HAL_ADC_GetError(hadc) & HAL_ADC_ERROR_OVR) != 0);
+      nECU_Scope_Abort();
+      return;
     }
-    adc3_data.status.callback_half = true;
-    adc3_data.status.callback_full = false; // clear flag to prevent memory access while DMA working
+    status = &adc1_data.status;
+    buffer = adc1_data.in_buffer;
+    length = sizeof(adc1_data.in_buffer) / sizeof(uint16_t);
+  }
+  else if (hadc == &SPEED_ADC)
+  {
+    status = &adc2_data.status;
+    buffer = adc2_data.in_buffer;
+    length = sizeof(adc2_data.in_buffer) / sizeof(uint16_t);
+  }
+  else if (hadc == &KNOCK_ADC)
+  {
+    status = &adc3_data.status;
+    buffer = adc3_data.in_buffer;
+    length = sizeof(adc3_data.in_buffer) / sizeof(uint16_t);
+  }
+  else
+  {
+    return;
   }
+
+  if (HAL_ADC_GetError(hadc) & HAL_ADC_ERROR_OVR)
+    status->stats.overrun_count++;
+
+  // DMA requests stop after overrun, restart from the beginning of buffer
+  HAL_ADC_Stop_DMA(hadc);
+  HAL_ADC_Start_DMA(hadc, (uint32_t *)buffer, length);
+}
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc != &GENERAL_ADC || adc1_protect_current >= ADC1_PROTECT_ID_MAX) // only ADC1 limits are used
+    return;
+
+  nECU_ADC1_Protect_ID ID = adc1_protect_current;
+  ADC1_Protect_List[ID].flag = true;
+  ADC1_Protect_List[ID].trip_count++;
+
+  nECU_Frame_Protection_Callback(ID); // report over CAN without waiting for averaging and frame timing
+  nECU_ADC1_Protect_Rotate();         // guard remaining limits
+}
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if (hadc != &GENERAL_ADC) // only ADC1 uses injected group
+    return;
+
+  for (uint8_t rank = 0; rank < GENERAL_SYNC_CHANNEL_COUNT; rank++)
+    adc1_sync.sum[rank] += HAL_ADCEx_InjectedGetValue(hadc, ADC_INJECTED_RANK_1 + rank);
+  adc1_sync.samples++;
+
+  if (adc1_sync.samples < GENERAL_SYNC_SAMPLES) // wait for whole event
+    return;
+
+  for (uint8_t rank = 0; rank < GENERAL_SYNC_CHANNEL_COUNT; rank++)
+  {
+    adc1_sync.out_buffer[rank] = adc1_sync.sum[rank] / adc1_sync.samples;
+    adc1_sync.sum[rank] = 0;
+    adc1_sync.newData[rank] = true;
+  }
+  adc1_sync.samples = 0;
+  adc1_sync.event_count++;
+  adc1_sync.event_tick = HAL_GetTick();
 }
 
 /* Start functions */
@@ -94,9 +180,9 @@ bool nECU_ADC1_START(void)
     */
 
     /* Clear status flags */
-    adc1_data.status.callback_half = false;
-    adc1_data.status.callback_full = false;
+    nECU_Scheduler_Event_Flush(EVENT_ADC1_ID);
     adc1_data.status.overflow = false;
+    adc1_data.status.pending = false;
 
     if (!status)
       status |= !nECU_FlowControl_Initialize_Do(D_ADC1);
@@ -104,6 +190,7 @@ bool nECU_ADC1_START(void)
   if (!nECU_FlowControl_Working_Check(D_ADC1) && status == false)
   {
     status |= (HAL_OK != HAL_ADC_Start_DMA(&GENERAL_ADC, (uint32_t *)adc1_data.in_buffer, sizeof(adc1_data.in_buffer) / sizeof(uint16_t)));
+    status |= nECU_ADC1_Protect_Start();
     if (!status)
       status |= !nECU_FlowControl_Working_Do(D_ADC1);
   }
@@ -126,9 +213,9 @@ bool nECU_ADC2_START(void)
     */
 
     /* Clear status flags */
-    adc2_data.status.callback_half = false;
-    adc2_data.status.callback_full = false;
+    nECU_Scheduler_Event_Flush(EVENT_ADC2_ID);
     adc2_data.status.overflow = false;
+    adc2_data.status.pending = false;
 
     if (!status)
       status |= !nECU_FlowControl_Initialize_Do(D_ADC2);
@@ -151,9 +238,9 @@ bool nECU_ADC3_START(void)
   if (!nECU_FlowControl_Initialize_Check(D_ADC3) && status == false)
   {
     /* Clear status flags */
-    adc3_data.status.callback_half = false;
-    adc3_data.status.callback_full = false;
+    nECU_Scheduler_Event_Flush(EVENT_ADC3_ID);
     adc3_data.status.overflow = false;
+    adc3_data.status.pending = false;
     status |= nECU_TIM_Init(TIM_ADC_KNOCK_ID);
     if (!status)
       status |= !nECU_FlowControl_Initialize_Do(D_ADC3);
@@ -176,7 +263,12 @@ bool nECU_ADC1_STOP(void)
   bool status = false;
   if (nECU_FlowControl_Working_Check(D_ADC1) && status == false)
   {
+    adc1_protect_active = false; // stop guarding limits
+    __HAL_ADC_DISABLE_IT(&GENERAL_ADC, ADC_IT_AWD);
+    adc1_protect_current = ADC1_PROTECT_ID_MAX;
     status |= (HAL_OK != HAL_ADC_Stop_DMA(&GENERAL_ADC));
+    if (adc1_scope_active) // leave burst capture configuration
+      nECU_ADC1_Scope_Restore();
     nECU_ADC1_Routine(); // finish routine if flags pending
     if (!status)
       status |= !nECU_FlowControl_Stop_Do(D_ADC1);
@@ -224,18 +316,14 @@ void nECU_ADC1_Routine(void)
     nECU_FlowControl_Error_Do(D_ADC1);
     return; // Break
   }
+  nECU_PROFILE_ENTER(D_ADC1);
 
   /* Conversion Completed callbacks */
-  if (adc1_data.status.callback_half == true)
-  {
-    nECU_ADC_AverageDMA(&GENERAL_ADC, &(adc1_data.in_buffer[0]), GENERAL_DMA_LEN / 2, adc1_data.out_buffer, GENERAL_SMOOTH_ALPHA);
-    adc1_data.status.callback_half = false; // clear flag
-  }
-  else if (adc1_data.status.callback_full == true)
-  {
-    nECU_ADC_AverageDMA(&GENERAL_ADC, &(adc1_data.in_buffer[GENERAL_DMA_LEN / 2]), GENERAL_DMA_LEN / 2, adc1_data.out_buffer, GENERAL_SMOOTH_ALPHA);
-    adc1_data.status.callback_full = false; // clear flag
-  }
+  bool full;
+  if (nECU_ADC_DMA_Take(&adc1_data.status, EVENT_ADC1_ID, &full)) // newest filled half only, the other one is being written by DMA
+    nECU_ADC_AverageDMA(&GENERAL_ADC, &(adc1_data.in_buffer[full ? GENERAL_DMA_LEN / 2 : 0]), GENERAL_DMA_LEN / 2, adc1_data.out_buffer, nECU_Calibration_get()->general_alpha);
+  nECU_ADC1_Protect_Release();
+  nECU_PROFILE_EXIT(D_ADC1);
   nECU_Debug_ProgramBlockData_Update(D_ADC1);
 }
 void nECU_ADC2_Routine(void)
@@ -245,18 +333,13 @@ void nECU_ADC2_Routine(void)
     nECU_FlowControl_Error_Do(D_ADC2);
     return; // Break
   }
+  nECU_PROFILE_ENTER(D_ADC2);
 
   /* Conversion Completed callbacks */
-  if (adc2_data.status.callback_half == true)
-  {
-    nECU_ADC_AverageDMA(&SPEED_ADC, adc2_data.in_buffer, SPEED_DMA_LEN / 2, adc2_data.out_buffer, SPEED_SMOOTH_ALPHA);
-    adc2_data.status.callback_half = false; // clear flag
-  }
-  else if (adc2_data.status.callback_full == true)
-  {
-    nECU_ADC_AverageDMA(&SPEED_ADC, &adc2_data.in_buffer[(SPEED_DMA_LEN / 2) - 1], SPEED_DMA_LEN / 2, adc2_data.out_buffer, SPEED_SMOOTH_ALPHA);
-    adc2_data.status.callback_full = false; // clear flag
-  }
+  bool full;
+  if (nECU_ADC_DMA_Take(&adc2_data.status, EVENT_ADC2_ID, &full)) // newest filled half only, the other one is being written by DMA
+    nECU_ADC_AverageDMA(&SPEED_ADC, &adc2_data.in_buffer[full ? (SPEED_DMA_LEN / 2) - 1 : 0], SPEED_DMA_LEN / 2, adc2_data.out_buffer, nECU_Calibration_get()->speed_alpha);
+  nECU_PROFILE_EXIT(D_ADC2);
   nECU_Debug_ProgramBlockData_Update(D_ADC2);
 }
 void nECU_ADC3_Routine(void)
@@ -266,18 +349,13 @@ void nECU_ADC3_Routine(void)
     nECU_FlowControl_Error_Do(D_ADC3);
     return; // Break
   }
+  nECU_PROFILE_ENTER(D_ADC3);
 
   /* Conversion Completed callbacks */
-  if (adc3_data.status.callback_half == true)
-  {
-    adc3_data.status.callback_half = false; // clear flag
-    nECU_Knock_ADC_Callback(&adc3_data.in_buffer[0]);
-  }
-  else if (adc3_data.status.callback_full == true)
-  {
-    adc3_data.status.callback_full = false; // clear flag
-    nECU_Knock_ADC_Callback(&adc3_data.in_buffer[(KNOCK_DMA_LEN / 2) - 1]);
-  }
+  bool full;
+  if (nECU_ADC_DMA_Take(&adc3_data.status, EVENT_ADC3_ID, &full)) // newest filled half only, the other one is being written by DMA
+    nECU_Knock_ADC_Callback(&adc3_data.in_buffer[full ? (KNOCK_DMA_LEN / 2) - 1 : 0]);
+  nECU_PROFILE_EXIT(D_ADC3);
   nECU_Debug_ProgramBlockData_Update(D_ADC3);
 #if TEST_KNOCK_UART == true
   Send_Triangle_UART();
@@ -299,3 +377,289 @@ uint16_t *nECU_ADC2_getPointer(nECU_ADC2_ID ID)
 
   return &adc2_data.out_buffer[0 + ID];
 }
+
+/* DMA statistics */
+static void nECU_ADC_DMA_Callback(nECU_ADC_Status *status, nECU_Event_ID ID, bool full) // hand filled half to routine and count callbacks
+{
+  if (status->pending) // routine did not take previous half, it is lost
+  {
+    status->overflow = true;
+    status->stats.overflow_count++;
+  }
+  status->full = full;
+  status->timestamp = nECU_CycleCounter_Get();
+  status->pending = true;
+  nECU_Scheduler_Event(ID, full); // release routine, only latest half is kept in status
+
+  if (full)
+    status->stats.full_count++;
+  else
+    status->stats.half_count++;
+
+  nECU_XCP_Event(XCP_EVENT_ADC(ID)); // DAQ lists bound to this conversion
+}
+static bool nECU_ADC_DMA_Take(nECU_ADC_Status *status, nECU_Event_ID ID, bool *full) // take latest filled half and track delay between DMA callback and processing, returns false if there is none
+{
+  nECU_Event event;
+  while (nECU_Scheduler_Event_Get(ID, &event)) // releases only, half is held by status
+    ;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // DMA callback may replace half meanwhile
+  bool pending = status->pending;
+  uint32_t timestamp = status->timestamp;
+  *full = status->full;
+  status->pending = false;
+  __set_PRIMASK(primask);
+  if (!pending)
+    return false;
+
+  uint32_t delay = nECU_CycleCounter_toUs(nECU_CycleCounter_Get() - timestamp);
+  if (delay > status->stats.delay_max)
+    status->stats.delay_max = delay;
+  return true;
+}
+nECU_ADC_Stats *nECU_ADC_Stats_getPointer(nECU_Module_ID ID) // returns pointer to statistics of given ADC (D_ADC1 - D_ADC3)
+{
+  switch (ID)
+  {
+  case D_ADC1:
+    return &(adc1_data.status.stats);
+  case D_ADC2:
+    return &(adc2_data.status.stats);
+  case D_ADC3:
+    return &(adc3_data.status.stats);
+  default:
+    return NULL;
+  }
+}
+void nECU_ADC_Stats_Report(void) // print statistics of all ADCs over UART
+{
+  printf("ADC\thalf\tfull\toverflow\toverrun\tdelay max [us]\n\r");
+  for (nECU_Module_ID ID = D_ADC1; ID <= D_ADC3; ID++)
+  {
+    nECU_ADC_Stats *stats = nECU_ADC_Stats_getPointer(ID);
+    printf("ADC%u\t%lu\t%lu\t%lu\t%lu\t%lu\n\r", (unsigned)(ID - D_ADC1 + 1),
+           (unsigned long)stats->half_count, (unsigned long)stats->full_count,
+           (unsigned long)stats->overflow_count, (unsigned long)stats->overrun_count,
+           (unsigned long)stats->delay_max);
+  }
+}
+
+/* Analog watchdog */
+static uint32_t nECU_ADC_getChannel(ADC_HandleTypeDef *hadc, uint8_t rank) // returns channel number configured at given rank (1-16)
+{
+  if (rank <= 6)
+    return (hadc->Instance->SQR3 >> (5 * (rank - 1))) & 0x1F;
+  if (rank <= 12)
+    return (hadc->Instance->SQR2 >> (5 * (rank - 7))) & 0x1F;
+  return (hadc->Instance->SQR1 >> (5 * (rank - 13))) & 0x1F;
+}
+static bool nECU_ADC1_Protect_Start(void) // configure analog watchdog and guard first limit
+{
+  for (nECU_ADC1_Protect_ID current_ID = 0; current_ID < ADC1_PROTECT_ID_MAX; current_ID++)
+    ADC1_Protect_List[current_ID].flag = false;
+
+  ADC_AnalogWDGConfTypeDef AnalogWDGConfig = {0};
+  AnalogWDGConfig.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
+  AnalogWDGConfig.HighThreshold = ADC_MAX_VALUE_12BIT;
+  AnalogWDGConfig.LowThreshold = 0;
+  AnalogWDGConfig.Channel = nECU_ADC_getChannel(&GENERAL_ADC, 1);
+  AnalogWDGConfig.ITMode = DISABLE;
+  if (HAL_ADC_AnalogWDGConfig(&GENERAL_ADC, &AnalogWDGConfig) != HAL_OK)
+    return true;
+
+  HAL_NVIC_SetPriority(ADC_IRQn, 0, 0); // same as ADC1 DMA, so that both never preempt each other
+  HAL_NVIC_EnableIRQ(ADC_IRQn);
+
+  adc1_protect_current = ADC1_PROTECT_ID_MAX;
+  adc1_protect_active = true;
+  nECU_ADC1_Protect_Rotate();
+  return false;
+}
+static void nECU_ADC1_Protect_Rotate(void) // move analog watchdog to the next limit that is not already active
+{
+  if (!adc1_protect_active) // not configured
+    return;
+
+  uint8_t next = (adc1_protect_current < ADC1_PROTECT_ID_MAX) ? (adc1_protect_current + 1) : 0;
+  for (uint8_t checked = 0; checked < ADC1_PROTECT_ID_MAX; checked++, next++)
+  {
+    next %= ADC1_PROTECT_ID_MAX;
+    if (ADC1_Protect_List[next].flag) // already reported, wait for release
+      continue;
+
+    if (next != adc1_protect_current || !__HAL_ADC_GET_IT_SOURCE(&GENERAL_ADC, ADC_IT_AWD)) // reconfigure only if needed
+    {
+      __HAL_ADC_DISABLE_IT(&GENERAL_ADC, ADC_IT_AWD);
+      GENERAL_ADC.Instance->HTR = ADC1_Protect_List[next].Threshold;
+      MODIFY_REG(GENERAL_ADC.Instance->CR1, ADC_CR1_AWDCH, nECU_ADC_getChannel(&GENERAL_ADC, ADC1_Protect_List[next].Channel + 1));
+      __HAL_ADC_CLEAR_FLAG(&GENERAL_ADC, ADC_FLAG_AWD); // drop result of previous channel
+      adc1_protect_current = next;
+      __HAL_ADC_ENABLE_IT(&GENERAL_ADC, ADC_IT_AWD);
+    }
+    return;
+  }
+
+  // all limits active
+  __HAL_ADC_DISABLE_IT(&GENERAL_ADC, ADC_IT_AWD);
+  adc1_protect_current = ADC1_PROTECT_ID_MAX;
+}
+static void nECU_ADC1_Protect_Release(void) // release latched limits once averaged value is back below hysteresis
+{
+  for (nECU_ADC1_Protect_ID current_ID = 0; current_ID < ADC1_PROTECT_ID_MAX; current_ID++)
+  {
+    nECU_ADC_Protection *limit = &ADC1_Protect_List[current_ID];
+    if (limit->flag && (adc1_data.out_buffer[limit->Channel] + limit->Hysteresis) < limit->Threshold)
+      limit->flag = false; // will be guarded again on next rotation
+  }
+}
+bool nECU_ADC1_Protect_getFlag(nECU_ADC1_Protect_ID ID) // returns state of given limit
+{
+  if (ID >= ADC1_PROTECT_ID_MAX) // Break if invalid ID
+    return false;
+
+  return ADC1_Protect_List[ID].flag;
+}
+
+/* Crank synchronous sampling */
+bool nECU_ADC1_Sync_Start(void) // sample selected channels on every IGF capture
+{
+  bool status = false;
+
+  if (!nECU_FlowControl_Initialize_Check(D_ADC1_Sync))
+  {
+    memset(&adc1_sync, 0, sizeof(adc1_sync));
+
+    ADC_InjectionConfTypeDef sConfigInjected = {0};
+    sConfigInjected.InjectedNbrOfConversion = GENERAL_SYNC_CHANNEL_COUNT;
+    sConfigInjected.InjectedSamplingTime = ADC_SAMPLETIME_480CYCLES;             // shared with regular group, keep it unchanged
+    sConfigInjected.ExternalTrigInjecConv = ADC_EXTERNALTRIGINJECCONV_T4_CC1;    // IGF input capture
+    sConfigInjected.ExternalTrigInjecConvEdge = ADC_EXTERNALTRIGINJECCONVEDGE_RISING;
+    sConfigInjected.AutoInjectedConv = DISABLE;
+    sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+    sConfigInjected.InjectedOffset = 0;
+    for (uint8_t rank = 0; rank < GENERAL_SYNC_CHANNEL_COUNT; rank++)
+    {
+      sConfigInjected.InjectedChannel = nECU_ADC_getChannel(&GENERAL_ADC, ADC1_Sync_Channel_List[rank] + 1); // same input as in regular group
+      sConfigInjected.InjectedRank = ADC_INJECTED_RANK_1 + rank;
+      status |= (HAL_ADCEx_InjectedConfigChannel(&GENERAL_ADC, &sConfigInjected) != HAL_OK);
+    }
+
+    if (!status)
+      status |= !nECU_FlowControl_Initialize_Do(D_ADC1_Sync);
+  }
+  if (!nECU_FlowControl_Working_Check(D_ADC1_Sync) && status == false)
+  {
+    status |= nECU_ADC1_START(); // injected conversions interrupt running regular sequence
+    if (!status)
+    {
+      SET_BIT(GENERAL_ADC.Instance->CR2, ADC_CR2_JEXTEN_0); // trigger on rising edge of capture event (cleared by stop)
+      status |= (HAL_ADCEx_InjectedStart_IT(&GENERAL_ADC) != HAL_OK);
+      HAL_NVIC_SetPriority(ADC_IRQn, 0, 0); // same as ADC1 DMA, so that both never preempt each other
+      HAL_NVIC_EnableIRQ(ADC_IRQn);
+    }
+    if (!status)
+      status |= !nECU_FlowControl_Working_Do(D_ADC1_Sync);
+  }
+  if (status)
+    nECU_FlowControl_Error_Do(D_ADC1_Sync);
+
+  return status;
+}
+bool nECU_ADC1_Sync_Stop(void) // stop sampling on IGF capture, regular conversions continue
+{
+  bool status = false;
+  if (nECU_FlowControl_Working_Check(D_ADC1_Sync) && status == false)
+  {
+    // HAL_ADCEx_InjectedStop_IT() refuses to stop while regular group is running, disable trigger instead
+    CLEAR_BIT(GENERAL_ADC.Instance->CR2, ADC_CR2_JEXTEN);
+    __HAL_ADC_DISABLE_IT(&GENERAL_ADC, ADC_IT_JEOC);
+    adc1_sync.samples = 0;
+    if (!status)
+      status |= !nECU_FlowControl_Stop_Do(D_ADC1_Sync);
+  }
+  if (status)
+    nECU_FlowControl_Error_Do(D_ADC1_Sync);
+
+  return status;
+}
+bool nECU_ADC1_Sync_isFresh(void) // returns true if ignition events are arriving
+{
+  if (!nECU_FlowControl_Working_Check(D_ADC1_Sync) || adc1_sync.event_count == 0)
+    return false;
+
+  return (HAL_GetTick() - adc1_sync.event_tick) < GENERAL_SYNC_TIMEOUT;
+}
+uint16_t *nECU_ADC1_Sync_getPointer(nECU_ADC1_ID ID) // returns pointer to per event result, NULL if not sampled synchronously
+{
+  for (uint8_t rank = 0; rank < GENERAL_SYNC_CHANNEL_COUNT; rank++)
+    if (ADC1_Sync_Channel_List[rank] == ID)
+      return &adc1_sync.out_buffer[rank];
+
+  return NULL;
+}
+bool *nECU_ADC1_Sync_getPointer_newData(nECU_ADC1_ID ID) // returns pointer to new event flag, NULL if not sampled synchronously
+{
+  for (uint8_t rank = 0; rank < GENERAL_SYNC_CHANNEL_COUNT; rank++)
+    if (ADC1_Sync_Channel_List[rank] == ID)
+      return &adc1_sync.newData[rank];
+
+  return NULL;
+}
+
+/* Burst capture (scope mode) */
+bool nECU_ADC1_Scope_Enter(uint16_t *buffer, uint32_t length) // switch GENERAL_ADC to fast scan of scope channels into given circular buffer
+{
+  if (!nECU_FlowControl_Working_Check(D_ADC1) || adc1_scope_active)
+    return true;
+
+  if (HAL_ADC_Stop_DMA(&GENERAL_ADC) != HAL_OK)
+    return true;
+
+  nECU_Scheduler_Event_Flush(EVENT_ADC1_ID); // halves filled so far are overwritten by burst
+  adc1_data.status.pending = false;
+
+  adc1_scope_SQR1 = GENERAL_ADC.Instance->SQR1;
+  adc1_scope_SMPR2 = GENERAL_ADC.Instance->SMPR2;
+
+  // scope channels already are first ranks, shorten sequence and sampling time only
+  MODIFY_REG(GENERAL_ADC.Instance->SQR1, ADC_SQR1_L, ADC_SQR1(SCOPE_CHANNEL_COUNT));
+  for (uint8_t rank = 1; rank <= SCOPE_CHANNEL_COUNT; rank++)
+  {
+    uint32_t channel = nECU_ADC_getChannel(&GENERAL_ADC, rank); // channels 0-9 are configured in SMPR2
+    MODIFY_REG(GENERAL_ADC.Instance->SMPR2, ADC_SMPR2(ADC_SMPR2_SMP0, channel), ADC_SMPR2(SCOPE_SAMPLETIME, channel));
+  }
+
+  adc1_scope_active = true;
+  if (HAL_ADC_Start_DMA(&GENERAL_ADC, (uint32_t *)buffer, length) != HAL_OK)
+  {
+    nECU_ADC1_Scope_Exit();
+    return true;
+  }
+  return false;
+}
+void nECU_ADC1_Scope_Halt(void) // stop conversions, keeps content of burst buffer (can be called from interrupt)
+{
+  if (!adc1_scope_active)
+    return;
+
+  HAL_ADC_Stop_DMA(&GENERAL_ADC);
+}
+bool nECU_ADC1_Scope_Exit(void) // restore normal scan and restart conversions
+{
+  if (!adc1_scope_active)
+    return true;
+
+  bool status = false;
+  status |= (HAL_OK != HAL_ADC_Stop_DMA(&GENERAL_ADC));
+  nECU_ADC1_Scope_Restore();
+  status |= (HAL_OK != HAL_ADC_Start_DMA(&GENERAL_ADC, (uint32_t *)adc1_data.in_buffer, sizeof(adc1_data.in_buffer) / sizeof(uint16_t)));
+  return status;
+}
+static void nECU_ADC1_Scope_Restore(void) // write back normal scan configuration, conversions have to be stopped
+{
+  GENERAL_ADC.Instance->SQR1 = adc1_scope_SQR1;
+  GENERAL_ADC.Instance->SMPR2 = adc1_scope_SMPR2;
+  adc1_scope_active = false;
+}
@@ -0,0 +1,318 @@
+/**
+ ******************************************************************************
+ * @file    nECU_boot.c
+ * @brief   This file provides code for dependency driven start and stop of
+ *          modules. Modules are brought up in dependency order, slow devices
+ *          are waited for only by modules that depend on them.
+ ******************************************************************************
+ */
+
+#include "nECU_boot.h"
+
+static nECU_Module_Config const Module_Config_List[D_ID_MAX] = {
+    // shared resources, started by modules using them
+    [D_ANALOG_MAP] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_BackPressure] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_OX] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_AI_1] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_AI_2] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_AI_3] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_MCUTemp] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_VREF] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ADC1_Sync] = {BOOT_DEPENDS(D_ADC1)},
+    [D_ANALOG_SS1] = {BOOT_DEPENDS(D_ADC2, D_Flash)}, // calibration is kept in flash
+    [D_ANALOG_SS2] = {BOOT_DEPENDS(D_ADC2, D_Flash)},
+    [D_ANALOG_SS3] = {BOOT_DEPENDS(D_ADC2, D_Flash)},
+    [D_ANALOG_SS4] = {BOOT_DEPENDS(D_ADC2, D_Flash)},
+    [D_Debug_Que] = {BOOT_DEPENDS(D_Flash)},
+
+    // modules started from boot sequence
+    [D_Flash] = {nECU_FLASH_Start, NULL},
+    [D_OnboardLED] = {OnBoard_LED_Start, NULL},
+    [D_PC] = {nECU_PC_Start, NULL, NULL, BOOT_DEPENDS(D_OnboardLED)},
+    [D_Scope] = {nECU_Scope_Start, NULL, NULL, BOOT_DEPENDS(D_PC)},
+    [D_Log] = {nECU_Log_Start, nECU_Log_Stop, NULL, BOOT_DEPENDS(D_PC)}, // shares UART with PC
+    [D_Menu] = {nECU_Menu_Start, NULL, NULL, BOOT_DEPENDS(D_Flash)},
+    [D_Tacho] = {nECU_Tacho_Start, NULL, NULL, BOOT_DEPENDS(D_Menu)},
+    [D_EGT1] = {nECU_EGT_Start, NULL, nECU_EGT_isReady}, // starts all sensors
+    [D_Knock] = {nECU_Knock_Start, nECU_Knock_Stop},
+    [D_CAN_TX] = {nECU_CAN_Start, nECU_CAN_Stop},
+    [D_Frame_Speed_ID] = {Frame0_Start, Frame0_Stop, NULL, BOOT_DEPENDS(D_CAN_TX, D_Menu, D_Tacho)},
+    [D_Frame_EGT_ID] = {Frame1_Start, Frame1_Stop, NULL, BOOT_DEPENDS(D_CAN_TX, D_Menu, D_Tacho, D_EGT1)},
+    [D_Frame_Stock_ID] = {Frame2_Start, Frame2_Stop, NULL, BOOT_DEPENDS(D_CAN_TX, D_Knock)},
+    [D_Frame_Diag_ID] = {Frame3_Start, Frame3_Stop, NULL, BOOT_DEPENDS(D_CAN_TX)},
+    [D_ISOTP] = {nECU_ISOTP_Start, nECU_ISOTP_Stop, NULL, BOOT_DEPENDS(D_CAN_TX)},
+    [D_XCP] = {nECU_XCP_Start, nECU_XCP_Stop, NULL, BOOT_DEPENDS(D_CAN_TX)},
+    [D_Main] = {NULL, NULL, NULL, BOOT_DEPENDS(D_Frame_Speed_ID, D_Frame_EGT_ID, D_Frame_Stock_ID, D_Frame_Diag_ID, D_ISOTP, D_XCP, D_PC, D_Scope, D_Log, D_OnboardLED)},
+    [D_Scheduler] = {nECU_Scheduler_Start, nECU_Scheduler_Stop, NULL, BOOT_DEPENDS(D_Main)},
+    [D_Watchdog] = {nECU_Watchdog_Start, nECU_Watchdog_Stop, NULL, BOOT_DEPENDS(D_Scheduler)},
+}; // List of dependencies and control functions of each module
+
+static nECU_Module_ID Boot_Order[D_ID_MAX];               // modules sorted so that every dependency comes before its dependents
+static bool Boot_Sorted = false;                           // 'Boot_Order' is valid
+static nECU_Boot_Record Boot_Record_List[D_ID_MAX] = {0}; // bring up progress and times
+
+/* General functions */
+bool nECU_Boot_Start(nECU_Module_ID target) // start target and its dependencies in dependency order
+{
+    if (target >= D_ID_MAX || nECU_Boot_Sort()) // Break if invalid ID or dependencies can not be ordered
+        return true;
+
+    bool required[D_ID_MAX] = {false};
+    nECU_Boot_Require(target, required);
+    for (nECU_Module_ID ID = 0; ID < D_ID_MAX; ID++) // forget previous run of modules that are down
+    {
+        if (required[ID] && !nECU_FlowControl_Working_Check(ID))
+            Boot_Record_List[ID].state = BOOT_STATE_IDLE;
+    }
+
+    bool status = false, pending = true;
+    uint32_t begin = HAL_GetTick();
+    while (pending) // each pass starts everything whose dependencies are ready, slow devices do not block others
+    {
+        pending = false;
+        for (uint8_t index = 0; index < D_ID_MAX; index++)
+        {
+            nECU_Module_ID ID = Boot_Order[index];
+            nECU_Boot_Record *record = &Boot_Record_List[ID];
+            if (!required[ID] || Module_Config_List[ID].Start == NULL) // started by its owner
+                continue;
+            if (record->state == BOOT_STATE_READY || record->state == BOOT_STATE_FAILED)
+                continue;
+
+            if (nECU_Boot_Dependencies_Failed(ID)) // do not start on top of broken module
+            {
+                record->state = BOOT_STATE_FAILED;
+                status |= true;
+                continue;
+            }
+            if (record->state == BOOT_STATE_IDLE && !nECU_Boot_isReady(ID) && nECU_Boot_Dependencies_Ready(ID))
+            {
+                uint32_t cycles = nECU_CycleCounter_Get();
+                bool failed = Module_Config_List[ID].Start();
+                record->start_time = nECU_CycleCounter_toUs(nECU_CycleCounter_Get() - cycles);
+                record->state = (failed) ? BOOT_STATE_FAILED : BOOT_STATE_STARTED;
+                status |= failed;
+            }
+            if (record->state != BOOT_STATE_FAILED && nECU_Boot_isReady(ID)) // dependents later in order can go in this pass
+            {
+                record->state = BOOT_STATE_READY;
+                record->ready_tick = HAL_GetTick();
+            }
+            else if (record->state != BOOT_STATE_FAILED)
+                pending = true;
+        }
+
+        if (pending && (HAL_GetTick() - begin) > BOOT_TIMEOUT) // device did not come up
+        {
+            status |= true;
+            break;
+        }
+    }
+
+    return status;
+}
+bool nECU_Boot_Stop(nECU_Module_ID target) // stop modules that depend on target, dependents first, then target itself
+{
+    if (target >= D_ID_MAX || nECU_Boot_Sort()) // Break if invalid ID or dependencies can not be ordered
+        return true;
+
+    bool affected[D_ID_MAX] = {false};
+    affected[target] = true;
+    for (uint8_t index = 0; index < D_ID_MAX; index++) // dependencies come first, so single pass marks all dependents
+    {
+        nECU_Module_ID ID = Boot_Order[index];
+        for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+            affected[ID] |= affected[Module_Config_List[ID].depends[dep]];
+    }
+
+    bool status = false;
+    for (uint8_t index = D_ID_MAX; index > 0; index--) // reverse start order
+    {
+        nECU_Module_ID ID = Boot_Order[index - 1];
+        if (affected[ID] && Module_Config_List[ID].Stop != NULL && nECU_FlowControl_Working_Check(ID))
+            status |= Module_Config_List[ID].Stop();
+    }
+
+    return status;
+}
+bool nECU_Boot_Release(nECU_Module_ID target) // stop dependencies of target that are no longer required, in reverse start order
+{
+    if (target >= D_ID_MAX || nECU_Boot_Sort()) // Break if invalid ID or dependencies can not be ordered
+        return true;
+
+    bool required[D_ID_MAX] = {false};
+    nECU_Boot_Require(target, required);
+
+    bool status = false;
+    for (uint8_t index = D_ID_MAX; index > 0; index--) // dependents are stopped before modules they use
+    {
+        nECU_Module_ID ID = Boot_Order[index - 1];
+        if (ID == target || !required[ID] || Module_Config_List[ID].Stop == NULL)
+            continue;
+        if (nECU_FlowControl_Working_Check(ID) && !nECU_Boot_isRequired(ID))
+            status |= Module_Config_List[ID].Stop();
+    }
+
+    return status;
+}
+bool nECU_Boot_isRequired(nECU_Module_ID ID) // returns true if any working module depends on given one
+{
+    if (ID >= D_ID_MAX) // Break if invalid ID
+        return false;
+
+    for (nECU_Module_ID dependent = 0; dependent < D_ID_MAX; dependent++)
+    {
+        if (nECU_FlowControl_Working_Check(dependent) && nECU_Boot_Depends(dependent, ID))
+            return true;
+    }
+    return false;
+}
+nECU_Boot_Record *nECU_Boot_getRecord(nECU_Module_ID ID) // returns bring up record of given module
+{
+    if (ID >= D_ID_MAX) // Break if invalid ID
+        return NULL;
+
+    return &Boot_Record_List[ID];
+}
+void nECU_Boot_Report(void) // print bring up times over UART
+{
+    if (nECU_Boot_Sort())
+    {
+        printf("Module dependencies contain a cycle\n\r");
+        return;
+    }
+
+    printf("Module                          start [us]  ready [ms]\n\r");
+    for (uint8_t index = 0; index < D_ID_MAX; index++)
+    {
+        nECU_Module_ID ID = Boot_Order[index];
+        nECU_Boot_Record *record = &Boot_Record_List[ID];
+        if (record->state == BOOT_STATE_IDLE)
+            continue;
+
+        printf("%-32s %10lu  %10lu", nECU_FlowControl_getName(ID), (unsigned long)record->start_time, (unsigned long)record->ready_tick);
+        if (record->state == BOOT_STATE_STARTED)
+            printf("  not ready");
+        else if (record->state == BOOT_STATE_FAILED)
+            printf("  failed");
+        printf("\n\r");
+    }
+}
+
+/* Dependency graph */
+static bool nECU_Boot_Sort(void) // build dependency order, returns true on dependency cycle
+{
+    if (Boot_Sorted)
+        return false;
+
+    uint8_t mark[D_ID_MAX] = {0};
+    uint8_t count = 0;
+    for (nECU_Module_ID ID = 0; ID < D_ID_MAX; ID++)
+    {
+        if (nECU_Boot_Visit(ID, mark, &count))
+            return true;
+    }
+
+    Boot_Sorted = true;
+    return false;
+}
+static bool nECU_Boot_Visit(nECU_Module_ID ID, uint8_t *mark, uint8_t *count) // depth first walk of dependencies
+{
+    if (ID >= D_ID_MAX) // invalid dependency
+        return true;
+    if (mark[ID] == 2) // already placed
+        return false;
+    if (mark[ID] == 1) // reached again while walking its own dependencies
+        return true;
+
+    mark[ID] = 1;
+    for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+    {
+        if (nECU_Boot_Visit(Module_Config_List[ID].depends[dep], mark, count))
+            return true;
+    }
+    mark[ID] = 2;
+    Boot_Order[(*count)++] = ID;
+
+    return false;
+}
+static void nECU_Boot_Require(nECU_Module_ID ID, bool *required) // mark module and all its dependencies
+{
+    if (ID >= D_ID_MAX || required[ID]) // Break if invalid ID or already marked
+        return;
+
+    required[ID] = true;
+    for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+        nECU_Boot_Require(Module_Config_List[ID].depends[dep], required);
+}
+static bool nECU_Boot_isReady(nECU_Module_ID ID) // returns true when module can be used by its dependents
+{
+    if (Module_Config_List[ID].Start == NULL) // module started by its owner
+        return nECU_FlowControl_Initialize_Check(ID);
+    if (!nECU_FlowControl_Working_Check(ID))
+        return false;
+
+    return (Module_Config_List[ID].Ready == NULL) ? true : Module_Config_List[ID].Ready();
+}
+static bool nECU_Boot_Dependencies_Failed(nECU_Module_ID ID) // returns true if any dependency failed to start
+{
+    for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+    {
+        if (Boot_Record_List[Module_Config_List[ID].depends[dep]].state == BOOT_STATE_FAILED)
+            return true;
+    }
+    return false;
+}
+static bool nECU_Boot_Dependencies_Ready(nECU_Module_ID ID) // returns true if all dependencies are ready
+{
+    for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+    {
+        if (!nECU_Boot_isReady(Module_Config_List[ID].depends[dep]))
+            return false;
+    }
+    return true;
+}
+static bool nECU_Boot_Depends(nECU_Module_ID ID, nECU_Module_ID dependency) // returns true if ID directly depends on dependency
+{
+    for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+    {
+        if (Module_Config_List[ID].depends[dep] == dependency)
+            return true;
+    }
+    return false;
+}
+
+/* Test */
+bool nECU_Boot_test(bool logging_enable) // Run test
+{
+    if (logging_enable)
+        printf("Started test of nECU_boot.c\n\r");
+
+    if (nECU_Boot_Sort())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Boot_Sort(), dependency cycle\n\r");
+        return false;
+    }
+
+    uint8_t position[D_ID_MAX] = {0};
+    for (uint8_t index = 0; index < D_ID_MAX; index++)
+        position[Boot_Order[index]] = index;
+    for (nECU_Module_ID ID = 0; ID < D_ID_MAX; ID++) // every dependency has to be started first
+    {
+        for (uint8_t dep = 0; dep < Module_Config_List[ID].depends_count; dep++)
+        {
+            if (position[Module_Config_List[ID].depends[dep]] >= position[ID])
+            {
+                if (logging_enable)
+                    printf("\n\rFAIL on order of %s\n\r", nECU_FlowControl_getName(ID));
+                return false;
+            }
+        }
+    }
+
+    if (logging_enable)
+        printf("OK\n\r");
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file    nECU_calibration.c
+ * @brief   This file provides code for calibration pages.
+ *          Reference page lives in flash, ECU runs from its RAM copy which
+ *          can be changed live over XCP.
+ ******************************************************************************
+ */
+
+#include "nECU_calibration.h"
+
+static nECU_Calibration const Calibration_Flash = CALIBRATION_DEFAULTS; // reference page, placed in flash
+static nECU_Calibration Calibration_RAM = CALIBRATION_DEFAULTS;         // working page
+static nECU_Calibration const *const Calibration_Page_List[CALIBRATION_PAGE_MAX] = {
+    [CALIBRATION_PAGE_RAM] = &Calibration_RAM,
+    [CALIBRATION_PAGE_FLASH] = &Calibration_Flash,
+};
+static nECU_Calibration_Page Calibration_ECU_Page = CALIBRATION_PAGE_RAM; // page used by code
+static nECU_Calibration_Page Calibration_XCP_Page = CALIBRATION_PAGE_RAM; // page accessed by calibration tool
+static volatile uint32_t Calibration_Revision = 0;
+
+nECU_Calibration const *nECU_Calibration_get(void) // returns page used by ECU
+{
+    return Calibration_Page_List[Calibration_ECU_Page];
+}
+uint32_t nECU_Calibration_getRevision(void) // returns number incremented on every change of page used by ECU
+{
+    return Calibration_Revision;
+}
+bool nECU_Calibration_setPage(nECU_Calibration_Page page, bool ecu, bool xcp) // select page for ECU and/or XCP access, returns true if page is invalid
+{
+    if (page >= CALIBRATION_PAGE_MAX)
+        return true;
+
+    if (ecu && Calibration_ECU_Page != page)
+    {
+        Calibration_ECU_Page = page;
+        Calibration_Revision++;
+    }
+    if (xcp)
+        Calibration_XCP_Page = page;
+    return false;
+}
+nECU_Calibration_Page nECU_Calibration_getPage(bool xcp) // returns page selected for ECU or XCP access
+{
+    return xcp ? Calibration_XCP_Page : Calibration_ECU_Page;
+}
+bool nECU_Calibration_isInside(uint32_t address, uint8_t size) // returns true if range lies in calibration page
+{
+    uint32_t start = (uint32_t)&Calibration_RAM;
+    return address >= start && (address - start) + size <= sizeof(Calibration_RAM);
+}
+void nECU_Calibration_Read(uint32_t address, uint8_t *data, uint8_t size) // copy memory, ranges inside calibration are read from page selected for XCP
+{
+    if (nECU_Calibration_isInside(address, size)) // tool addresses working page, overlay maps it to selected one
+        address = (uint32_t)Calibration_Page_List[Calibration_XCP_Page] + (address - (uint32_t)&Calibration_RAM);
+    memcpy(data, (uint8_t const *)address, size);
+}
+bool nECU_Calibration_Write(uint32_t address, uint8_t const *data, uint8_t size) // write to working page, returns true if range is outside of it or reference page is selected
+{
+    if (!nECU_Calibration_isInside(address, size) || Calibration_XCP_Page != CALIBRATION_PAGE_RAM)
+        return true;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // multi byte values are taken over as a whole
+    memcpy((uint8_t *)address, data, size);
+    Calibration_Revision++;
+    __set_PRIMASK(primask);
+    return false;
+}
+void nECU_Calibration_Reset(void) // copy reference page to working page
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Calibration_RAM = Calibration_Flash;
+    Calibration_Revision++;
+    __set_PRIMASK(primask);
+}
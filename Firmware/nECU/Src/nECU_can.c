@@ -8,6 +8,8 @@
 
 #include "nECU_can.h"
 #include "nECU_tests.h"
+#include "nECU_isotp.h"
+#include "nECU_xcp.h"
 
 // TX Data
 static nECU_CAN_Tx_Data Tx_frame_List[CAN_TX_ID_MAX] = {0};
@@ -15,12 +17,17 @@ static uint32_t const TX_delay_List[CAN_TX_ID_MAX] = {
     [CAN_TX_Speed_ID] = 100,
     [CAN_TX_EGT_ID] = 100,
     [CAN_TX_Stock_ID] = 10,
+    [CAN_TX_Diag_ID] = 100,
 };
 static uint32_t const TX_Msg_ID_List[CAN_TX_ID_MAX] = {
-    [CAN_TX_Speed_ID] = 0x500,
-    [CAN_TX_EGT_ID] = 0x501,
-    [CAN_TX_Stock_ID] = 0x502,
+    [CAN_TX_Speed_ID] = CAN_MSG_SPEED_ID,
+    [CAN_TX_EGT_ID] = CAN_MSG_EGT_ID,
+    [CAN_TX_Stock_ID] = CAN_MSG_STOCK_ID,
+    [CAN_TX_Diag_ID] = 0x503,
 };
+static nECU_CAN_TX_Queue TX_Queue = {0};           // frames waiting for free mailbox, refilled from mailbox interrupt
+static nECU_CAN_TX_Entry TX_Mailbox_List[3] = {0}; // copy of frame loaded into each mailbox, queued again if its transmission fails
+static nECU_CAN_Health CAN_Health = {0};           // error counters, bus load and TX latency of 'hcan1'
 
 // RX Data
 static nECU_CAN_Rx_Data Rx_frame_List[CAN_RX_ID_MAX] = {0};
@@ -28,7 +35,25 @@ static uint32_t const RX_Msg_ID_List[CAN_RX_ID_MAX] = {
     [CAN_RX_Wheel_ID] = 0x510,
     [CAN_RX_Coolant_ID] = 0x511,
     [CAN_RX_RPM_ID] = 0x512,
+    [CAN_RX_ISOTP_ID] = ISOTP_RX_ID,
+    [CAN_RX_XCP_ID] = XCP_CRO_ID,
 };
+static uint32_t const RX_Timeout_List[CAN_RX_ID_MAX] = {
+    [CAN_RX_Wheel_ID] = 250,
+    [CAN_RX_Coolant_ID] = 1000,
+    [CAN_RX_RPM_ID] = 250,
+    [CAN_RX_ISOTP_ID] = ISOTP_TIMEOUT,
+    [CAN_RX_XCP_ID] = XCP_TIMEOUT,
+}; // maximal age of data before it is considered stale [ms]
+static nECU_CAN_RX_Handler const RX_Handler_List[CAN_RX_ID_MAX] = {
+    [CAN_RX_Wheel_ID] = nECU_CAN_RX_Update,
+    [CAN_RX_Coolant_ID] = nECU_CAN_RX_Update,
+    [CAN_RX_RPM_ID] = nECU_CAN_RX_Update,
+    [CAN_RX_ISOTP_ID] = nECU_ISOTP_RX_Handler,
+    [CAN_RX_XCP_ID] = nECU_XCP_RX_Handler,
+};
+static uint8_t RX_FMI_List[CAN_RX_FILTER_BANK_MAX * CAN_RX_FILTER_SLOTS]; // filter match index to 'nECU_CAN_RX_Frame_ID', filled by filter allocation
+_Static_assert(CAN_RX_ID_MAX <= (CAN_RX_FILTER_BANK_MAX * CAN_RX_FILTER_SLOTS), "too many CAN RX IDs for filter banks of CAN1");
 
 // General functions
 bool nECU_CAN_Start(void) // start periodic transmission of data accroding to the timers
@@ -39,13 +64,14 @@ bool nECU_CAN_Start(void) // start periodic transmission of data accroding to th
   {
     for (nECU_CAN_TX_Frame_ID currentID = 0; currentID < CAN_TX_ID_MAX; currentID++)
       status_TX |= nECU_CAN_TX_Init(currentID);
+    nECU_CAN_Health_Init();
+    status_TX |= nECU_TIM_Init(TIM_CAN_TX_ID);
     if (!status_TX)
       status_TX |= !nECU_FlowControl_Initialize_Do(D_CAN_TX);
   }
   if (!nECU_FlowControl_Initialize_Check(D_CAN_RX) && status_RX == false)
   {
-    for (nECU_CAN_RX_Frame_ID currentID = 0; currentID < CAN_RX_ID_MAX; currentID++)
-      status_RX |= nECU_CAN_RX_Init(currentID);
+    status_RX |= nECU_CAN_RX_Init();
     if (!status_RX)
       status_RX |= !nECU_FlowControl_Initialize_Do(D_CAN_RX);
   }
@@ -58,6 +84,9 @@ bool nECU_CAN_Start(void) // start periodic transmission of data accroding to th
     if (!status_TX)
     {
       status_TX |= !nECU_FlowControl_Working_Do(D_CAN_TX);
+      status_TX |= (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK); // Initialize CAN Bus Tx Interrupt (queue refill)
+      status_TX |= (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_ERROR_WARNING | CAN_IT_ERROR_PASSIVE | CAN_IT_BUSOFF | CAN_IT_LAST_ERROR_CODE | CAN_IT_ERROR) != HAL_OK); // bus health
+      status_TX |= nECU_TIM_Base_Start(TIM_CAN_TX_ID); // release of periodic frames
     }
   }
   if (status_TX)
@@ -72,7 +101,7 @@ bool nECU_CAN_Start(void) // start periodic transmission of data accroding to th
     if (!status_RX)
     {
       status_RX |= !nECU_FlowControl_Working_Do(D_CAN_RX);
-      status_RX |= (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK); // Initialize CAN Bus Rx Interrupt
+      status_RX |= (HAL_CAN_ActivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_RX_FIFO0_OVERRUN) != HAL_OK); // Initialize CAN Bus Rx Interrupt
     }
   }
   if (status_RX)
@@ -82,35 +111,21 @@ bool nECU_CAN_Start(void) // start periodic transmission of data accroding to th
 
   return status_TX | status_RX;
 }
-void nECU_CAN_WriteToBuffer(nECU_CAN_TX_Frame_ID frameID, uint8_t size) // copy input data to corresponding frame buffer
-{
-  if (!nECU_FlowControl_Working_Check(D_CAN_TX) || (frameID >= CAN_TX_ID_MAX) || size == 0)
-  {
-    nECU_FlowControl_Error_Do(D_CAN_TX);
-    return;
-  }
-
-  if (size > 8) // cap max length
-    size = 8;
-
-  Tx_frame_List[frameID].can_data.Header.DLC = size;
-  memcpy(Tx_frame_List[frameID].can_data.Buffer,
-         Tx_frame_List[frameID].buf.Buffer,
-         Tx_frame_List[frameID].can_data.Header.DLC); // copy data to can buffer
-}
 bool nECU_CAN_Stop(void) // stop all CAN code, with timing
 {
   bool status = false;
   if (nECU_FlowControl_Working_Check(D_CAN_TX) && status == false)
   {
-    for (nECU_CAN_TX_Frame_ID currenID = 0; currenID < CAN_TX_ID_MAX; currenID++)
-      status |= nECU_Delay_Stop(&(Tx_frame_List[currenID].frame_delay));
+    status |= nECU_TIM_Base_Stop(TIM_CAN_TX_ID); // Stop releasing periodic frames
+    status |= (HAL_OK != HAL_CAN_DeactivateNotification(&hcan1, CAN_IT_TX_MAILBOX_EMPTY)); // Stop refilling mailboxes
+    status |= (HAL_OK != HAL_CAN_DeactivateNotification(&hcan1, CAN_IT_ERROR_WARNING | CAN_IT_ERROR_PASSIVE | CAN_IT_BUSOFF | CAN_IT_LAST_ERROR_CODE | CAN_IT_ERROR));
+    nECU_CAN_TX_Queue_Flush(&TX_Queue);
     if (!status)
       status |= nECU_FlowControl_Stop_Do(D_CAN_TX);
   }
   if (nECU_FlowControl_Working_Check(D_CAN_RX) && status == false)
   {
-    status |= (HAL_OK != HAL_CAN_DeactivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING)); // Stop waiting for RX
+    status |= (HAL_OK != HAL_CAN_DeactivateNotification(&hcan1, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_RX_FIFO0_OVERRUN)); // Stop waiting for RX
     if (!status)
       status |= !nECU_FlowControl_Stop_Do(D_CAN_RX);
   }
@@ -121,7 +136,7 @@ bool nECU_CAN_Stop(void) // stop all CAN code, with timing
 }
 
 // TX functions
-void nECU_CAN_TX_CheckTime(void) // checks if it is time to send packet
+void nECU_CAN_TX_CheckTime(void) // handle frames released by TX timer
 {
   if (!nECU_FlowControl_Working_Check(D_CAN_TX))
   {
@@ -130,20 +145,20 @@ void nECU_CAN_TX_CheckTime(void) // checks if it is time to send packet
   }
   for (nECU_CAN_TX_Frame_ID currentID = 0; currentID < CAN_TX_ID_MAX; currentID++)
   {
-    if (nECU_FlowControl_Working_Check(D_Frame_Speed_ID + currentID)) // check if frame working
-    {
-      nECU_Delay_Update(&(Tx_frame_List[currentID].frame_delay)); // update time
-      if (Tx_frame_List[currentID].frame_delay.done)              // check if time is above threshold
-      {
-        nECU_Delay_Start(&(Tx_frame_List[currentID].frame_delay)); // restart delay
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // flags are set by TX timer interrupt
+    bool released = Tx_frame_List[currentID].released, failed = Tx_frame_List[currentID].failed;
+    Tx_frame_List[currentID].released = false;
+    Tx_frame_List[currentID].failed = false;
+    __set_PRIMASK(primask);
 
-        if (nECU_CAN_TX_TransmitFrame(currentID))
-          nECU_FlowControl_Error_Do(D_Frame_Speed_ID + currentID);
-        else
-          nECU_Frame_TX_done(currentID);
-      }
-    }
+    if (failed)
+      nECU_FlowControl_Error_Do(D_Frame_Speed_ID + currentID);
+    if (released) // frame state is advanced here, so that it does not change under composition
+      nECU_Frame_TX_done(currentID);
   }
+  nECU_ISOTP_Routine(); // frames held back by separation time
+  nECU_CAN_Health_Routine();
 
   nECU_Debug_ProgramBlockData_Update(D_CAN_TX);
 }
@@ -153,19 +168,18 @@ static bool nECU_CAN_TX_Init(nECU_CAN_TX_Frame_ID currentID)
     return true;                  // Break
 
   bool status = false;
-  // delay
-  status |= nECU_Delay_Set(&(Tx_frame_List[currentID].frame_delay), TX_delay_List[currentID]);
-  status |= nECU_Delay_Start(&(Tx_frame_List[currentID].frame_delay));
+  // timing
+  Tx_frame_List[currentID].countdown = 1 + currentID; // frames with equal period are released in different ticks
+  Tx_frame_List[currentID].released = false;
+  Tx_frame_List[currentID].failed = false;
+  Tx_frame_List[currentID].tx_count = 0;
+  Tx_frame_List[currentID].jitter_last = 0;
+  Tx_frame_List[currentID].jitter_max = 0;
   // default values
   Tx_frame_List[currentID].can_data.Header.StdId = TX_Msg_ID_List[currentID];
   Tx_frame_List[currentID].can_data.Header.IDE = CAN_ID_STD;
   Tx_frame_List[currentID].can_data.Header.RTR = CAN_RTR_DATA;
-  memset(Tx_frame_List[currentID].can_data.Buffer, 0, sizeof(Tx_frame_List[currentID].can_data.Buffer)); // clear buffer
-  // data pointer
-  if (nECU_Frame_getPointer(currentID))
-    Tx_frame_List[currentID].buf.Buffer = nECU_Frame_getPointer(currentID);
-  else
-    status |= true;
+  memset(Tx_frame_List[currentID].can_data.Buffer, 0, sizeof(Tx_frame_List[currentID].can_data.Buffer)); // clear buffer, frames are composed into it when released
 
   return status;
 }
@@ -179,40 +193,285 @@ static bool nECU_CAN_TX_TransmitFrame(nECU_CAN_TX_Frame_ID frameID) // send sele
     return status;
   }
 
-  uint32_t mail = nECU_CAN_TX_FindMailbox(&hcan1);
-  status |= (HAL_CAN_AddTxMessage(&hcan1, &(Tx_frame_List[frameID].can_data.Header), Tx_frame_List[frameID].can_data.Buffer, &(mail)) != HAL_OK); // Transmit the data
+  nECU_CAN_TxFrame *frame = &(Tx_frame_List[frameID].can_data);
+  frame->Header.DLC = nECU_Frame_Compose(frameID, frame->Buffer); // latest data, packed straight into TX buffer
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // queue is shared with urgent transmission and mailbox interrupt
+  status |= nECU_CAN_TX_Queue_Push(&TX_Queue, frame, HAL_GetTick() + TX_delay_List[frameID], true); // newer data replaces queued copy
+  nECU_CAN_TX_Queue_Load(&hcan1, &TX_Queue);
+  __set_PRIMASK(primask);
 
   return status;
 }
-static uint32_t nECU_CAN_TX_FindMailbox(CAN_HandleTypeDef *hcan) // will find empty mailbox
+void nECU_CAN_TX_Timer_Callback(void) // release frames whose period elapsed, queue pre-composed payloads (called from interrupt)
 {
-  if (HAL_CAN_GetTxMailboxesFreeLevel(hcan))                                                     // check if any mailbox is empty
-    for (uint32_t Mailbox = CAN_TX_MAILBOX0; Mailbox <= CAN_TX_MAILBOX2; Mailbox = Mailbox << 1) // go threw all mailboxes
-      if (!HAL_CAN_IsTxMessagePending(&hcan1, Mailbox))                                          // check mailbox if empty
-        return Mailbox;
+  if (!nECU_FlowControl_Working_Check(D_CAN_TX))
+    return;
+
+  for (nECU_CAN_TX_Frame_ID currentID = 0; currentID < CAN_TX_ID_MAX; currentID++)
+  {
+    nECU_CAN_Tx_Data *frame = &(Tx_frame_List[currentID]);
+    if (!nECU_FlowControl_Working_Check(D_Frame_Speed_ID + currentID)) // check if frame working
+      continue;
+    if (--frame->countdown)
+      continue;
 
-  return 8; // return non-valid mailbox
+    frame->countdown = TX_delay_List[currentID];
+    if (nECU_CAN_TX_TransmitFrame(currentID))
+      frame->failed = true;
+    else
+      frame->released = true;
+  }
 }
+static nECU_CAN_TX_Frame_ID nECU_CAN_TX_Identify(uint32_t StdId) // returns periodic frame ID of given CAN ID, CAN_TX_ID_MAX for others
+{
+  for (nECU_CAN_TX_Frame_ID currentID = 0; currentID < CAN_TX_ID_MAX; currentID++)
+    if (TX_Msg_ID_List[currentID] == StdId)
+      return currentID;
+  return CAN_TX_ID_MAX;
+}
+bool nECU_CAN_TX_TransmitUrgent(nECU_CAN_TX_Frame_ID frameID, uint8_t index, uint8_t bits) // send copy of the frame with given bits set, out of schedule (called from interrupt)
+{
+  if (!nECU_FlowControl_Working_Check(D_CAN_TX) || (frameID >= CAN_TX_ID_MAX) || index >= 8) // Break if invalid ID
+    return true;
 
-// RX functions
-static bool nECU_CAN_RX_Init(nECU_CAN_RX_Frame_ID currentID)
+  bool status = false;
+  nECU_CAN_TxFrame frame = Tx_frame_List[frameID].can_data; // header
+  frame.Header.DLC = nECU_Frame_Compose(frameID, frame.Buffer);
+  frame.Buffer[index] |= bits;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // queue is shared with periodic release and mailbox interrupt
+  // replaces regular frame waiting in queue, as this copy carries newer data and more
+  status |= nECU_CAN_TX_Queue_Push(&TX_Queue, &frame, HAL_GetTick() + TX_delay_List[frameID], true);
+  nECU_CAN_TX_Queue_Load(&hcan1, &TX_Queue);
+  __set_PRIMASK(primask);
+
+  return status;
+}
+bool nECU_CAN_TX_Send(uint32_t StdId, uint8_t const *data, uint8_t length) // queue frame outside of periodic list, returns true if there is no room (called from interrupt)
 {
-  if (currentID >= CAN_RX_ID_MAX) // Break if invalid ID
-    return true;                  // Break
+  if (!nECU_FlowControl_Working_Check(D_CAN_TX) || length > 8)
+    return true;
+
+  nECU_CAN_TxFrame frame = {0};
+  frame.Header.StdId = StdId;
+  frame.Header.IDE = CAN_ID_STD;
+  frame.Header.RTR = CAN_RTR_DATA;
+  frame.Header.DLC = length;
+  memcpy(frame.Buffer, data, length);
 
   bool status = false;
-  Rx_frame_List[currentID].filter.FilterBank = currentID;
-  Rx_frame_List[currentID].filter.FilterMode = CAN_FILTERMODE_IDMASK;
-  Rx_frame_List[currentID].filter.FilterFIFOAssignment = CAN_RX_FIFO0;
-  Rx_frame_List[currentID].filter.FilterIdHigh = RX_Msg_ID_List[currentID] << 5;
-  Rx_frame_List[currentID].filter.FilterIdLow = 0;
-  Rx_frame_List[currentID].filter.FilterMaskIdHigh = 0xFFFF;
-  Rx_frame_List[currentID].filter.FilterMaskIdLow = 0xFFFF;
-  Rx_frame_List[currentID].filter.FilterScale = CAN_FILTERSCALE_32BIT;
-  Rx_frame_List[currentID].filter.FilterActivation = ENABLE;
-  Rx_frame_List[currentID].filter.SlaveStartFilterBank = 0;
-
-  status |= (HAL_CAN_ConfigFilter(&hcan1, &(Rx_frame_List[currentID].filter)) != HAL_OK); // Initialize CAN Filter
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // queue is shared with periodic frames and mailbox interrupt
+  if (TX_Queue.count >= (CAN_TX_QUEUE_LEN - CAN_TX_ID_MAX)) // keep room for one copy of each periodic frame
+    status = true;
+  else
+    status |= nECU_CAN_TX_Queue_Push(&TX_Queue, &frame, HAL_GetTick() + CAN_TX_SEND_TIMEOUT, false); // every frame is sent, in order
+  nECU_CAN_TX_Queue_Load(&hcan1, &TX_Queue);
+  __set_PRIMASK(primask);
+
+  return status;
+}
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) // interrupt callback when mailbox 0 is free again
+{
+  nECU_CAN_Health_TX_done(0);
+  nECU_CAN_TX_Queue_Load(hcan, &TX_Queue);
+  nECU_ISOTP_TX_Callback();
+}
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) // interrupt callback when mailbox 1 is free again
+{
+  nECU_CAN_Health_TX_done(1);
+  nECU_CAN_TX_Queue_Load(hcan, &TX_Queue);
+  nECU_ISOTP_TX_Callback();
+}
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) // interrupt callback when mailbox 2 is free again
+{
+  nECU_CAN_Health_TX_done(2);
+  nECU_CAN_TX_Queue_Load(hcan, &TX_Queue);
+  nECU_ISOTP_TX_Callback();
+}
+
+// TX queue functions, last entry is sent first
+static bool nECU_CAN_TX_Queue_Before(nECU_CAN_TX_Entry const *first, nECU_CAN_TX_Entry const *second) // returns true if first entry has to be sent before second
+{
+  if (first->frame.Header.StdId != second->frame.Header.StdId)
+    return first->frame.Header.StdId < second->frame.Header.StdId; // same rule as bus arbitration
+  return (int32_t)(first->deadline - second->deadline) < 0;
+}
+static void nECU_CAN_TX_Queue_Remove(nECU_CAN_TX_Queue *queue, uint8_t index) // remove entry keeping order of others
+{
+  memmove(&(queue->entry[index]), &(queue->entry[index + 1]), (queue->count - index - 1) * sizeof(queue->entry[0]));
+  queue->count--;
+}
+static void nECU_CAN_TX_Queue_Expire(nECU_CAN_TX_Queue *queue, uint32_t tick) // remove entries after their deadline
+{
+  for (uint8_t index = queue->count; index > 0; index--)
+  {
+    if ((int32_t)(tick - queue->entry[index - 1].deadline) > 0)
+    {
+      nECU_CAN_TX_Queue_Remove(queue, index - 1);
+      queue->expire_count++;
+    }
+  }
+}
+static bool nECU_CAN_TX_Queue_Push(nECU_CAN_TX_Queue *queue, nECU_CAN_TxFrame const *frame, uint32_t deadline, bool replace) // add frame by priority, returns true if frame was dropped (call with interrupts disabled)
+{
+  queue->push_count++;
+
+  if (replace) // overwrite older copy of the same frame
+  {
+    for (uint8_t index = 0; index < queue->count; index++)
+    {
+      if (queue->entry[index].frame.Header.StdId == frame->Header.StdId)
+      {
+        queue->entry[index].frame = *frame;
+        queue->entry[index].deadline = deadline; // only one copy of replaced frame is queued, order stays valid
+        queue->replace_count++;
+        return false;
+      }
+    }
+  }
+
+  nECU_CAN_TX_Entry new_entry = {.frame = *frame, .deadline = deadline};
+  if (queue->count >= CAN_TX_QUEUE_LEN)
+    nECU_CAN_TX_Queue_Expire(queue, HAL_GetTick());
+  if (queue->count >= CAN_TX_QUEUE_LEN) // still full, make room by dropping lowest priority
+  {
+    queue->drop_count++;
+    if (!nECU_CAN_TX_Queue_Before(&new_entry, &(queue->entry[0])))
+      return true; // new frame has lowest priority
+    nECU_CAN_TX_Queue_Remove(queue, 0);
+  }
+
+  uint8_t position = 0; // entries below position are sent after new one, equal ones stay ahead
+  while (position < queue->count && nECU_CAN_TX_Queue_Before(&new_entry, &(queue->entry[position])))
+    position++;
+  memmove(&(queue->entry[position + 1]), &(queue->entry[position]), (queue->count - position) * sizeof(queue->entry[0]));
+  queue->entry[position] = new_entry;
+  queue->count++;
+  if (queue->count > queue->peak)
+    queue->peak = queue->count;
+
+  return false;
+}
+static void nECU_CAN_TX_Queue_Retry(nECU_CAN_TX_Queue *queue, nECU_CAN_TX_Entry const *entry) // put frame that failed in mailbox back ahead of queued frames of its ID (call with interrupts disabled)
+{
+  queue->retry_count++;
+
+  if (queue->count >= CAN_TX_QUEUE_LEN)
+    nECU_CAN_TX_Queue_Expire(queue, HAL_GetTick());
+  if (queue->count >= CAN_TX_QUEUE_LEN) // still full, make room by dropping lowest priority
+  {
+    queue->drop_count++;
+    if (!nECU_CAN_TX_Queue_Before(entry, &(queue->entry[0])))
+      return; // failed frame has lowest priority
+    nECU_CAN_TX_Queue_Remove(queue, 0);
+  }
+
+  uint8_t position = 0; // unlike push, passes entries of the same ID, as it was loaded before them
+  while (position < queue->count && !nECU_CAN_TX_Queue_Before(&(queue->entry[position]), entry))
+    position++;
+  memmove(&(queue->entry[position + 1]), &(queue->entry[position]), (queue->count - position) * sizeof(queue->entry[0]));
+  queue->entry[position] = *entry;
+  queue->count++;
+  if (queue->count > queue->peak)
+    queue->peak = queue->count;
+}
+static bool nECU_CAN_TX_Queue_Pop(nECU_CAN_TX_Queue *queue, nECU_CAN_TX_Entry *entry, uint32_t tick, uint32_t const *mailbox_StdId) // take highest priority frame that is not stale and has no frame of its ID in mailboxes, returns false if there is none (call with interrupts disabled)
+{
+  for (uint8_t index = queue->count; index > 0; index--)
+  {
+    nECU_CAN_TX_Entry *queued = &(queue->entry[index - 1]);
+    if ((int32_t)(tick - queued->deadline) > 0)
+    {
+      nECU_CAN_TX_Queue_Remove(queue, index - 1);
+      queue->expire_count++;
+      continue;
+    }
+
+    bool loaded = false; // bxCAN sends equal IDs by mailbox number, not in order of loading
+    for (uint8_t mailbox = 0; mailbox_StdId != NULL && mailbox < 3; mailbox++)
+      loaded |= (mailbox_StdId[mailbox] == queued->frame.Header.StdId);
+    if (loaded)
+      continue; // next one is loaded from TX complete of this ID
+
+    *entry = *queued;
+    nECU_CAN_TX_Queue_Remove(queue, index - 1);
+    return true;
+  }
+  return false;
+}
+static void nECU_CAN_TX_Queue_Load(CAN_HandleTypeDef *hcan, nECU_CAN_TX_Queue *queue) // move queued frames to free mailboxes
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // called from both thread and mailbox interrupt
+  nECU_CAN_TX_Entry entry;
+  uint32_t mail;
+  for (uint8_t mailbox = 0; mailbox < 3; mailbox++) // frames that left mailbox without TX complete callback
+  {
+    if (CAN_Health.mailbox_StdId[mailbox] == CAN_TX_MAILBOX_FREE || HAL_CAN_IsTxMessagePending(hcan, CAN_TX_MAILBOX0 << mailbox))
+      continue;
+    uint32_t sent = (CAN_TSR_RQCP0 | CAN_TSR_TXOK0) << (8 * mailbox); // completed, callback not served yet
+    if ((hcan->Instance->TSR & sent) != sent && CAN_Health.mailbox_frame[mailbox] == CAN_TX_ID_MAX)
+      nECU_CAN_TX_Queue_Retry(queue, &TX_Mailbox_List[mailbox]); // lost arbitration or bus error, there is no automatic retransmission and ISO-TP or XCP can not skip a frame
+    CAN_Health.mailbox_StdId[mailbox] = CAN_TX_MAILBOX_FREE;
+  }
+  while (HAL_CAN_GetTxMailboxesFreeLevel(hcan) && nECU_CAN_TX_Queue_Pop(queue, &entry, HAL_GetTick(), CAN_Health.mailbox_StdId))
+  {
+    if (HAL_CAN_AddTxMessage(hcan, &(entry.frame.Header), entry.frame.Buffer, &mail) != HAL_OK)
+    {
+      queue->drop_count++;
+      continue;
+    }
+    uint8_t mailbox = (mail == CAN_TX_MAILBOX0) ? 0 : ((mail == CAN_TX_MAILBOX1) ? 1 : 2);
+    TX_Mailbox_List[mailbox] = entry;
+    CAN_Health.mailbox_StdId[mailbox] = entry.frame.Header.StdId;
+    CAN_Health.mailbox_cycles[mailbox] = nECU_CycleCounter_Get(); // start of TX latency
+    CAN_Health.mailbox_DLC[mailbox] = entry.frame.Header.DLC;
+    CAN_Health.mailbox_frame[mailbox] = nECU_CAN_TX_Identify(entry.frame.Header.StdId);
+  }
+  __set_PRIMASK(primask);
+}
+static void nECU_CAN_TX_Queue_Flush(nECU_CAN_TX_Queue *queue) // drop all queued frames
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  queue->count = 0;
+  __set_PRIMASK(primask);
+}
+
+// RX functions
+static bool nECU_CAN_RX_Init(void) // pack RX IDs into 16-bit list mode filter banks, four per bank
+{
+  bool status = false;
+  CAN_FilterTypeDef filter = {0};
+  filter.FilterMode = CAN_FILTERMODE_IDLIST;
+  filter.FilterScale = CAN_FILTERSCALE_16BIT;
+  filter.FilterFIFOAssignment = CAN_RX_FIFO0;
+  filter.FilterActivation = ENABLE;
+  filter.SlaveStartFilterBank = CAN_RX_FILTER_BANK_MAX; // banks below belong to CAN1
+
+  memset(RX_FMI_List, CAN_RX_ID_MAX, sizeof(RX_FMI_List));
+  uint16_t slot[CAN_RX_FILTER_SLOTS];
+  for (uint8_t bank = 0; (bank * CAN_RX_FILTER_SLOTS) < CAN_RX_ID_MAX; bank++)
+  {
+    for (uint8_t index = 0; index < CAN_RX_FILTER_SLOTS; index++)
+    {
+      // filter match index counts every slot of FIFO0 banks in order, unused slots repeat last ID and never match first
+      uint8_t FMI = (bank * CAN_RX_FILTER_SLOTS) + index;
+      nECU_CAN_RX_Frame_ID currentID = (FMI < CAN_RX_ID_MAX) ? FMI : (CAN_RX_ID_MAX - 1);
+      slot[index] = CAN_RX_FILTER_STDID(RX_Msg_ID_List[currentID]);
+      RX_FMI_List[FMI] = currentID;
+    }
+    filter.FilterBank = bank;
+    filter.FilterIdLow = slot[0];
+    filter.FilterMaskIdLow = slot[1];
+    filter.FilterIdHigh = slot[2];
+    filter.FilterMaskIdHigh = slot[3];
+    status |= (HAL_CAN_ConfigFilter(&hcan1, &filter) != HAL_OK); // Initialize CAN Filter
+  }
   return status;
 }
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) // interrupt callback when new Rx frame in FIFO0
@@ -223,32 +482,212 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) // interrupt cal
   static uint8_t Buffer[8] = {0};
   memset(Buffer, 0, sizeof(Buffer));                            // clear buffer
   HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &RX_Header, Buffer); // Receive CAN bus message to canRX buffer
+  CAN_Health.rx_count++;
+  CAN_Health.bits += CAN_FRAME_BITS(RX_Header.DLC);
   nECU_CAN_RX_Frame_ID ID = nECU_CAN_RX_Identify(&RX_Header);
-  nECU_CAN_RX_Update(ID, Buffer);
+  if (ID < CAN_RX_ID_MAX)
+  {
+    RX_Handler_List[ID](ID, Buffer, RX_Header.DLC);
+    nECU_Scheduler_Event(EVENT_CAN_RX_ID, ID);
+  }
   nECU_Debug_ProgramBlockData_Update(D_CAN_RX);
 }
-static nECU_CAN_RX_Frame_ID nECU_CAN_RX_Identify(CAN_RxHeaderTypeDef *pHeader)
+static nECU_CAN_RX_Frame_ID nECU_CAN_RX_Identify(CAN_RxHeaderTypeDef *pHeader) // returns frame ID from filter match index
 {
-  for (nECU_CAN_RX_Frame_ID currentID = 0; currentID < CAN_RX_ID_MAX; currentID++)
-    if (RX_Msg_ID_List[currentID] == (pHeader->StdId))
-      return currentID;
+  if (pHeader->FilterMatchIndex >= sizeof(RX_FMI_List)) // Break if filter was not allocated
+    return CAN_RX_ID_MAX;
 
-  return CAN_RX_ID_MAX;
+  nECU_CAN_RX_Frame_ID currentID = RX_FMI_List[pHeader->FilterMatchIndex];
+  if (currentID >= CAN_RX_ID_MAX || RX_Msg_ID_List[currentID] != pHeader->StdId || pHeader->IDE != CAN_ID_STD)
+    return CAN_RX_ID_MAX;
+
+  return currentID;
 }
-static void nECU_CAN_RX_Update(nECU_CAN_RX_Frame_ID currentID, uint8_t *buf) // update value
+static void nECU_CAN_RX_Update(nECU_CAN_RX_Frame_ID currentID, uint8_t const *buf, uint8_t length) // store raw payload with time of reception
 {
   if (currentID >= CAN_RX_ID_MAX) // Break if invalid ID
     return;                       // Break
 
-  union Int32ToBytes Converter;
-  memcpy(Converter.byteArray, buf, 4);
-  Rx_frame_List[currentID].output = Converter.IntValue;
+  UNUSED(length); // buffer is zero padded by caller
+  nECU_CAN_Rx_Data *frame = &(Rx_frame_List[currentID]);
+  nECU_CAN_RX_Sample sample = {.timestamp = HAL_GetTick(), .count = frame->sample.count + 1};
+  uint32_t cycles = nECU_CycleCounter_Get();
+  memcpy(sample.payload, buf, sizeof(sample.payload));
+
+  if (frame->sample.count) // inter-arrival time, cycle counter wraps so long gaps are measured with tick
+  {
+    uint32_t interval = sample.timestamp - frame->sample.timestamp;
+    interval = (interval < CAN_RX_INTERVAL_LONG) ? nECU_CycleCounter_toUs(cycles - frame->last_cycles) : (interval * 1000);
+    if (interval < frame->interval_min || frame->sample.count == 1)
+      frame->interval_min = interval;
+    if (interval > frame->interval_max)
+      frame->interval_max = interval;
+  }
+  frame->last_cycles = cycles;
+
+  nECU_Seqlock_Write(&(frame->lock), &(frame->sample), &sample, sizeof(sample));
 }
-int32_t nECU_CAN_RX_getValue(nECU_CAN_RX_Frame_ID currentID) // returns value of given frame
+static bool nECU_CAN_RX_getSample(nECU_CAN_RX_Frame_ID currentID, nECU_CAN_RX_Sample *sample) // copy last reception of given frame, returns false if it was not received
 {
   if (currentID >= CAN_RX_ID_MAX) // Break if invalid ID
-    return 0;                     // Break
-  return Rx_frame_List[currentID].output;
+    return false;                 // Break
+
+  if (!nECU_Seqlock_Read(&(Rx_frame_List[currentID].lock), sample, &(Rx_frame_List[currentID].sample), sizeof(*sample), NULL))
+    return false; // frame being written for too long
+
+  return sample->count != 0;
+}
+int32_t nECU_CAN_RX_getValue(nECU_CAN_RX_Frame_ID currentID) // returns value of given frame
+{
+  nECU_CAN_RX_Sample sample;
+  if (!nECU_CAN_RX_getSample(currentID, &sample))
+    return 0;
+
+  union Int32ToBytes Converter;
+  memcpy(Converter.byteArray, sample.payload, 4);
+  return Converter.IntValue;
+}
+bool nECU_CAN_RX_getValid(nECU_CAN_RX_Frame_ID currentID, int32_t *value) // copy value of given frame if it is not older than its timeout, otherwise 'value' is left untouched
+{
+  nECU_CAN_RX_Sample sample;
+  if (value == NULL || !nECU_CAN_RX_getSample(currentID, &sample))
+    return false;
+  if ((HAL_GetTick() - sample.timestamp) > RX_Timeout_List[currentID]) // stale data
+    return false;
+
+  union Int32ToBytes Converter;
+  memcpy(Converter.byteArray, sample.payload, 4);
+  *value = Converter.IntValue;
+  return true;
+}
+
+// Health functions
+static void nECU_CAN_Health_Init(void) // bitrate from bit timing, clear statistics
+{
+  memset(&CAN_Health, 0, sizeof(CAN_Health));
+  uint32_t quanta = 1 + ((hcan1.Init.TimeSeg1 >> CAN_BTR_TS1_Pos) + 1) + ((hcan1.Init.TimeSeg2 >> CAN_BTR_TS2_Pos) + 1); // sync segment and both phase segments
+  CAN_Health.bitrate = HAL_RCC_GetPCLK1Freq() / (hcan1.Init.Prescaler * quanta);
+  CAN_Health.backoff = CAN_BUSOFF_BACKOFF_MIN;
+  CAN_Health.window_tick = HAL_GetTick();
+  memset(CAN_Health.mailbox_frame, CAN_TX_ID_MAX, sizeof(CAN_Health.mailbox_frame));
+  for (uint8_t mailbox = 0; mailbox < 3; mailbox++)
+    CAN_Health.mailbox_StdId[mailbox] = CAN_TX_MAILBOX_FREE;
+  CAN_Health.busoff_tick = HAL_GetTick() - CAN_BUSOFF_STABLE;
+}
+static void nECU_CAN_Health_Update(void) // read error status register and count state transitions (call with interrupts disabled)
+{
+  uint32_t ESR = hcan1.Instance->ESR;
+  CAN_Health.TEC = (ESR & CAN_ESR_TEC_Msk) >> CAN_ESR_TEC_Pos;
+  CAN_Health.REC = (ESR & CAN_ESR_REC_Msk) >> CAN_ESR_REC_Pos;
+  CAN_Health.LEC = (ESR & CAN_ESR_LEC_Msk) >> CAN_ESR_LEC_Pos;
+
+  nECU_CAN_Bus_State state = CAN_BUS_ACTIVE;
+  if (ESR & CAN_ESR_BOFF)
+    state = CAN_BUS_OFF;
+  else if (ESR & CAN_ESR_EPVF)
+    state = CAN_BUS_PASSIVE;
+  else if (ESR & CAN_ESR_EWGF)
+    state = CAN_BUS_WARNING;
+
+  if (state > CAN_Health.state) // count every level passed on the way down
+  {
+    if (CAN_Health.state < CAN_BUS_WARNING && state >= CAN_BUS_WARNING)
+      CAN_Health.warning_count++;
+    if (CAN_Health.state < CAN_BUS_PASSIVE && state >= CAN_BUS_PASSIVE)
+      CAN_Health.passive_count++;
+    if (state == CAN_BUS_OFF)
+    {
+      CAN_Health.busoff_count++;
+      if ((HAL_GetTick() - CAN_Health.busoff_tick) > CAN_BUSOFF_STABLE) // link was fine for a long time, retry quickly
+        CAN_Health.backoff = CAN_BUSOFF_BACKOFF_MIN;
+      CAN_Health.busoff_tick = HAL_GetTick();
+    }
+  }
+  CAN_Health.state = state;
+}
+static void nECU_CAN_Health_Routine(void) // bus load window and bus-off recovery, call every 1 ms
+{
+  uint32_t tick = HAL_GetTick();
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // statistics are written from CAN interrupts
+  nECU_CAN_Health_Update();
+  if (CAN_Health.state == CAN_BUS_OFF && (tick - CAN_Health.busoff_tick) >= CAN_Health.backoff)
+    nECU_CAN_Health_Recover();
+
+  bool window_done = false;
+  uint32_t elapsed = tick - CAN_Health.window_tick;
+  if (elapsed >= CAN_LOAD_WINDOW && CAN_Health.bitrate)
+  {
+    CAN_Health.load = (uint16_t)(((uint64_t)CAN_Health.bits * 1000 * 1000) / ((uint64_t)CAN_Health.bitrate * elapsed));
+    if (CAN_Health.load > CAN_Health.load_max)
+      CAN_Health.load_max = CAN_Health.load;
+    CAN_Health.bits = 0;
+    CAN_Health.window_tick = tick;
+    window_done = true;
+  }
+  __set_PRIMASK(primask);
+
+  if (window_done)
+    nECU_Debug_CAN_Check(); // report new error passive and bus-off events
+}
+static void nECU_CAN_Health_Recover(void) // request leaving of bus-off state
+{
+  // automatic bus-off management is disabled, node returns to bus after init mode and 128 x 11 recessive bits
+  SET_BIT(hcan1.Instance->MCR, CAN_MCR_INRQ);
+  for (uint16_t poll = 0; poll < CAN_INIT_TIMEOUT && !(hcan1.Instance->MSR & CAN_MSR_INAK); poll++)
+    ;
+  CLEAR_BIT(hcan1.Instance->MCR, CAN_MCR_INRQ);
+
+  CAN_Health.recovery_count++;
+  CAN_Health.busoff_tick = HAL_GetTick();
+  CAN_Health.backoff *= 2; // next attempt later, bus may be shorted or missing termination
+  if (CAN_Health.backoff > CAN_BUSOFF_BACKOFF_MAX)
+    CAN_Health.backoff = CAN_BUSOFF_BACKOFF_MAX;
+}
+static void nECU_CAN_Health_TX_done(uint8_t mailbox) // latency and bits of transmitted frame (called from interrupt)
+{
+  CAN_Health.mailbox_StdId[mailbox] = CAN_TX_MAILBOX_FREE; // sent, anything else leaving mailbox is queued again
+  uint32_t cycles = nECU_CycleCounter_Get();
+  uint32_t latency = nECU_CycleCounter_toUs(cycles - CAN_Health.mailbox_cycles[mailbox]);
+  CAN_Health.latency_last[mailbox] = latency;
+  if (latency > CAN_Health.latency_max[mailbox])
+    CAN_Health.latency_max[mailbox] = latency;
+  CAN_Health.tx_count++;
+  CAN_Health.bits += CAN_FRAME_BITS(CAN_Health.mailbox_DLC[mailbox]);
+
+  nECU_CAN_TX_Frame_ID ID = CAN_Health.mailbox_frame[mailbox];
+  if (ID >= CAN_TX_ID_MAX) // not a periodic frame
+    return;
+
+  nECU_CAN_Tx_Data *frame = &(Tx_frame_List[ID]);
+  if (frame->tx_count) // jitter of TX interval as seen by receivers
+  {
+    int32_t deviation = (int32_t)nECU_CycleCounter_toUs(cycles - frame->tx_cycles) - (int32_t)(TX_delay_List[ID] * 1000);
+    frame->jitter_last = (deviation < 0) ? -deviation : deviation;
+    if (frame->jitter_last > frame->jitter_max)
+      frame->jitter_max = frame->jitter_last;
+  }
+  frame->tx_cycles = cycles;
+  frame->tx_count++;
+}
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan) // interrupt callback of bus errors, state changes and failed transmissions
+{
+  CAN_Health.error_code |= hcan->ErrorCode;
+  CAN_Health.error_count++;
+  nECU_CAN_Health_Update();
+
+  uint32_t TX_failed = HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0 | HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1 | HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2;
+  bool mailbox_freed = (hcan->ErrorCode & TX_failed) != 0; // no retransmission, mailbox is empty again and its frame may be queued again
+  HAL_CAN_ResetError(hcan);
+  if (mailbox_freed)
+  {
+    nECU_CAN_TX_Queue_Load(hcan, &TX_Queue);
+    nECU_ISOTP_TX_Callback();
+  }
+}
+nECU_CAN_Health *nECU_CAN_Health_getPointer(void) // returns pointer to bus health statistics
+{
+  return &CAN_Health;
 }
 
 // Diagnostic functions
@@ -256,6 +695,48 @@ static uint8_t nECU_CAN_IsBusy(void) // Check if any messages are pending
 {
   return 3 - HAL_CAN_GetTxMailboxesFreeLevel(&hcan1);
 }
+void nECU_CAN_Report(void) // print bus health, TX queue and RX timing statistics to PC
+{
+  static char const *const state_names[] = {"active", "warning", "passive", "bus-off"};
+  nECU_CAN_Health health = CAN_Health; // copy, fields change in interrupts
+  printf("CAN bus\tstate\tTEC\tREC\tLEC\terrors\tflags\t\tpassive\tbus-off\trecovered\n\r");
+  printf("\t%s\t%u\t%u\t%u\t%lu\t0x%08lX\t%lu\t%lu\t%lu\n\r", state_names[health.state],
+         health.TEC, health.REC, health.LEC, (unsigned long)health.error_count, (unsigned long)health.error_code,
+         (unsigned long)health.passive_count, (unsigned long)health.busoff_count, (unsigned long)health.recovery_count);
+  printf("CAN load\tnow\tmax\tbitrate\t\tsent\treceived\tlatency last/max [us] per mailbox\n\r");
+  printf("\t\t%u.%u%%\t%u.%u%%\t%lu\t\t%lu\t%lu\t\t%lu/%lu %lu/%lu %lu/%lu\n\r",
+         health.load / 10, health.load % 10, health.load_max / 10, health.load_max % 10, (unsigned long)health.bitrate,
+         (unsigned long)health.tx_count, (unsigned long)health.rx_count,
+         (unsigned long)health.latency_last[0], (unsigned long)health.latency_max[0],
+         (unsigned long)health.latency_last[1], (unsigned long)health.latency_max[1],
+         (unsigned long)health.latency_last[2], (unsigned long)health.latency_max[2]);
+
+  printf("CAN TX queue\tqueued\treplaced\tretried\tdropped\texpired\tpeak\n\r");
+  printf("\t\t%lu\t%lu\t\t%lu\t%lu\t%lu\t%u/%u\n\r",
+         (unsigned long)TX_Queue.push_count, (unsigned long)TX_Queue.replace_count, (unsigned long)TX_Queue.retry_count,
+         (unsigned long)TX_Queue.drop_count, (unsigned long)TX_Queue.expire_count,
+         TX_Queue.peak, CAN_TX_QUEUE_LEN);
+
+  printf("CAN TX ID\tperiod [ms]\tsent\tjitter last/max [us]\n\r");
+  for (nECU_CAN_TX_Frame_ID currentID = 0; currentID < CAN_TX_ID_MAX; currentID++)
+    printf("0x%03lX\t\t%lu\t\t%lu\t%lu/%lu\n\r", (unsigned long)TX_Msg_ID_List[currentID], (unsigned long)TX_delay_List[currentID],
+           (unsigned long)Tx_frame_List[currentID].tx_count,
+           (unsigned long)Tx_frame_List[currentID].jitter_last, (unsigned long)Tx_frame_List[currentID].jitter_max);
+
+  printf("CAN RX ID\treceived\tage [ms]\ttimeout [ms]\tinterval min/max [us]\n\r");
+  for (nECU_CAN_RX_Frame_ID currentID = 0; currentID < CAN_RX_ID_MAX; currentID++)
+  {
+    nECU_CAN_RX_Sample sample;
+    if (!nECU_CAN_RX_getSample(currentID, &sample))
+    {
+      printf("0x%03lX\t\t0\t\t-\t\t%lu\t\t-\n\r", (unsigned long)RX_Msg_ID_List[currentID], (unsigned long)RX_Timeout_List[currentID]);
+      continue;
+    }
+    printf("0x%03lX\t\t%lu\t\t%lu\t\t%lu\t\t%lu/%lu\n\r", (unsigned long)RX_Msg_ID_List[currentID],
+           (unsigned long)sample.count, (unsigned long)(HAL_GetTick() - sample.timestamp), (unsigned long)RX_Timeout_List[currentID],
+           (unsigned long)Rx_frame_List[currentID].interval_min, (unsigned long)Rx_frame_List[currentID].interval_max);
+  }
+}
 bool nECU_CAN_GetError(void) // get error state pf can periperal buisy
 {
   HAL_CAN_StateTypeDef CurrentState = HAL_CAN_GetState(&hcan1);
@@ -267,3 +748,146 @@ bool nECU_CAN_GetError(void) // get error state pf can periperal buisy
   }
   return false;
 }
+
+/* Test */
+static bool nECU_CAN_test_Order(void) // test priority order and replacement of queued frames
+{
+  static nECU_CAN_TX_Queue queue; // too big for stack of test
+  memset(&queue, 0, sizeof(queue));
+  nECU_CAN_TxFrame frame = {0};
+  nECU_CAN_TX_Entry result = {0};
+
+  uint32_t const ID_List[3] = {0x502, 0x500, 0x501};
+  for (uint8_t index = 0; index < 3; index++)
+  {
+    frame.Header.StdId = ID_List[index];
+    if (nECU_CAN_TX_Queue_Push(&queue, &frame, 10, true))
+      return false;
+  }
+  frame.Header.StdId = 0x502; // newer data replaces queued copy
+  frame.Buffer[0] = 0xAA;
+  if (nECU_CAN_TX_Queue_Push(&queue, &frame, 10, true) || queue.count != 3 || queue.replace_count != 1)
+    return false;
+
+  for (uint32_t ID = 0x500; ID <= 0x502; ID++) // lowest ID first
+    if (!nECU_CAN_TX_Queue_Pop(&queue, &result, 0, NULL) || result.frame.Header.StdId != ID)
+      return false;
+  if (result.frame.Buffer[0] != 0xAA || nECU_CAN_TX_Queue_Pop(&queue, &result, 0, NULL))
+    return false;
+
+  for (uint8_t index = 0; index < 3; index++) // same ID without replacement keeps order of push
+  {
+    frame.Buffer[0] = index;
+    nECU_CAN_TX_Queue_Push(&queue, &frame, 10, false);
+  }
+  for (uint8_t index = 0; index < 3; index++)
+    if (!nECU_CAN_TX_Queue_Pop(&queue, &result, 0, NULL) || result.frame.Buffer[0] != index)
+      return false;
+
+  return true;
+}
+static bool nECU_CAN_test_Full(void) // test dropping and expiry of queued frames
+{
+  static nECU_CAN_TX_Queue queue; // too big for stack of test
+  memset(&queue, 0, sizeof(queue));
+  nECU_CAN_TxFrame frame = {0};
+  nECU_CAN_TX_Entry result = {0};
+
+  for (uint8_t index = 0; index < CAN_TX_QUEUE_LEN; index++)
+  {
+    frame.Header.StdId = 0x600 + index;
+    nECU_CAN_TX_Queue_Push(&queue, &frame, HAL_GetTick() + 1000, true);
+  }
+  frame.Header.StdId = 0x700; // lowest priority is dropped
+  if (!nECU_CAN_TX_Queue_Push(&queue, &frame, HAL_GetTick() + 1000, true) || queue.drop_count != 1)
+    return false;
+  frame.Header.StdId = 0x100; // highest priority takes place of lowest one
+  if (nECU_CAN_TX_Queue_Push(&queue, &frame, HAL_GetTick() + 1000, true) || queue.drop_count != 2)
+    return false;
+  if (queue.peak != CAN_TX_QUEUE_LEN || queue.entry[0].frame.Header.StdId != 0x600 + CAN_TX_QUEUE_LEN - 2)
+    return false;
+  if (!nECU_CAN_TX_Queue_Pop(&queue, &result, HAL_GetTick(), NULL) || result.frame.Header.StdId != 0x100)
+    return false;
+
+  if (nECU_CAN_TX_Queue_Pop(&queue, &result, HAL_GetTick() + 1001, NULL)) // stale frames are not sent
+    return false;
+  if (queue.count != 0 || queue.expire_count != CAN_TX_QUEUE_LEN - 1)
+    return false;
+
+  return true;
+}
+static bool nECU_CAN_test_Arbitration(void) // test that frames of one ID leave in order through bxCAN mailboxes, also when one of them fails
+{
+  static nECU_CAN_TX_Queue queue; // too big for stack of test
+  memset(&queue, 0, sizeof(queue));
+  nECU_CAN_TxFrame frame = {0};
+  nECU_CAN_TX_Entry mailbox[3] = {0};
+  uint32_t mailbox_StdId[3] = {CAN_TX_MAILBOX_FREE, CAN_TX_MAILBOX_FREE, CAN_TX_MAILBOX_FREE};
+  bool failed = false;
+
+  frame.Header.StdId = ISOTP_TX_ID; // consecutive frames of single message
+  for (uint8_t index = 0; index < CAN_TEST_SEGMENTS; index++)
+  {
+    frame.Buffer[0] = index;
+    nECU_CAN_TX_Queue_Push(&queue, &frame, 10, false);
+  }
+  frame.Header.StdId = CAN_MSG_SPEED_ID; // periodic frame takes first mailbox and frees it first
+  nECU_CAN_TX_Queue_Push(&queue, &frame, 10, true);
+
+  uint8_t expected = 0;
+  for (uint8_t slot = 0; slot < 2 * CAN_TEST_SEGMENTS; slot++) // one frame on bus per slot
+  {
+    for (uint8_t index = 0; index < 3; index++) // HAL fills lowest free mailbox
+      if (mailbox_StdId[index] == CAN_TX_MAILBOX_FREE && nECU_CAN_TX_Queue_Pop(&queue, &mailbox[index], 0, mailbox_StdId))
+        mailbox_StdId[index] = mailbox[index].frame.Header.StdId;
+
+    uint8_t winner = 3; // lowest ID wins, equal IDs go by mailbox number (TXFP cleared)
+    for (uint8_t index = 0; index < 3; index++)
+      if (mailbox_StdId[index] != CAN_TX_MAILBOX_FREE && (winner == 3 || mailbox_StdId[index] < mailbox_StdId[winner]))
+        winner = index;
+    if (winner == 3) // everything sent
+      break;
+
+    mailbox_StdId[winner] = CAN_TX_MAILBOX_FREE;
+    if (mailbox[winner].frame.Header.StdId != ISOTP_TX_ID)
+      continue;
+    if (!failed && mailbox[winner].frame.Buffer[0] == CAN_TEST_SEGMENTS / 2) // bus error, mailbox is emptied without retransmission
+    {
+      failed = true;
+      nECU_CAN_TX_Queue_Retry(&queue, &mailbox[winner]);
+      continue;
+    }
+    if (mailbox[winner].frame.Buffer[0] != expected++)
+      return false;
+  }
+
+  return failed && (expected == CAN_TEST_SEGMENTS) && (queue.count == 0) && (queue.retry_count == 1);
+}
+bool nECU_CAN_test(bool logging_enable) // Run test
+{
+  if (logging_enable)
+    printf("Started test of nECU_can.c\n\r");
+
+  if (!nECU_CAN_test_Order())
+  {
+    if (logging_enable)
+      printf("\n\rFAIL on nECU_CAN_test_Order()\n\r");
+    return false;
+  }
+  if (!nECU_CAN_test_Full())
+  {
+    if (logging_enable)
+      printf("\n\rFAIL on nECU_CAN_test_Full()\n\r");
+    return false;
+  }
+  if (!nECU_CAN_test_Arbitration())
+  {
+    if (logging_enable)
+      printf("\n\rFAIL on nECU_CAN_test_Arbitration()\n\r");
+    return false;
+  }
+
+  if (logging_enable)
+    printf("OK\n\r");
+  return true;
+}
@@ -188,6 +188,90 @@ void nECU_Sensor_Routine(Sensor_Handle *sensor)
         sensor->output = nECU_correctToVref(sensor->output);   // correct to vref
 }
 
+/* Sensor banks */
+bool nECU_SensorBank_Attach(nECU_SensorBank *bank, uint8_t channel, uint16_t *input, SensorCalibration *calibration, float alpha, Buffer_uint16 buf, uint32_t delay) // fill channel data of the bank
+{
+    if (bank == NULL || calibration == NULL) // break if pointer does not exist
+        return true;
+    if (channel >= SENSOR_BANK_CHANNEL_COUNT) // check if channel valid
+        return true;
+
+    // Pointers (input may be connected later)
+    bank->Input[channel] = input;
+    bank->newData[channel] = NULL;
+
+    // Calibration
+    nECU_calculateLinearCalibration(calibration);
+    bank->factor[channel] = calibration->factor;
+    bank->offset[channel] = calibration->offset;
+
+    // Filtering
+    bank->smoothingAlpha[channel] = alpha;
+    bank->previous_Input[channel] = 0;
+    bank->buf[channel] = buf;
+
+    // Default value
+    bank->output[channel] = 0.0;
+
+    return nECU_Delay_Set(&(bank->delay[channel]), delay);
+}
+bool nECU_SensorBank_Enable(nECU_SensorBank *bank, uint8_t channel) // include channel in batch pass
+{
+    if (bank == NULL) // break if pointer does not exist
+        return true;
+    if (channel >= SENSOR_BANK_CHANNEL_COUNT || bank->Input[channel] == NULL) // check if channel valid and connected
+        return true;
+
+    bank->enabled |= (1 << channel);
+    return nECU_Delay_Start(&(bank->delay[channel]));
+}
+bool nECU_SensorBank_Disable(nECU_SensorBank *bank, uint8_t channel) // exclude channel from batch pass
+{
+    if (bank == NULL) // break if pointer does not exist
+        return true;
+    if (channel >= SENSOR_BANK_CHANNEL_COUNT) // check if channel valid
+        return true;
+
+    bank->enabled &= ~(1 << channel);
+    return nECU_Delay_Stop(&(bank->delay[channel]));
+}
+void nECU_SensorBank_Routine(nECU_SensorBank *bank, uint32_t mask, float vref_factor) // single pass over enabled channels selected by mask
+{
+    if (bank == NULL) // break if pointer does not exist
+        return;
+
+    uint32_t pending = bank->enabled & mask;
+    while (pending)
+    {
+        uint8_t channel = __builtin_ctz(pending); // lowest pending channel
+        pending &= pending - 1;                   // mark as done
+
+        if (bank->newData[channel] != NULL) // source with update flag
+        {
+            if (*(bank->newData[channel]) == false) // no new data
+                continue;
+            *(bank->newData[channel]) = false;
+        }
+
+        nECU_Delay_Update(&(bank->delay[channel]));
+        if (bank->delay[channel].done == false) // check if time have passed
+            continue;                           // drop if not done
+        nECU_Delay_Start(&(bank->delay[channel])); // restart delay
+
+        uint16_t SmoothingResult = *(bank->Input[channel]);
+        if (bank->buf[channel].Buffer != NULL && bank->buf[channel].len > 0) // check if buffer was configured
+            SmoothingResult = nECU_averageSmooth(bank->buf[channel].Buffer, &SmoothingResult, bank->buf[channel].len);
+
+        SmoothingResult = nECU_expSmooth(&SmoothingResult, &(bank->previous_Input[channel]), bank->smoothingAlpha[channel]);
+        bank->previous_Input[channel] = SmoothingResult; // save for smoothing
+
+        float output = SmoothingResult * bank->factor[channel] + bank->offset[channel]; // calculate, calibration
+        if (bank->vref_mask & (1 << channel))                                           // correct to vref
+            output *= vref_factor;
+        bank->output[channel] = output;
+    }
+}
+
 /* Tests */
 static bool nECU_DataProcessing_test_Float(void) // test nECU_FloatToUint()
 {
@@ -16,6 +16,7 @@ bool nECU_Debug_Start(void) // starts up debugging functions
     bool status = false;
 
     nECU_Debug_ProgramBlock_Init();
+    nECU_CycleCounter_Init();
 
     if (!nECU_FlowControl_Initialize_Check(D_Debug))
     {
@@ -91,7 +92,6 @@ void nECU_Debug_Periodic(void) // checks states of variables
     nECU_Debug_IntTemp_Check(&(dbg_data.device_temperature));
     // nECU_Debug_EGTTemp_Check(&(dbg_data.egt_temperature));
     // nECU_Debug_EGTsensor_error(&(dbg_data.egt_communication));
-    // nECU_Debug_CAN_Check();
     // nECU_Debug_SPI_Check();
     nECU_Debug_ProgramBlockData_Update(D_Debug);
 }
@@ -157,16 +157,6 @@ static void nECU_Debug_EGTsensor_error(nECU_Debug_EGT_Comm *inst) // check EGT I
         }
     }
 }
-static void nECU_Debug_CAN_Check(void) // checks if CAN have any error pending
-{
-    if (!nECU_FlowControl_Working_Check(D_CAN_TX) || !nECU_FlowControl_Working_Check(D_CAN_RX)) // Check if RX or TX is working
-        if (nECU_CAN_GetError())
-        {
-            uint32_t error = HAL_CAN_GetError(&hcan1);
-            nECU_Debug_error_mesage temp;
-            nECU_Debug_Message_Set(&temp, error, nECU_ERROR_CAN_ID);
-        }
-}
 static void nECU_Debug_SPI_Check(void) // checks if SPI have any error pending
 {
     SPI_HandleTypeDef *hspi = nECU_SPI_getPointer(SPI_EGT_ID);
@@ -213,6 +203,31 @@ void nECU_Debug_FLASH_error(nECU_Flash_Error_ID ID, bool write_read) // indicate
     }
     nECU_Debug_Message_Set(&temporary, (float)HAL_GetTick(), id);
 }
+void nECU_Debug_CAN_Check(void) // checks if CAN have any error pending, reports new error passive and bus-off events
+{
+    if (nECU_FlowControl_Working_Check(D_CAN_TX) || nECU_FlowControl_Working_Check(D_CAN_RX)) // Check if RX or TX is working
+        if (nECU_CAN_GetError())
+        {
+            uint32_t error = HAL_CAN_GetError(&hcan1);
+            nECU_Debug_error_mesage temp;
+            nECU_Debug_Message_Set(&temp, error, nECU_ERROR_CAN_ID);
+        }
+
+    static uint32_t passive_reported = 0, busoff_reported = 0; // counters are only growing, report each event once
+    nECU_CAN_Health const *health = nECU_CAN_Health_getPointer();
+    if (health->passive_count != passive_reported)
+    {
+        passive_reported = health->passive_count;
+        nECU_Debug_error_mesage temp;
+        nECU_Debug_Message_Set(&temp, health->TEC, nECU_ERROR_CAN_PASSIVE_ID);
+    }
+    if (health->busoff_count != busoff_reported)
+    {
+        busoff_reported = health->busoff_count;
+        nECU_Debug_error_mesage temp;
+        nECU_Debug_Message_Set(&temp, health->TEC, nECU_ERROR_CAN_BUSOFF_ID);
+    }
+}
 
 /* Debug que and messages */
 static bool nECU_Debug_Init_Que(void) // initializes que
@@ -283,6 +298,10 @@ void nECU_Debug_Que_Read(nECU_Debug_error_mesage *message) // read newest messag
     dbg_data.error_que.counter.value--;
     dbg_data.error_que.message_count--;
 }
+nECU_Debug_error_que const *nECU_Debug_Que_getPointer(void) // returns pointer to debug que, messages are left in place
+{
+    return &(dbg_data.error_que);
+}
 static void nECU_Debug_Message_Init(nECU_Debug_error_mesage *inst) // zeros value inside of structure
 {
     inst->error_flag = false;
@@ -295,9 +314,6 @@ void nECU_Debug_Message_Set(nECU_Debug_error_mesage *inst, float value, nECU_Err
     inst->value_at_flag = value;
     inst->ID = ID;
     nECU_Debug_Que_Write(inst);
-    int8_t after_dot = ((int)round(value * 100) % 100);
-    if (after_dot < 0)
-        after_dot = -after_dot;
 
-    printf("New error written to Debug_Que. Value at flag %d.%d, ID: %d\n\r", (int)round(inst->value_at_flag), after_dot, inst->ID);
+    nECU_LOG("New error written to Debug_Que. Value at flag %.2f, ID: %d", nECU_Log_Float(inst->value_at_flag), inst->ID);
 }
@@ -156,11 +156,13 @@ static HAL_StatusTypeDef nECU_FLASH_cleanFlashSector(void) // clean flash sector
 {
     HAL_StatusTypeDef status = HAL_OK;
 
+    nECU_Watchdog_Hold(WATCHDOG_FLASH_ERASE_TIMEOUT); // CPU stalls on flash access until erase is done
     status |= HAL_FLASH_Unlock();
     FLASH_Erase_Sector(FLASH_SECTOR_11, FLASH_VOLTAGE_RANGE_3);
     FLASH_FlushCaches();
     status |= HAL_FLASH_Lock();
     status |= nECU_FLASH_cleanFlashSector_check();
+    nECU_Watchdog_Release();
 
     if (status != HAL_OK)
     {
@@ -7,14 +7,18 @@
  */
 
 #include "nECU_flowControl.h"
+#include "nECU_boot.h"
+#include "nECU_log.h"
 
 nECU_ProgramBlockData Debug_Status_List[D_ID_MAX] = {0}; // array of all nECU_ProgramBlockData variables
+nECU_FlowControl_Bitmap FlowControl_Bitmap = {0};         // packed copy of 'Status', read by inline checks
 
 static char const *const D_ID_Strings[D_ID_MAX] = {
     // nECU_adc.c
     [D_ADC1] = "ADC1",
     [D_ADC2] = "ADC2",
     [D_ADC3] = "ADC3",
+    [D_ADC1_Sync] = "ADC1 crank synchronous sampling",
     // nECU_button.c
     [D_Button_Red] = "Button RED",
     [D_Button_Orange] = "Button ORANGE",
@@ -38,6 +42,7 @@ static char const *const D_ID_Strings[D_ID_MAX] = {
     [D_Frame_Speed_ID] = "CAN Frame 0",
     [D_Frame_EGT_ID] = "CAN Frame 1",
     [D_Frame_Stock_ID] = "CAN Frame 2",
+    [D_Frame_Diag_ID] = "CAN Frame 3 (diagnostic)",
     // nECU_Input_Analog.c
     [D_ANALOG_MAP] = "Stock MAP",
     [D_ANALOG_BackPressure] = "BackPressure",
@@ -51,8 +56,12 @@ static char const *const D_ID_Strings[D_ID_MAX] = {
     [D_VSS] = "Stock VSS",
     [D_IGF] = "Stock Ignition Fault Detection",
     [D_Input_Frequency] = "Frequency Input",
+    // nECU_isotp.c
+    [D_ISOTP] = "ISO-TP over CAN",
     // nECU_Knock.c
     [D_Knock] = "Stock Knock sensing",
+    // nECU_log.c
+    [D_Log] = "Binary log over UART",
     // nECU_main.c
     [D_Main] = "Main Loop",
     // nECU_menu.c
@@ -62,6 +71,10 @@ static char const *const D_ID_Strings[D_ID_MAX] = {
     [D_OnboardLED] = "LED on PCB",
     // nECU_PC.c
     [D_PC] = "PC communication",
+    // nECU_scheduler.c
+    [D_Scheduler] = "Task scheduler",
+    // nECU_scope.c
+    [D_Scope] = "MAP and BackPressure burst capture",
     // nECU_Speed.c
     [D_ANALOG_SS1] = "ABS Speed Sensor 1",
     [D_ANALOG_SS2] = "ABS Speed Sensor 2",
@@ -83,6 +96,11 @@ static char const *const D_ID_Strings[D_ID_MAX] = {
     [D_TIM_FRAME] = "Frame Timer",
     [D_TIM_PWM_LED1] = "OnBoard LED1 Timer",
     [D_TIM_PWM_LED2] = "OnBoard LED2 Timer",
+    [D_TIM_CAN_TX] = "CAN TX Release Timer",
+    // nECU_watchdog.c
+    [D_Watchdog] = "Hardware watchdog manager",
+    // nECU_xcp.c
+    [D_XCP] = "XCP measurement and calibration",
 }; // List of strings of corresponding IDs
 
 /* Program Block */
@@ -91,16 +109,20 @@ void nECU_Debug_ProgramBlock_Init(void) // Initialize 'ProgramBlock' tracking
     // Initialize structures
     for (uint8_t index = 0; index < D_ID_MAX; index++)
     {
-        nECU_Debug_ProgramBlockData_Clear(&Debug_Status_List[index]);
+        nECU_Debug_ProgramBlockData_Clear(index);
     }
     // Configure timeout values
 }
-static void nECU_Debug_ProgramBlockData_Clear(nECU_ProgramBlockData *inst) // Clear structure 'ProgramBlockData'
+static void nECU_Debug_ProgramBlockData_Clear(nECU_Module_ID ID) // Clear structure 'ProgramBlockData'
 {
+    nECU_ProgramBlockData *inst = &Debug_Status_List[ID];
     memset(inst, 0, sizeof(nECU_ProgramBlockData));
-    inst->Status = D_BLOCK_STOP;
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_STOP, D_BLOCK_NULL);
     nECU_TickTrack_Init(&(inst->Update_ticks));
     inst->timeout_value = PROGRAMBLOCK_TIMEOUT_DEFAULT * (1000 / (inst->Update_ticks.convFactor));
+#if PROGRAMBLOCK_PROFILING == true
+    inst->profile.min = UINT32_MAX;
+#endif
 }
 void nECU_Debug_ProgramBlockData_Update(nECU_Module_ID ID) // Update tick tracking and check for timeout
 {
@@ -108,7 +130,7 @@ void nECU_Debug_ProgramBlockData_Update(nECU_Module_ID ID) // Update tick tracki
     nECU_TickTrack_Update(&(inst->Update_ticks));
     if (inst->Update_ticks.difference > inst->timeout_value)
     {
-        inst->Status |= D_BLOCK_ERROR;
+        nECU_FlowControl_Status_Change(ID, D_BLOCK_ERROR, D_BLOCK_NULL);
     }
 }
 void nECU_Debug_ProgramBlockData_Check(void) // Perform error check for all blocks
@@ -117,7 +139,7 @@ void nECU_Debug_ProgramBlockData_Check(void) // Perform error check for all bloc
     // Perform for each one
     for (uint8_t index = 0; index < D_ID_MAX; index++)
     {
-        single_result = nECU_Debug_ProgramBlockData_Check_Single(&Debug_Status_List[index]);
+        single_result = nECU_Debug_ProgramBlockData_Check_Single(index);
         if (single_result == 2) // save error if major
         {
             nECU_Debug_error_mesage temp;
@@ -133,7 +155,7 @@ void nECU_Debug_ProgramBlockData_Check(void) // Perform error check for all bloc
         }
     }
 }
-static uint8_t nECU_Debug_ProgramBlockData_Check_Single(nECU_ProgramBlockData *inst) // returns true if issue in given instance
+static uint8_t nECU_Debug_ProgramBlockData_Check_Single(nECU_Module_ID ID) // returns true if issue in given instance
 {
     /* Return value scheme:
         0 - OK
@@ -142,15 +164,14 @@ static uint8_t nECU_Debug_ProgramBlockData_Check_Single(nECU_ProgramBlockData *i
     */
     uint8_t result = 0;
 
-    if (inst->Status & D_BLOCK_ERROR)
+    if (nECU_FlowControl_Error_Check(ID))
     {
         result = 1;
-        if (inst->Status & D_BLOCK_ERROR_OLD) // if error was already in memor (major error)
+        if (nECU_FlowControl_DoubleError_Check(ID)) // if error was already in memor (major error)
         {
             result = 2;
         }
-        inst->Status |= D_BLOCK_ERROR_OLD; // store error to memory
-        inst->Status -= D_BLOCK_ERROR;
+        nECU_FlowControl_Status_Change(ID, D_BLOCK_ERROR_OLD, D_BLOCK_ERROR); // store error to memory
     }
 
     return result;
@@ -164,6 +185,59 @@ uint32_t *nECU_Debug_ProgramBlockData_getPointer_Diff(nECU_Module_ID ID) // retu
     return &(Debug_Status_List[ID].Update_ticks.difference);
 }
 
+#if PROGRAMBLOCK_PROFILING == true
+/* Program Block profiling */
+void nECU_Debug_ProgramBlock_Enter(nECU_Module_ID ID) // store cycle counter at start of routine
+{
+    if (ID >= D_ID_MAX) // Break if invalid ID
+        return;
+    Debug_Status_List[ID].profile.enter_cycles = nECU_CycleCounter_Get();
+}
+void nECU_Debug_ProgramBlock_Exit(nECU_Module_ID ID) // update execution time statistics at end of routine
+{
+    if (ID >= D_ID_MAX) // Break if invalid ID
+        return;
+
+    nECU_ProgramBlockProfile *inst = &(Debug_Status_List[ID].profile);
+    inst->last = nECU_CycleCounter_Get() - inst->enter_cycles;
+    if (inst->last < inst->min)
+        inst->min = inst->last;
+    if (inst->last > inst->max)
+        inst->max = inst->last;
+    inst->total += inst->last;
+    inst->count++;
+}
+void nECU_Debug_ProgramBlock_Report(void) // print measured blocks over UART, most time consuming first
+{
+    nECU_Module_ID order[D_ID_MAX];
+    uint8_t used = 0;
+
+    for (nECU_Module_ID ID = 0; ID < D_ID_MAX; ID++) // insertion sort by total time
+    {
+        if (Debug_Status_List[ID].profile.count == 0)
+            continue;
+
+        uint8_t index = used++;
+        while (index > 0 && Debug_Status_List[order[index - 1]].profile.total < Debug_Status_List[ID].profile.total)
+        {
+            order[index] = order[index - 1];
+            index--;
+        }
+        order[index] = ID;
+    }
+
+    printf("%-34s %10s %8s %8s %8s %8s\n\r", "Block", "calls", "last", "min", "mean", "max");
+    for (uint8_t index = 0; index < used; index++)
+    {
+        nECU_ProgramBlockProfile *inst = &(Debug_Status_List[order[index]].profile);
+        printf("%-34s %10lu %8lu %8lu %8lu %8lu\n\r", D_ID_Strings[order[index]], (unsigned long)inst->count,
+               (unsigned long)inst->last, (unsigned long)inst->min,
+               (unsigned long)(inst->total / inst->count), (unsigned long)inst->max);
+    }
+    printf("Times in CPU cycles (%lu per us).\n\r", (unsigned long)(SystemCoreClock / 1000000));
+}
+#endif
+
 /* Flow control
     ProgramBlock status has 9 states where each bit of byte represents one state:
         D_BLOCK_NULL = 0,        // Block was not initialized
@@ -195,127 +269,73 @@ uint32_t *nECU_Debug_ProgramBlockData_getPointer_Diff(nECU_Module_ID ID) // retu
 
     ProgramBlock cannot be started if it has active ERROR status.
 */
-bool nECU_FlowControl_Stop_Check(nECU_Module_ID ID) // Check if block has "initialized" status
-{
-    if (ID >= D_ID_MAX) // Break if invalid ID
-        return false;
-    return (bool)(Debug_Status_List[ID].Status & D_BLOCK_STOP);
-}
 bool nECU_FlowControl_Stop_Do(nECU_Module_ID ID) // Write "initialized" status if possible
 {
     if (ID >= D_ID_MAX) // Break if invalid ID
         return false;
 
-    switch (ID) /* Stopping of shared resources */
-    {
-    case D_ADC1:
-        if (nECU_FlowControl_Working_Check(D_ANALOG_MAP) || nECU_FlowControl_Working_Check(D_ANALOG_BackPressure) || nECU_FlowControl_Working_Check(D_ANALOG_OX) || nECU_FlowControl_Working_Check(D_ANALOG_AI_1) || nECU_FlowControl_Working_Check(D_ANALOG_AI_2) || nECU_FlowControl_Working_Check(D_ANALOG_AI_3) || nECU_FlowControl_Working_Check(D_ANALOG_MCUTemp) || nECU_FlowControl_Working_Check(D_ANALOG_VREF))
-            return false;
-        break;
-    case D_ADC2:
-        if (nECU_FlowControl_Working_Check(D_ANALOG_SS1) || nECU_FlowControl_Working_Check(D_ANALOG_SS2) || nECU_FlowControl_Working_Check(D_ANALOG_SS3) || nECU_FlowControl_Working_Check(D_ANALOG_SS4))
-            return false;
-        break;
-    case D_Flash:
-        if (nECU_FlowControl_Working_Check(D_ANALOG_SS1) || nECU_FlowControl_Working_Check(D_ANALOG_SS2) || nECU_FlowControl_Working_Check(D_ANALOG_SS3) || nECU_FlowControl_Working_Check(D_ANALOG_SS4) || nECU_FlowControl_Working_Check(D_Debug_Que) || nECU_FlowControl_Working_Check(D_Menu))
-            return false;
-        break;
-
-    default:
-        break;
-    }
+    if (nECU_Boot_isRequired(ID)) // shared resource still in use (dependencies are listed in nECU_boot.c)
+        return false;
 
-    if (nECU_FlowControl_Working_Check(D_PC))
-        printf("Stopping %s.\n\r", D_ID_Strings[ID]);
+    nECU_LOG("Stopping %M.", ID);
     if (nECU_FlowControl_Stop_Check(ID) || nECU_FlowControl_Working_Check(ID)) // check if already done
     {
         nECU_FlowControl_Error_Do(ID); // indicate error in code
         return false;
     }
-    Debug_Status_List[ID].Status &= ~D_BLOCK_WORKING; // Clear "STOP" flag
-    Debug_Status_List[ID].Status |= D_BLOCK_STOP;
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_STOP, D_BLOCK_WORKING); // Clear "WORKING" flag, add "STOP" flag
     return nECU_FlowControl_Initialize_Check(ID);
 }
 
-bool nECU_FlowControl_Initialize_Check(nECU_Module_ID ID) // Check if block has "initialized" status
-{
-    if (ID >= D_ID_MAX) // Break if invalid ID
-        return false;
-    return (bool)(Debug_Status_List[ID].Status & D_BLOCK_INITIALIZED);
-}
 bool nECU_FlowControl_Initialize_Do(nECU_Module_ID ID) // Write "initialized" status if possible
 {
     if (ID >= D_ID_MAX) // Break if invalid ID
         return false;
 
-    if (nECU_FlowControl_Working_Check(D_PC))
-        printf("\rInitializing %s.\n\r", D_ID_Strings[ID]);
+    nECU_LOG("Initializing %M.", ID);
     if (nECU_FlowControl_Initialize_Check(ID) || !nECU_FlowControl_Stop_Check(ID)) // check if already done
     {
         nECU_FlowControl_Error_Do(ID); // indicate error in code
         return false;
     }
 
-    Debug_Status_List[ID].Status &= ~D_BLOCK_STOP;       // Clear "STOP" flag
-    Debug_Status_List[ID].Status |= D_BLOCK_INITIALIZED; // Add "INITIALIZED" flag
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_INITIALIZED, D_BLOCK_STOP); // Clear "STOP" flag, add "INITIALIZED" flag
     return nECU_FlowControl_Initialize_Check(ID);
 }
 
-bool nECU_FlowControl_Working_Check(nECU_Module_ID ID) // Check if block has "working" status
-{
-    if (ID >= D_ID_MAX) // Break if invalid ID
-        return false;
-    return (bool)(Debug_Status_List[ID].Status & D_BLOCK_WORKING);
-}
 bool nECU_FlowControl_Working_Do(nECU_Module_ID ID) // Write "working" status if possible
 {
     if (ID >= D_ID_MAX) // Break if invalid ID
         return false;
 
-    if (nECU_FlowControl_Working_Check(D_PC))
-        printf("Starting %s.\n\r", D_ID_Strings[ID]);
+    nECU_LOG("Starting %M.", ID);
     if (nECU_FlowControl_Working_Check(ID) || !nECU_FlowControl_Initialize_Check(ID) || nECU_FlowControl_Error_Check(ID)) // check if already done or it is in error
     {
         nECU_FlowControl_Error_Do(ID); // indicate error in code
         return false;
     }
-    Debug_Status_List[ID].Status &= ~D_BLOCK_STOP;   // Clear "STOP" flag
-    Debug_Status_List[ID].Status |= D_BLOCK_WORKING; // Add "WORKING" flag
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_WORKING, D_BLOCK_STOP); // Clear "STOP" flag, add "WORKING" flag
     return nECU_FlowControl_Working_Check(ID);
 }
 
-bool nECU_FlowControl_Error_Check(nECU_Module_ID ID) // Check if block has "error" status
-{
-    if (ID >= D_ID_MAX) // Break if invalid ID
-        return false;
-    return (bool)(Debug_Status_List[ID].Status & D_BLOCK_ERROR);
-}
 bool nECU_FlowControl_Error_Do(nECU_Module_ID ID) // Write "error" status if possible
 {
     if (ID >= D_ID_MAX) // Break if invalid ID
         return false;
     if (nECU_FlowControl_Error_Check(ID) && !nECU_FlowControl_Initialize_Check(ID)) // check if already done
     {
-        if (nECU_FlowControl_Working_Check(D_PC))
-            printf("Error detected at %s - was not initialized.\n\r", D_ID_Strings[ID]);
+        nECU_LOG("Error detected at %M - was not initialized.", ID);
 
         // Perform action for error on non-initialized block
         return false; // indicate error in code
     }
-    if (nECU_FlowControl_Working_Check(D_PC))
-        printf("Error detected at %s - general error.\n\r", D_ID_Strings[ID]);
+    nECU_LOG("Error detected at %M - general error.", ID);
 
     // Debug_Status_List[ID].Status &= ~D_BLOCK_STOP;   // Clear "STOP" flag
-    Debug_Status_List[ID].Status |= D_BLOCK_ERROR; // Add "ERROR" flag
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_ERROR, D_BLOCK_NULL); // Add "ERROR" flag
     return nECU_FlowControl_Error_Check(ID);
 }
 
-bool nECU_FlowControl_DoubleError_Check(nECU_Module_ID ID) // Check if block has "error_old" status
-{
-    if (ID >= D_ID_MAX) // Break if invalid ID
-        return false;
-    return (bool)(Debug_Status_List[ID].Status & D_BLOCK_ERROR_OLD);
-}
 bool nECU_FlowControl_DoubleError_Do(nECU_Module_ID ID) // Write "error_old" status if possible
 {
     if (ID >= D_ID_MAX) // Break if invalid ID
@@ -331,7 +351,34 @@ bool nECU_FlowControl_DoubleError_Do(nECU_Module_ID ID) // Write "error_old" sta
         return false; // indicate error in code
     }
 
-    Debug_Status_List[ID].Status &= ~D_BLOCK_STOP;     // Clear "STOP" flag
-    Debug_Status_List[ID].Status |= D_BLOCK_ERROR_OLD; // Add "WORKING" flag
+    nECU_FlowControl_Status_Change(ID, D_BLOCK_ERROR_OLD, D_BLOCK_STOP); // Clear "STOP" flag, add "ERROR_OLD" flag
     return nECU_FlowControl_DoubleError_Check(ID);
-}
\ No newline at end of file
+}
+static void nECU_FlowControl_Status_Change(nECU_Module_ID ID, nECU_ProgramBlock_Status set, nECU_ProgramBlock_Status clear) // update status and its bitmaps as one step
+{
+    uint32_t word = ID / 32, bit = 1UL << (ID % 32);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // transitions are done from interrupts too, status and bitmaps have to agree
+    nECU_ProgramBlock_Status status = (Debug_Status_List[ID].Status & ~clear) | set;
+    Debug_Status_List[ID].Status = status;
+    nECU_FlowControl_Bitmap_Write(&FlowControl_Bitmap.stop[word], bit, status & D_BLOCK_STOP);
+    nECU_FlowControl_Bitmap_Write(&FlowControl_Bitmap.initialized[word], bit, status & D_BLOCK_INITIALIZED);
+    nECU_FlowControl_Bitmap_Write(&FlowControl_Bitmap.working[word], bit, status & D_BLOCK_WORKING);
+    nECU_FlowControl_Bitmap_Write(&FlowControl_Bitmap.error_old[word], bit, status & D_BLOCK_ERROR_OLD);
+    nECU_FlowControl_Bitmap_Write(&FlowControl_Bitmap.error[word], bit, status & D_BLOCK_ERROR);
+    __set_PRIMASK(primask);
+}
+static void nECU_FlowControl_Bitmap_Write(atomic_uint_least32_t *bitmap, uint32_t bit, bool value) // set or clear single bit of bitmap word
+{
+    if (value)
+        atomic_fetch_or_explicit(bitmap, bit, memory_order_release);
+    else
+        atomic_fetch_and_explicit(bitmap, ~bit, memory_order_release);
+}
+char const *nECU_FlowControl_getName(nECU_Module_ID ID) // returns printable name of block
+{
+    if (ID >= D_ID_MAX || D_ID_Strings[ID] == NULL) // Break if invalid ID
+        return "Unknown";
+    return D_ID_Strings[ID];
+}
@@ -10,6 +10,7 @@
 Frame0_struct F0_var = {0};
 Frame1_struct F1_var = {0};
 Frame2_struct F2_var = {0};
+Frame3_struct F3_var = {0};
 
 /* Frame 0 */
 bool Frame0_Start(void) // initialization of data structure
@@ -20,10 +21,7 @@ bool Frame0_Start(void) // initialization of data structure
     {
         // Start speed sensors
         for (nECU_ADC2_ID current_ID = 0; current_ID < ADC2_ID_MAX; current_ID++)
-        {
             status |= nECU_InputAnalog_ADC2_Start(ADC2_VSS_FL_ID + current_ID);
-            F0_var.SpeedSensor[current_ID] = 0;
-        }
 
         status |= nECU_Menu_Start();
         if (!status) // do only if no error
@@ -80,6 +78,19 @@ bool Frame0_Start(void) // initialization of data structure
         nECU_FlowControl_Error_Do(D_Frame_Speed_ID);
     return status;
 }
+bool Frame0_Stop(void) // stop updating frame data
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Frame_Speed_ID) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Frame_Speed_ID);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Frame_Speed_ID);
+
+    return status;
+}
 void Frame0_Routine(void) // update variables for frame 0
 {
     if (!nECU_FlowControl_Working_Check(D_Frame_Speed_ID))
@@ -88,56 +99,54 @@ void Frame0_Routine(void) // update variables for frame 0
         return;
     }
 
-    for (nECU_ADC2_ID current_ID = 0; current_ID < ADC2_ID_MAX; current_ID++) // Collect new data
-    {
-        nECU_InputAnalog_ADC2_Routine(D_ANALOG_SS1 + current_ID);
-        F0_var.SpeedSensor[current_ID] = nECU_FloatToUint(nECU_InputAnalog_ADC2_getValue(D_ANALOG_SS1 + current_ID), 12);
-    }
-
+    nECU_InputAnalog_ADC2_Routine_Batch(); // Collect new data
     nECU_DigitalInput_Routine(DigiInput_CRANKING_ID);
     nECU_DigitalInput_Routine(DigiInput_FAN_ON_ID);
     nECU_DigitalInput_Routine(DigiInput_LIGHTS_ON_ID);
     nECU_Tacho_Routine();
 
-    memset(F0_var.LunchControl, 0, LaunchControl_ID_MAX); // clear memory
-    if (*F0_var.LunchLvl > LaunchControl_OFF)             // Decode launch control level
+    bool LunchControl[LaunchControl_ID_MAX] = {0};
+    if (*F0_var.LunchLvl > LaunchControl_OFF) // Decode launch control level
     {
-        F0_var.LunchControl[LaunchControl_Low] = (*F0_var.LunchLvl < LaunchControl_Rolling); // Low is also launch control enable for all levels, must be on except rolling
-        F0_var.LunchControl[*F0_var.LunchLvl] = true;
+        LunchControl[LaunchControl_Low] = (*F0_var.LunchLvl < LaunchControl_Rolling); // Low is also launch control enable for all levels, must be on except rolling
+        LunchControl[*F0_var.LunchLvl] = true;
     }
 
-    nECU_Debug_ProgramBlockData_Update(D_Frame_Speed_ID);
-}
-void Frame0_PrepareBuffer(void) // prepare Tx buffer for CAN transmission
-{
-    if (!nECU_FlowControl_Working_Check(D_Frame_Speed_ID))
-    {
-        nECU_FlowControl_Error_Do(D_Frame_Speed_ID);
-        return;
-    }
-    Frame0_Routine();
+    // fill hidden set completely, frame composed meanwhile uses previous one
+    nECU_CAN_Speed_Signals *signals = nECU_Snapshot_Write_Begin(&F0_var.snapshot, F0_var.signals, sizeof(F0_var.signals[0]));
+    *signals = (nECU_CAN_Speed_Signals){
+        .IgnitionKey = *F0_var.IgnitionKey,
+        .Fan_ON = nECU_DigitalInput_getValue(DigiInput_FAN_ON_ID),
+        .Lights_ON = nECU_DigitalInput_getValue(DigiInput_LIGHTS_ON_ID),
+        .Cranking = nECU_DigitalInput_getValue(DigiInput_CRANKING_ID),
+        .VSS_FL = nECU_FloatToUint(nECU_InputAnalog_ADC2_getValue(ADC2_VSS_FL_ID), 12),
+        .ClearCode = *F0_var.ClearCode,
+        .TachoShow_MenuLvl = *F0_var.TachoShow[TACHO_ID_MenuLvl],
+        .TachoShow_LunchLvl = *F0_var.TachoShow[TACHO_ID_LunchLvl],
+        .TachoShow_TuneSel = *F0_var.TachoShow[TACHO_ID_TuneSel],
+        .VSS_FR = nECU_FloatToUint(nECU_InputAnalog_ADC2_getValue(ADC2_VSS_FR_ID), 12),
+        .Antilag = *F0_var.Antilag,
+        .Launch_High = LunchControl[LaunchControl_High],
+        .Launch_Medium = LunchControl[LaunchControl_Medium],
+        .Launch_Low = LunchControl[LaunchControl_Low],
+        .VSS_RL = nECU_FloatToUint(nECU_InputAnalog_ADC2_getValue(ADC2_VSS_RL_ID), 12),
+        .TractionOFF = *F0_var.TractionOFF,
+        .Launch_Rolling = LunchControl[LaunchControl_Rolling],
+        .VSS_RR = nECU_FloatToUint(nECU_InputAnalog_ADC2_getValue(ADC2_VSS_RR_ID), 12),
+    };
+    nECU_Snapshot_Write_End(&F0_var.snapshot);
 
-    F0_var.Stock_GPIO[DigiInput_CRANKING_ID] = nECU_DigitalInput_getValue(DigiInput_CRANKING_ID);
-    F0_var.Stock_GPIO[DigiInput_FAN_ON_ID] = nECU_DigitalInput_getValue(DigiInput_FAN_ON_ID);
-    F0_var.Stock_GPIO[DigiInput_LIGHTS_ON_ID] = nECU_DigitalInput_getValue(DigiInput_LIGHTS_ON_ID);
-
-    Frame0_ComposeWord(&F0_var.Buffer[0], F0_var.IgnitionKey, &F0_var.Stock_GPIO[DigiInput_FAN_ON_ID], &F0_var.Stock_GPIO[DigiInput_LIGHTS_ON_ID], &F0_var.Stock_GPIO[DigiInput_CRANKING_ID], &F0_var.SpeedSensor[ADC2_VSS_FL_ID]);
-    Frame0_ComposeWord(&F0_var.Buffer[2], F0_var.ClearCode, F0_var.TachoShow[TACHO_ID_MenuLvl], F0_var.TachoShow[TACHO_ID_LunchLvl], F0_var.TachoShow[TACHO_ID_TuneSel], &F0_var.SpeedSensor[ADC2_VSS_FR_ID]);
-    Frame0_ComposeWord(&F0_var.Buffer[4], F0_var.Antilag, &F0_var.LunchControl[LaunchControl_High], &F0_var.LunchControl[LaunchControl_Medium], &F0_var.LunchControl[LaunchControl_Low], &F0_var.SpeedSensor[ADC2_VSS_RL_ID]);
-    Frame0_ComposeWord(&F0_var.Buffer[6], (bool *)false, (bool *)false, F0_var.TractionOFF, &F0_var.LunchControl[LaunchControl_Rolling], &F0_var.SpeedSensor[ADC2_VSS_RR_ID]);
-    nECU_CAN_WriteToBuffer(CAN_TX_Speed_ID, sizeof(F0_var.Buffer));
+    nECU_Debug_ProgramBlockData_Update(D_Frame_Speed_ID);
 }
-static void Frame0_ComposeWord(uint8_t *buffer, bool *B1, bool *B2, bool *B3, bool *B4, uint16_t *Val12Bit) // function to create word for use in frame 0
+static uint8_t Frame0_Compose(uint8_t *buffer) // pack latest snapshot of frame 0, returns its length
 {
-    union Int16ToBytes Converter; // create memory union
-    Converter.UintValue = *Val12Bit;
+    nECU_CAN_Speed_Signals signals;
+    nECU_Snapshot_Read(&F0_var.snapshot, &signals, F0_var.signals, sizeof(signals));
+    signals.Counter = atomic_fetch_add(&F0_var.counter, 1); // compose counter, see Tools/nECU_can.dbc
+    F0_var.ClearCode_sent = signals.ClearCode;
 
-    buffer[1] = Converter.byteArray[0];
-    buffer[0] = Converter.byteArray[1] & 0xF;
-    buffer[0] |= (*B1 & 1) << 7;
-    buffer[0] |= (*B2 & 1) << 6;
-    buffer[0] |= (*B3 & 1) << 5;
-    buffer[0] |= (*B4 & 1) << 4;
+    nECU_CAN_Speed_Pack(buffer, &signals); // layout in Tools/nECU_can.dbc
+    return 8;
 }
 
 /* Frame 1 */
@@ -183,7 +192,6 @@ bool Frame1_Start(void) // initialization of data structure
     }
     if (!nECU_FlowControl_Working_Check(D_Frame_EGT_ID) && status == false)
     {
-        status |= nECU_EGT_Start();
         if (!status)
         {
             status |= !nECU_FlowControl_Working_Do(D_Frame_EGT_ID);
@@ -195,43 +203,52 @@ bool Frame1_Start(void) // initialization of data structure
     }
     return status;
 }
-void Frame1_Routine(void) // update variables for frame 1
+bool Frame1_Stop(void) // stop updating frame data
 {
-    if (!nECU_FlowControl_Working_Check(D_Frame_EGT_ID))
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Frame_EGT_ID) && status == false)
     {
-        nECU_FlowControl_Error_Do(D_Frame_EGT_ID);
-        return;
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Frame_EGT_ID);
     }
-    // nECU_EGT_RequestUpdate();
-    nECU_Tacho_Routine();
+    if (status)
+        nECU_FlowControl_Error_Do(D_Frame_EGT_ID);
 
-    nECU_Debug_ProgramBlockData_Update(D_Frame_EGT_ID);
+    return status;
 }
-void Frame1_PrepareBuffer(void) // prepare Tx buffer for CAN transmission
+void Frame1_Routine(void) // update variables for frame 1
 {
     if (!nECU_FlowControl_Working_Check(D_Frame_EGT_ID))
     {
         nECU_FlowControl_Error_Do(D_Frame_EGT_ID);
         return;
     }
-    Frame1_Routine();
-    Frame1_ComposeWord(&F1_var.Buffer[0], F1_var.TachoVal[TACHO_ID_TuneSel], F1_var.EGT[EGT1_ID]);
-    Frame1_ComposeWord(&F1_var.Buffer[2], F1_var.TachoVal[TACHO_ID_LunchLvl], F1_var.EGT[EGT2_ID]);
-    Frame1_ComposeWord(&F1_var.Buffer[4], F1_var.TachoVal[TACHO_ID_MenuLvl], F1_var.EGT[EGT3_ID]);
-    Frame1_ComposeWord(&F1_var.Buffer[6], (uint8_t *)F1_var.TuneSel, F1_var.EGT[EGT4_ID]);
-    nECU_CAN_WriteToBuffer(CAN_TX_EGT_ID, sizeof(F1_var.Buffer));
-    nECU_Tacho_Clear_getPointer(TACHO_ID_TuneSel);
-    nECU_Tacho_Clear_getPointer(TACHO_ID_LunchLvl);
-    nECU_Tacho_Clear_getPointer(TACHO_ID_MenuLvl);
+    // nECU_EGT_RequestUpdate();
+    nECU_Tacho_Routine();
+
+    // fill hidden set completely, frame composed meanwhile uses previous one
+    nECU_CAN_EGT_Signals *signals = nECU_Snapshot_Write_Begin(&F1_var.snapshot, F1_var.signals, sizeof(F1_var.signals[0]));
+    *signals = (nECU_CAN_EGT_Signals){
+        .Tacho_TuneSel = *F1_var.TachoVal[TACHO_ID_TuneSel],
+        .EGT1 = *F1_var.EGT[EGT1_ID],
+        .Tacho_LunchLvl = *F1_var.TachoVal[TACHO_ID_LunchLvl],
+        .EGT2 = *F1_var.EGT[EGT2_ID],
+        .Tacho_MenuLvl = *F1_var.TachoVal[TACHO_ID_MenuLvl],
+        .EGT3 = *F1_var.EGT[EGT3_ID],
+        .TuneSel = *F1_var.TuneSel,
+        .EGT4 = *F1_var.EGT[EGT4_ID],
+    };
+    nECU_Snapshot_Write_End(&F1_var.snapshot);
+
+    nECU_Debug_ProgramBlockData_Update(D_Frame_EGT_ID);
 }
-static void Frame1_ComposeWord(uint8_t *buffer, uint8_t *Val6Bit, uint16_t *Val10Bit) // function to create word for use in frame 1
+static uint8_t Frame1_Compose(uint8_t *buffer) // pack latest snapshot of frame 1, returns its length
 {
-    union Int16ToBytes Converter; // create memory union
-    Converter.UintValue = *Val10Bit;
+    nECU_CAN_EGT_Signals signals;
+    nECU_Snapshot_Read(&F1_var.snapshot, &signals, F1_var.signals, sizeof(signals)); // no free bits left for rolling counter
 
-    buffer[1] = Converter.byteArray[0];
-    buffer[0] = Converter.byteArray[1] & 0x3;
-    buffer[0] |= (*Val6Bit << 2) & 0xFC;
+    nECU_CAN_EGT_Pack(buffer, &signals); // layout in Tools/nECU_can.dbc
+    return 8;
 }
 
 /* Frame 2 */
@@ -278,6 +295,19 @@ bool Frame2_Start(void) // initialization of data structure
 
     return status;
 }
+bool Frame2_Stop(void) // stop updating frame data
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Frame_Stock_ID) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Frame_Stock_ID);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Frame_Stock_ID);
+
+    return status;
+}
 void Frame2_Routine(void) // update variables for frame 2
 {
     if (!nECU_FlowControl_Working_Check(D_Frame_Stock_ID))
@@ -287,76 +317,342 @@ void Frame2_Routine(void) // update variables for frame 2
     }
 
     nECU_OX_Routine(); // TODO
-    nECU_FreqInput_Routine(FREQ_VSS_ID);
-
-    nECU_InputAnalog_ADC1_Routine(ADC1_MAP_ID);
-    nECU_InputAnalog_ADC1_Routine(ADC1_BackPressure_ID);
-    nECU_InputAnalog_ADC1_Routine(ADC1_OX_ID);
+    nECU_FreqInput_Routine_Batch();
+    nECU_InputAnalog_ADC1_Routine_Batch();
+
+    // fill hidden set completely, frame composed meanwhile uses previous one
+    nECU_CAN_Stock_Signals *signals = nECU_Snapshot_Write_Begin(&F2_var.snapshot, F2_var.signals, sizeof(F2_var.signals[0]));
+    *signals = (nECU_CAN_Stock_Signals){
+        .MAP = nECU_CAN_Stock_MAP_Encode(nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_MAP_ID), 10)),
+        .OX = nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_OX_ID), 8),
+        .Backpressure = nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_BackPressure_ID), 8),
+        .Knock = *F2_var.Knock,
+        .VSS = nECU_FloatToUint(nECU_FreqInput_getValue(FREQ_VSS_ID), 8),
+        .LoopTime = (uint16_t)*F2_var.loop_time,
+    };
+    nECU_Snapshot_Write_End(&F2_var.snapshot);
 
     nECU_Debug_ProgramBlockData_Update(D_Frame_Stock_ID);
 }
-void Frame2_PrepareBuffer(void) // prepare Tx buffer for CAN transmission
+static uint8_t Frame2_Compose(uint8_t *buffer) // pack latest snapshot of frame 2, returns its length
 {
-    if (!nECU_FlowControl_Working_Check(D_Frame_Stock_ID))
+    nECU_CAN_Stock_Signals signals;
+    nECU_Snapshot_Read(&F2_var.snapshot, &signals, F2_var.signals, sizeof(signals));
+    signals.Overboost = nECU_ADC1_Protect_getFlag(ADC1_PROTECT_OVERBOOST_ID); // hardware limits, always current
+    signals.BackpressureLimit = nECU_ADC1_Protect_getFlag(ADC1_PROTECT_BACKPRESSURE_ID);
+    signals.Counter = atomic_fetch_add(&F2_var.counter, 1); // compose counter, see Tools/nECU_can.dbc
+
+    nECU_CAN_Stock_Pack(buffer, &signals); // layout in Tools/nECU_can.dbc
+    return 8;
+}
+
+/* Frame 3 */
+bool Frame3_Start(void) // initialization of data structure
+{
+    bool status = false;
+
+    if (!nECU_FlowControl_Initialize_Check(D_Frame_Diag_ID))
     {
-        nECU_FlowControl_Error_Do(D_Frame_Stock_ID);
-        return;
+        F3_var.page = 0;
+
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_Frame_Diag_ID);
     }
+    if (!nECU_FlowControl_Working_Check(D_Frame_Diag_ID) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_Frame_Diag_ID);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Frame_Diag_ID);
+
+    return status;
+}
+bool Frame3_Stop(void) // stop updating frame data
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Frame_Diag_ID) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Frame_Diag_ID);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Frame_Diag_ID);
+
+    return status;
+}
+static uint8_t Frame3_Compose(uint8_t *buffer) // pack current page of frame 3, returns its length
+{
+    memset(buffer, 0, 8);
+    buffer[0] = F3_var.page | (atomic_fetch_add(&F3_var.counter, 1) << 4); // multiplexer, rolling counter
+    switch (F3_var.page)
+    {
+    case FRAME3_PAGE_ADC1:
+    case FRAME3_PAGE_ADC2:
+    case FRAME3_PAGE_ADC3:
+        Frame3_ComposeADC(buffer, D_ADC1 + (F3_var.page - FRAME3_PAGE_ADC1));
+        break;
+    case FRAME3_PAGE_LOOP:
+        Frame3_ComposeLoop(buffer);
+        break;
+    case FRAME3_PAGE_CAN:
+        Frame3_ComposeCAN(buffer);
+        break;
+    default:
+        break;
+    }
+    return 8;
+}
+static void Frame3_ComposeADC(uint8_t *buffer, nECU_Module_ID ID) // fill page with DMA statistics of given ADC
+{
+    nECU_ADC_Stats *stats = nECU_ADC_Stats_getPointer(ID);
+    if (stats == NULL)
+        return;
 
-    Frame2_Routine();
     union Int16ToBytes Converter; // create memory union
+    buffer[1] = (stats->overflow_count > UINT8_MAX) ? UINT8_MAX : stats->overflow_count;
+    buffer[2] = (stats->overrun_count > UINT8_MAX) ? UINT8_MAX : stats->overrun_count;
+    Converter.UintValue = (stats->delay_max > UINT16_MAX) ? UINT16_MAX : stats->delay_max;
+    buffer[3] = Converter.byteArray[1];
+    buffer[4] = Converter.byteArray[0];
+    Converter.UintValue = (uint16_t)(stats->half_count + stats->full_count); // rolls over, rate is what matters
+    buffer[5] = Converter.byteArray[1];
+    buffer[6] = Converter.byteArray[0];
+}
 
-    F2_var.MAP_Stock_10bit = nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_MAP_ID), 10);
-    F2_var.Backpressure = nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_BackPressure_ID), 8);
-    F2_var.OX_Val = nECU_FloatToUint(nECU_InputAnalog_ADC1_getValue(ADC1_OX_ID), 8);
-    // F2_var.OX_Val = 0;
-    float temp = nECU_FreqInput_getValue(FREQ_VSS_ID);
-    F2_var.VSS = nECU_FloatToUint(temp, 8);
+static void Frame3_ComposeLoop(uint8_t *buffer) // fill page with main loop timing
+{
+    nECU_LoopStats *loop = nECU_Loop_getPointer();
+    union Int16ToBytes Converter; // create memory union
+
+    Converter.UintValue = loop->load;
+    buffer[1] = Converter.byteArray[1];
+    buffer[2] = Converter.byteArray[0];
+    uint32_t period_max = nECU_Loop_getPeriodMax(LOOP_READER_FRAME);
+    Converter.UintValue = (period_max > UINT16_MAX) ? UINT16_MAX : period_max;
+    buffer[3] = Converter.byteArray[1];
+    buffer[4] = Converter.byteArray[0];
 
-    Converter.UintValue = F2_var.MAP_Stock_10bit + FRAME_MAP_OFFSET;
-    if (Converter.UintValue > MAX_VAL_10BIT) // round if out of bound
+    uint32_t slow = 0;
+    for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++)
     {
-        Converter.UintValue = MAX_VAL_10BIT;
+        if (loop->histogram[bucket] == 0)
+            continue;
+        buffer[5] = bucket; // highest used bucket
+        if (bucket >= LOOP_SLOW_BUCKET)
+            slow += loop->histogram[bucket];
     }
-    F2_var.Buffer[0] = Converter.byteArray[1] & 0x3; // 6bit value left;
-    F2_var.Buffer[1] = Converter.byteArray[0];
-    F2_var.Buffer[2] = F2_var.OX_Val;
-    F2_var.Buffer[3] = F2_var.Backpressure;
-    F2_var.Buffer[4] = *F2_var.Knock;
-    F2_var.Buffer[5] = F2_var.VSS;
-    Converter.UintValue = (uint16_t)*F2_var.loop_time;
-    F2_var.Buffer[6] = Converter.byteArray[1]; // spare
-    F2_var.Buffer[7] = Converter.byteArray[0]; // spare
-    nECU_CAN_WriteToBuffer(CAN_TX_Stock_ID, sizeof(F2_var.Buffer));
+    Converter.UintValue = (slow > UINT16_MAX) ? UINT16_MAX : slow;
+    buffer[6] = Converter.byteArray[1];
+    buffer[7] = Converter.byteArray[0];
+}
+static void Frame3_ComposeCAN(uint8_t *buffer) // fill page with CAN bus health
+{
+    nECU_CAN_Health *health = nECU_CAN_Health_getPointer();
+    union Int16ToBytes Converter; // create memory union
+
+    buffer[1] = health->TEC;
+    buffer[2] = health->REC;
+    buffer[3] = health->state | (health->LEC << 4);
+    Converter.UintValue = health->load;
+    buffer[4] = Converter.byteArray[1];
+    buffer[5] = Converter.byteArray[0];
+    buffer[6] = (health->busoff_count > UINT8_MAX) ? UINT8_MAX : health->busoff_count;
+    uint32_t latency = health->latency_max[0];
+    for (uint8_t mailbox = 1; mailbox < 3; mailbox++)
+        if (health->latency_max[mailbox] > latency)
+            latency = health->latency_max[mailbox];
+    latency /= 100;
+    buffer[7] = (latency > UINT8_MAX) ? UINT8_MAX : latency;
 }
 
-void nECU_Frame_TX_done(nECU_CAN_TX_Frame_ID ID) // callback after can TX is done
+void nECU_Frame_Protection_Callback(nECU_ADC1_Protect_ID ID) // called from interrupt when hardware limit was exceeded
 {
-    if (ID >= CAN_TX_ID_MAX) // Break if invalid ID
+    if (ID >= ADC1_PROTECT_ID_MAX) // Break if invalid ID
+        return;
+    if (!nECU_FlowControl_Working_Check(D_Frame_Stock_ID))
         return;
-    if (ID == CAN_TX_Speed_ID)
-        F0_var.ClearCode = false;
+
+    nECU_CAN_TX_TransmitUrgent(CAN_TX_Stock_ID, FRAME2_PROTECT_BYTE, FRAME2_PROTECT_BIT(ID));
 }
-uint8_t *nECU_Frame_getPointer(nECU_CAN_TX_Frame_ID ID) // returns pointer to output buffer
+void nECU_Frame_TX_done(nECU_CAN_TX_Frame_ID ID) // callback after frame was released for transmission, advances state consumed by it
 {
     if (ID >= CAN_TX_ID_MAX) // Break if invalid ID
-        return NULL;
-
+        return;
+    if (ID == CAN_TX_Speed_ID && F0_var.ClearCode_sent) // clear only request that was sent, not one raised after snapshot
+        *F0_var.ClearCode = false;
+    if (ID == CAN_TX_EGT_ID) // tacho values were shown
+    {
+        nECU_Tacho_Clear_getPointer(TACHO_ID_TuneSel);
+        nECU_Tacho_Clear_getPointer(TACHO_ID_LunchLvl);
+        nECU_Tacho_Clear_getPointer(TACHO_ID_MenuLvl);
+    }
+    if (ID == CAN_TX_Diag_ID) // next page
+    {
+        F3_var.page = (F3_var.page + 1) % FRAME3_PAGE_MAX;
+        nECU_Debug_ProgramBlockData_Update(D_Frame_Diag_ID);
+    }
+}
+uint8_t nECU_Frame_Compose(nECU_CAN_TX_Frame_ID ID, uint8_t *buffer) // pack latest data of given frame straight into CAN buffer, returns its length (called from interrupt)
+{
     switch (ID)
     {
     case CAN_TX_Speed_ID:
-        return F0_var.Buffer;
-        break;
+        return Frame0_Compose(buffer);
     case CAN_TX_EGT_ID:
-        return F1_var.Buffer;
-        break;
+        return Frame1_Compose(buffer);
     case CAN_TX_Stock_ID:
-        return F2_var.Buffer;
-        break;
-
+        return Frame2_Compose(buffer);
+    case CAN_TX_Diag_ID:
+        return Frame3_Compose(buffer);
     default:
-        return NULL;
-        break;
+        return 0;
+    }
+}
+/* Test */
+static uint32_t nECU_Frame_test_Random(uint32_t *state) // xorshift generator of test inputs
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+static void nECU_Frame_test_Legacy0(uint8_t *buffer, bool B1, bool B2, bool B3, bool B4, uint16_t Val12Bit) // hand written word of frame 0, reference for generated packing
+{
+    union Int16ToBytes Converter; // create memory union
+    Converter.UintValue = Val12Bit;
+
+    buffer[1] = Converter.byteArray[0];
+    buffer[0] = Converter.byteArray[1] & 0xF;
+    buffer[0] |= (B1 & 1) << 7;
+    buffer[0] |= (B2 & 1) << 6;
+    buffer[0] |= (B3 & 1) << 5;
+    buffer[0] |= (B4 & 1) << 4;
+}
+static void nECU_Frame_test_Legacy1(uint8_t *buffer, uint8_t Val6Bit, uint16_t Val10Bit) // hand written word of frame 1, reference for generated packing
+{
+    union Int16ToBytes Converter; // create memory union
+    Converter.UintValue = Val10Bit;
+
+    buffer[1] = Converter.byteArray[0];
+    buffer[0] = Converter.byteArray[1] & 0x3;
+    buffer[0] |= (Val6Bit << 2) & 0xFC;
+}
+static void nECU_Frame_test_Legacy2(uint8_t *buffer, nECU_CAN_Stock_Signals const *signals, uint16_t MAP) // hand written frame 2, reference for generated packing
+{
+    union Int16ToBytes Converter; // create memory union
+    Converter.UintValue = MAP - 100;
+    if (Converter.UintValue > 1023) // round if out of bound
+        Converter.UintValue = 1023;
+    buffer[0] = Converter.byteArray[1] & 0x3;
+    buffer[0] |= (signals->Overboost << 7) | (signals->BackpressureLimit << 6);
+    buffer[0] |= (signals->Counter & 0xF) << 2;
+    buffer[1] = Converter.byteArray[0];
+    buffer[2] = signals->OX;
+    buffer[3] = signals->Backpressure;
+    buffer[4] = signals->Knock;
+    buffer[5] = signals->VSS;
+    Converter.UintValue = signals->LoopTime;
+    buffer[6] = Converter.byteArray[1];
+    buffer[7] = Converter.byteArray[0];
+}
+bool nECU_Frame_test(bool logging_enable) // Run test, compares generated packing with hand written one
+{
+    if (logging_enable)
+        printf("Started test of nECU_frames.c\n\r");
+
+    nECU_CycleCounter_Init();
+    uint32_t seed = 0x12345678, cycles_legacy = 0, cycles_generated = 0;
+    for (uint16_t round = 0; round < FRAME_TEST_ROUNDS; round++)
+    {
+        uint32_t random = nECU_Frame_test_Random(&seed);
+        uint8_t legacy[3][8], generated[3][8];
+
+        nECU_CAN_Speed_Signals speed = {0};
+        uint8_t *const flag_List[] = {&speed.IgnitionKey, &speed.Fan_ON, &speed.Lights_ON, &speed.Cranking,
+                                      &speed.ClearCode, &speed.TachoShow_MenuLvl, &speed.TachoShow_LunchLvl, &speed.TachoShow_TuneSel,
+                                      &speed.Antilag, &speed.Launch_High, &speed.Launch_Medium, &speed.Launch_Low,
+                                      &speed.TractionOFF, &speed.Launch_Rolling};
+        for (uint8_t index = 0; index < sizeof(flag_List) / sizeof(flag_List[0]); index++)
+            *flag_List[index] = (random >> index) & 1; // single bit signals are set by bits of 'random'
+        speed.VSS_FL = nECU_Frame_test_Random(&seed) & 0xFFF;
+        speed.VSS_FR = nECU_Frame_test_Random(&seed) & 0xFFF;
+        speed.VSS_RL = nECU_Frame_test_Random(&seed) & 0xFFF;
+        speed.VSS_RR = nECU_Frame_test_Random(&seed) & 0xFFF;
+        speed.Counter = (random >> 14) & 0x3; // bits above flags
+
+        nECU_CAN_EGT_Signals EGT = {
+            .Tacho_TuneSel = random & 0x3F,
+            .Tacho_LunchLvl = (random >> 6) & 0x3F,
+            .Tacho_MenuLvl = (random >> 12) & 0x3F,
+            .TuneSel = (random >> 18) & 0x3F,
+            .EGT1 = nECU_Frame_test_Random(&seed) & 0x3FF,
+            .EGT2 = nECU_Frame_test_Random(&seed) & 0x3FF,
+            .EGT3 = nECU_Frame_test_Random(&seed) & 0x3FF,
+            .EGT4 = nECU_Frame_test_Random(&seed) & 0x3FF,
+        };
+
+        uint16_t MAP = nECU_Frame_test_Random(&seed) & 0x7FF;
+        if (MAP < 100) // hand written code wrapped around below offset, generated one saturates
+            MAP += 100;
+        random = nECU_Frame_test_Random(&seed);
+        nECU_CAN_Stock_Signals stock = {
+            .Overboost = random & 1,
+            .BackpressureLimit = (random >> 1) & 1,
+            .MAP = nECU_CAN_Stock_MAP_Encode(MAP),
+            .OX = random >> 8,
+            .Backpressure = random >> 16,
+            .Knock = random >> 24,
+            .VSS = random >> 4,
+            .LoopTime = nECU_Frame_test_Random(&seed),
+            .Counter = (random >> 2) & 0xF,
+        };
+
+        uint32_t start = nECU_CycleCounter_Get();
+        nECU_Frame_test_Legacy0(&legacy[0][0], speed.IgnitionKey, speed.Fan_ON, speed.Lights_ON, speed.Cranking, speed.VSS_FL);
+        nECU_Frame_test_Legacy0(&legacy[0][2], speed.ClearCode, speed.TachoShow_MenuLvl, speed.TachoShow_LunchLvl, speed.TachoShow_TuneSel, speed.VSS_FR);
+        nECU_Frame_test_Legacy0(&legacy[0][4], speed.Antilag, speed.Launch_High, speed.Launch_Medium, speed.Launch_Low, speed.VSS_RL);
+        nECU_Frame_test_Legacy0(&legacy[0][6], (speed.Counter >> 1) & 1, speed.Counter & 1, speed.TractionOFF, speed.Launch_Rolling, speed.VSS_RR);
+        nECU_Frame_test_Legacy1(&legacy[1][0], EGT.Tacho_TuneSel, EGT.EGT1);
+        nECU_Frame_test_Legacy1(&legacy[1][2], EGT.Tacho_LunchLvl, EGT.EGT2);
+        nECU_Frame_test_Legacy1(&legacy[1][4], EGT.Tacho_MenuLvl, EGT.EGT3);
+        nECU_Frame_test_Legacy1(&legacy[1][6], EGT.TuneSel, EGT.EGT4);
+        nECU_Frame_test_Legacy2(legacy[2], &stock, MAP);
+        cycles_legacy += nECU_CycleCounter_Get() - start;
+
+        start = nECU_CycleCounter_Get();
+        nECU_CAN_Speed_Pack(generated[0], &speed);
+        nECU_CAN_EGT_Pack(generated[1], &EGT);
+        nECU_CAN_Stock_Pack(generated[2], &stock);
+        cycles_generated += nECU_CycleCounter_Get() - start;
+
+        if (memcmp(legacy, generated, sizeof(legacy)))
+        {
+            if (logging_enable)
+                printf("\n\rFAIL on packing, round %u\n\r", round);
+            return false;
+        }
+
+        nECU_CAN_Speed_Signals speed_back = {0};
+        nECU_CAN_EGT_Signals EGT_back = {0};
+        nECU_CAN_Stock_Signals stock_back = {0};
+        nECU_CAN_Speed_Unpack(&speed_back, generated[0]);
+        nECU_CAN_EGT_Unpack(&EGT_back, generated[1]);
+        nECU_CAN_Stock_Unpack(&stock_back, generated[2]);
+        if (memcmp(&speed_back, &speed, sizeof(speed)) || memcmp(&EGT_back, &EGT, sizeof(EGT)) || memcmp(&stock_back, &stock, sizeof(stock)) ||
+            nECU_CAN_Stock_MAP_Decode(stock_back.MAP) != ((MAP > 1123) ? 1123 : MAP))
+        {
+            if (logging_enable)
+                printf("\n\rFAIL on unpacking, round %u\n\r", round);
+            return false;
+        }
     }
-    return NULL;
-}
\ No newline at end of file
+
+    if (logging_enable)
+    {
+        printf("Packing of frames 0-2 [cycles]: hand written %lu, generated %lu\n\r",
+               (unsigned long)(cycles_legacy / FRAME_TEST_ROUNDS), (unsigned long)(cycles_generated / FRAME_TEST_ROUNDS));
+        printf("OK\n\r");
+    }
+    return true;
+}
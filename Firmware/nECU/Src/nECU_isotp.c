@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ * @file    nECU_isotp.c
+ * @brief   This file provides code for ISO-TP (ISO 15765-2) transport over CAN.
+ *          Link of nECU_isotp_link.c is driven by CAN interrupts, flow control
+ *          of receiver limits block size and separation time.
+ *          Requests of tester are answered with bulk data (debug que,
+ *          calibration page).
+ ******************************************************************************
+ */
+
+#include "nECU_isotp.h"
+
+static nECU_ISOTP_Link ISOTP_Link = {0};
+static uint8_t ISOTP_RX_Buffer[ISOTP_RX_BUF_LEN];
+static uint8_t ISOTP_Response[ISOTP_RESPONSE_LEN]; // sent by link, untouched until it is done
+
+/* General functions */
+bool nECU_ISOTP_Start(void) // prepare link on 'hcan1'
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_ISOTP))
+    {
+        nECU_ISOTP_Link_Init(&ISOTP_Link, ISOTP_TX_ID, ISOTP_RX_ID, nECU_ISOTP_CAN_Send, ISOTP_RX_Buffer, sizeof(ISOTP_RX_Buffer));
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_ISOTP);
+    }
+    if (!nECU_FlowControl_Working_Check(D_ISOTP) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_ISOTP);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_ISOTP);
+
+    return status;
+}
+bool nECU_ISOTP_Stop(void) // abort transfers and stop link
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_ISOTP) && status == false)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq(); // link is used by CAN interrupts
+        nECU_ISOTP_Link_Abort(&ISOTP_Link);
+        __set_PRIMASK(primask);
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_ISOTP);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_ISOTP);
+
+    return status;
+}
+void nECU_ISOTP_Routine(void) // separation time and timeouts, call periodically
+{
+    if (!nECU_FlowControl_Working_Check(D_ISOTP))
+        return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // link is used by CAN interrupts
+    nECU_ISOTP_Link_Timeout(&ISOTP_Link);
+    nECU_ISOTP_Link_Continue(&ISOTP_Link); // frames held back by separation time or full queue
+    __set_PRIMASK(primask);
+
+    if (!nECU_ISOTP_isBusy()) // previous response is done, buffer can be reused
+        nECU_ISOTP_Service();
+
+    nECU_Debug_ProgramBlockData_Update(D_ISOTP);
+}
+bool nECU_ISOTP_Send(uint8_t const *data, uint16_t length) // start sending message, buffer has to stay valid until done, returns true if busy or invalid
+{
+    if (!nECU_FlowControl_Working_Check(D_ISOTP))
+        return true;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // link is used by CAN interrupts
+    bool status = nECU_ISOTP_Link_Send(&ISOTP_Link, data, length);
+    __set_PRIMASK(primask);
+    return status;
+}
+bool nECU_ISOTP_isBusy(void) // returns true while message is being sent
+{
+    return ISOTP_Link.tx_state != ISOTP_STATE_IDLE;
+}
+uint16_t nECU_ISOTP_Receive(uint8_t *data, uint16_t size) // copy last received message, returns its length or 0 if none is waiting
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // next message could overwrite buffer
+    uint16_t length = ISOTP_Link.rx_done;
+    if (length > size)
+        length = size;
+    memcpy(data, ISOTP_Link.rx_buffer, length);
+    ISOTP_Link.rx_done = 0;
+    __set_PRIMASK(primask);
+    return length;
+}
+void nECU_ISOTP_RX_Handler(nECU_CAN_RX_Frame_ID ID, uint8_t const *data, uint8_t length) // frame from 'ISOTP_RX_ID' received (called from interrupt)
+{
+    UNUSED(ID);
+    if (!nECU_FlowControl_Working_Check(D_ISOTP))
+        return;
+    nECU_ISOTP_Link_Frame(&ISOTP_Link, data, length);
+}
+void nECU_ISOTP_TX_Callback(void) // CAN mailbox became free (called from interrupt)
+{
+    if (!nECU_FlowControl_Working_Check(D_ISOTP))
+        return;
+    nECU_ISOTP_Link_Continue(&ISOTP_Link);
+}
+static bool nECU_ISOTP_CAN_Send(uint32_t ID, uint8_t const *data) // output of link to 'hcan1' TX queue
+{
+    return nECU_CAN_TX_Send(ID, data, 8);
+}
+
+static void nECU_ISOTP_Service(void) // answer request received on link, once previous response is sent
+{
+    uint8_t request[ISOTP_RX_BUF_LEN];
+    uint16_t length = nECU_ISOTP_Receive(request, sizeof(request));
+    if (length == 0) // nothing requested
+        return;
+
+    void const *source = NULL;
+    uint16_t size = 0;
+    switch (request[0])
+    {
+    case ISOTP_SERVICE_DEBUG_QUE:
+        source = nECU_Debug_Que_getPointer();
+        size = sizeof(nECU_Debug_error_que);
+        break;
+    case ISOTP_SERVICE_CALIBRATION:
+        source = nECU_Calibration_get();
+        size = sizeof(nECU_Calibration);
+        break;
+    default:
+        break;
+    }
+
+    if (source == NULL || (size + 1) > sizeof(ISOTP_Response)) // unknown service or data does not fit
+    {
+        ISOTP_Response[0] = ISOTP_SERVICE_NEGATIVE;
+        ISOTP_Response[1] = request[0];
+        nECU_ISOTP_Send(ISOTP_Response, 2);
+        return;
+    }
+    ISOTP_Response[0] = request[0] | ISOTP_SERVICE_POSITIVE;
+    memcpy(&ISOTP_Response[1], source, size);
+    nECU_ISOTP_Send(ISOTP_Response, size + 1);
+}
+
+/* Test */
+static struct
+{
+    uint32_t ID[ISOTP_TEST_BUS_LEN];
+    uint8_t data[ISOTP_TEST_BUS_LEN][8];
+    uint8_t count;
+} ISOTP_Test_Bus; // frames on virtual bus, delivered in order by 'nECU_ISOTP_test_Bus_Run'
+
+static bool nECU_ISOTP_test_Bus_Send(uint32_t ID, uint8_t const *data) // virtual bus output of test links
+{
+    if (ISOTP_Test_Bus.count >= ISOTP_TEST_BUS_LEN)
+        return true; // like full TX queue, sender retries on next TX callback
+    ISOTP_Test_Bus.ID[ISOTP_Test_Bus.count] = ID;
+    memcpy(ISOTP_Test_Bus.data[ISOTP_Test_Bus.count], data, 8);
+    ISOTP_Test_Bus.count++;
+    return false;
+}
+static bool nECU_ISOTP_test_Bus_Run(nECU_ISOTP_Link *A, nECU_ISOTP_Link *B) // deliver frames until bus is quiet, returns false if it never settles
+{
+    for (uint16_t frames = 0; frames < 1000; frames++)
+    {
+        if (ISOTP_Test_Bus.count == 0)
+            return true;
+
+        uint32_t ID = ISOTP_Test_Bus.ID[0];
+        uint8_t data[8];
+        memcpy(data, ISOTP_Test_Bus.data[0], sizeof(data));
+        ISOTP_Test_Bus.count--;
+        memmove(&ISOTP_Test_Bus.ID[0], &ISOTP_Test_Bus.ID[1], ISOTP_Test_Bus.count * sizeof(ISOTP_Test_Bus.ID[0]));
+        memmove(ISOTP_Test_Bus.data[0], ISOTP_Test_Bus.data[1], ISOTP_Test_Bus.count * sizeof(ISOTP_Test_Bus.data[0]));
+
+        nECU_ISOTP_Link *receiver = (ID == A->rx_ID) ? A : B;
+        nECU_ISOTP_Link *sender = (ID == A->rx_ID) ? B : A;
+        nECU_ISOTP_Link_Frame(receiver, data, sizeof(data));
+        nECU_ISOTP_Link_Continue(sender); // frame left the bus, like TX mailbox interrupt
+    }
+    return false;
+}
+bool nECU_ISOTP_test(bool logging_enable) // Run test
+{
+    if (logging_enable)
+        printf("Started test of nECU_isotp.c\n\r");
+
+    nECU_CycleCounter_Init();
+    static nECU_ISOTP_Link A, B;
+    static uint8_t A_buffer[16], B_buffer[ISOTP_TEST_MESSAGE], message[ISOTP_TEST_MESSAGE];
+    for (uint16_t index = 0; index < sizeof(message); index++)
+        message[index] = index * 7;
+    memset(&ISOTP_Test_Bus, 0, sizeof(ISOTP_Test_Bus));
+    nECU_ISOTP_Link_Init(&A, 0x7E0, 0x7E8, nECU_ISOTP_test_Bus_Send, A_buffer, sizeof(A_buffer));
+    nECU_ISOTP_Link_Init(&B, 0x7E8, 0x7E0, nECU_ISOTP_test_Bus_Send, B_buffer, sizeof(B_buffer));
+    B.block_size = 4; // flow control after every 4 frames
+
+    // single frame
+    if (nECU_ISOTP_Link_Send(&A, message, 5) || !nECU_ISOTP_test_Bus_Run(&A, &B) || B.rx_done != 5 || memcmp(B_buffer, message, 5))
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on single frame\n\r");
+        return false;
+    }
+
+    // segmented, sequence number wraps and receiver limits block size
+    memset(B_buffer, 0, sizeof(B_buffer));
+    if (nECU_ISOTP_Link_Send(&A, message, sizeof(message)) || !nECU_ISOTP_test_Bus_Run(&A, &B) ||
+        A.tx_state != ISOTP_STATE_IDLE || B.rx_done != sizeof(message) || memcmp(B_buffer, message, sizeof(message)))
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on segmented message\n\r");
+        return false;
+    }
+
+    // receiver buffer too small, sender gives up after overflow flow control
+    if (nECU_ISOTP_Link_Send(&B, message, 100) || !nECU_ISOTP_test_Bus_Run(&A, &B) ||
+        B.tx_state != ISOTP_STATE_IDLE || A.error_count != 1 || B.error_count != 1)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on overflow\n\r");
+        return false;
+    }
+
+    // busy link refuses second message
+    if (nECU_ISOTP_Link_Send(&A, message, sizeof(message)) || !nECU_ISOTP_Link_Send(&A, message, 10))
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on busy link\n\r");
+        return false;
+    }
+    nECU_ISOTP_test_Bus_Run(&A, &B);
+
+    if (A.tx_count != 3 || B.rx_count != 3)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on message count\n\r");
+        return false;
+    }
+
+    if (logging_enable)
+        printf("OK\n\r");
+    return true;
+}
@@ -0,0 +1,239 @@
+/**
+ ******************************************************************************
+ * @file    nECU_isotp_link.c
+ * @brief   This file provides code for ISO-TP (ISO 15765-2) link layer.
+ *          Link splits and joins messages on any bus given by send function,
+ *          it depends only on tick and cycle counter, so it can be built for
+ *          host (Tools/nECU_isotp_loopback.c).
+ ******************************************************************************
+ */
+
+#include "nECU_isotp_link.h"
+
+/* Link functions, work on any bus */
+void nECU_ISOTP_Link_Init(nECU_ISOTP_Link *link, uint32_t tx_ID, uint32_t rx_ID, bool (*send)(uint32_t, uint8_t const *), uint8_t *rx_buffer, uint16_t rx_size) // prepare link structure
+{
+    memset(link, 0, sizeof(*link));
+    link->tx_ID = tx_ID;
+    link->rx_ID = rx_ID;
+    link->send = send;
+    link->rx_buffer = rx_buffer;
+    link->rx_size = rx_size;
+    link->block_size = ISOTP_BLOCK_SIZE;
+    link->STmin = ISOTP_STMIN;
+}
+bool nECU_ISOTP_Link_Send(nECU_ISOTP_Link *link, uint8_t const *data, uint16_t length) // start sending message, returns true if busy or invalid
+{
+    if (link->tx_state != ISOTP_STATE_IDLE || length == 0 || length > ISOTP_MESSAGE_MAX)
+        return true;
+
+    uint8_t frame[8];
+    memset(frame, ISOTP_PADDING, sizeof(frame));
+    if (length <= 7) // fits single frame
+    {
+        frame[0] = (ISOTP_PCI_SINGLE << 4) | length;
+        memcpy(&frame[1], data, length);
+        if (link->send(link->tx_ID, frame))
+            return true;
+        link->tx_count++;
+        return false;
+    }
+
+    frame[0] = (ISOTP_PCI_FIRST << 4) | (length >> 8);
+    frame[1] = length & 0xFF;
+    memcpy(&frame[2], data, 6);
+    if (link->send(link->tx_ID, frame))
+        return true;
+
+    link->tx_data = data;
+    link->tx_length = length;
+    link->tx_offset = 6;
+    link->tx_sequence = 1;
+    link->tx_tick = HAL_GetTick();
+    link->tx_state = ISOTP_STATE_WAIT_FC;
+    return false;
+}
+void nECU_ISOTP_Link_Frame(nECU_ISOTP_Link *link, uint8_t const *data, uint8_t length) // process received frame
+{
+    if (length == 0)
+        return;
+
+    switch (data[0] >> 4)
+    {
+    case ISOTP_PCI_FLOW:
+        if (link->tx_state != ISOTP_STATE_WAIT_FC || length < 3)
+            break;
+        switch (data[0] & 0xF)
+        {
+        case ISOTP_FLOW_CTS:
+            link->tx_block_left = data[1];
+            link->tx_STmin = nECU_ISOTP_STmin_toUs(data[2]);
+            link->tx_last_cycles = nECU_CycleCounter_Get() - ((link->tx_STmin + 1) * (SystemCoreClock / 1000000)); // first frame of block goes right away
+            link->tx_state = ISOTP_STATE_SENDING;
+            nECU_ISOTP_Link_Continue(link);
+            break;
+        case ISOTP_FLOW_WAIT:
+            link->tx_tick = HAL_GetTick();
+            break;
+        default: // overflow or invalid
+            link->tx_state = ISOTP_STATE_IDLE;
+            link->error_count++;
+            break;
+        }
+        break;
+
+    case ISOTP_PCI_SINGLE:
+    {
+        uint8_t size = data[0] & 0xF;
+        if (size == 0 || size > 7 || size >= length || size > link->rx_size)
+            break;
+        if (link->rx_state == ISOTP_STATE_RECEIVING) // new message interrupts previous one
+            link->error_count++;
+        memcpy(link->rx_buffer, &data[1], size);
+        link->rx_state = ISOTP_STATE_IDLE;
+        link->rx_done = size;
+        link->rx_count++;
+        break;
+    }
+
+    case ISOTP_PCI_FIRST:
+    {
+        if (length < 8)
+            break;
+        uint16_t size = ((data[0] & 0xF) << 8) | data[1];
+        if (size <= 7) // invalid, should have been single frame
+            break;
+        if (size > link->rx_size)
+        {
+            nECU_ISOTP_Link_Flow(link, ISOTP_FLOW_OVERFLOW);
+            link->error_count++;
+            break;
+        }
+        if (link->rx_state == ISOTP_STATE_RECEIVING)
+            link->error_count++;
+        memcpy(link->rx_buffer, &data[2], 6);
+        link->rx_length = size;
+        link->rx_offset = 6;
+        link->rx_sequence = 1;
+        link->rx_block_left = link->block_size;
+        link->rx_tick = HAL_GetTick();
+        link->rx_state = ISOTP_STATE_RECEIVING;
+        nECU_ISOTP_Link_Flow(link, ISOTP_FLOW_CTS);
+        break;
+    }
+
+    case ISOTP_PCI_CONSECUTIVE:
+    {
+        if (link->rx_state != ISOTP_STATE_RECEIVING)
+            break;
+        if ((data[0] & 0xF) != link->rx_sequence) // lost frame, message is broken
+        {
+            link->rx_state = ISOTP_STATE_IDLE;
+            link->error_count++;
+            break;
+        }
+        uint16_t size = link->rx_length - link->rx_offset;
+        if (size > 7)
+            size = 7;
+        if (size >= length)
+            break;
+        memcpy(&link->rx_buffer[link->rx_offset], &data[1], size);
+        link->rx_offset += size;
+        link->rx_sequence = (link->rx_sequence + 1) & 0xF;
+        link->rx_tick = HAL_GetTick();
+
+        if (link->rx_offset >= link->rx_length) // done
+        {
+            link->rx_state = ISOTP_STATE_IDLE;
+            link->rx_done = link->rx_length;
+            link->rx_count++;
+        }
+        else if (link->block_size && --link->rx_block_left == 0) // end of block, allow next one
+        {
+            link->rx_block_left = link->block_size;
+            nECU_ISOTP_Link_Flow(link, ISOTP_FLOW_CTS);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+void nECU_ISOTP_Link_Continue(nECU_ISOTP_Link *link) // send consecutive frames allowed by flow control and separation time
+{
+    while (link->tx_state == ISOTP_STATE_SENDING)
+    {
+        uint32_t cycles = nECU_CycleCounter_Get();
+        if (link->tx_STmin && nECU_CycleCounter_toUs(cycles - link->tx_last_cycles) < link->tx_STmin)
+            return; // too early, next TX interrupt or routine will try again
+
+        uint8_t frame[8];
+        memset(frame, ISOTP_PADDING, sizeof(frame));
+        uint16_t size = link->tx_length - link->tx_offset;
+        if (size > 7)
+            size = 7;
+        frame[0] = (ISOTP_PCI_CONSECUTIVE << 4) | link->tx_sequence;
+        memcpy(&frame[1], &link->tx_data[link->tx_offset], size);
+        if (link->send(link->tx_ID, frame))
+            return; // no room on bus, next TX interrupt will try again
+
+        link->tx_last_cycles = cycles;
+        link->tx_offset += size;
+        link->tx_sequence = (link->tx_sequence + 1) & 0xF;
+        if (link->tx_offset >= link->tx_length) // done
+        {
+            link->tx_state = ISOTP_STATE_IDLE;
+            link->tx_count++;
+            return;
+        }
+        if (link->tx_block_left && --link->tx_block_left == 0) // end of block, wait for receiver
+        {
+            link->tx_tick = HAL_GetTick();
+            link->tx_state = ISOTP_STATE_WAIT_FC;
+            return;
+        }
+        if (link->tx_STmin) // one frame per separation time
+            return;
+    }
+}
+void nECU_ISOTP_Link_Timeout(nECU_ISOTP_Link *link) // abort transfers with silent peer
+{
+    uint32_t tick = HAL_GetTick();
+    if (link->tx_state == ISOTP_STATE_WAIT_FC && (tick - link->tx_tick) > ISOTP_TIMEOUT)
+    {
+        link->tx_state = ISOTP_STATE_IDLE;
+        link->error_count++;
+    }
+    if (link->rx_state == ISOTP_STATE_RECEIVING && (tick - link->rx_tick) > ISOTP_TIMEOUT)
+    {
+        link->rx_state = ISOTP_STATE_IDLE;
+        link->error_count++;
+    }
+}
+void nECU_ISOTP_Link_Abort(nECU_ISOTP_Link *link) // drop transfers in progress
+{
+    link->tx_state = ISOTP_STATE_IDLE;
+    link->rx_state = ISOTP_STATE_IDLE;
+}
+static void nECU_ISOTP_Link_Flow(nECU_ISOTP_Link *link, uint8_t status) // send flow control frame
+{
+    uint8_t frame[8];
+    memset(frame, ISOTP_PADDING, sizeof(frame));
+    frame[0] = (ISOTP_PCI_FLOW << 4) | status;
+    frame[1] = link->block_size;
+    frame[2] = link->STmin;
+    if (link->send(link->tx_ID, frame) && status == ISOTP_FLOW_CTS) // sender would wait for nothing
+    {
+        link->rx_state = ISOTP_STATE_IDLE;
+        link->error_count++;
+    }
+}
+static uint32_t nECU_ISOTP_STmin_toUs(uint8_t STmin) // decode separation time field
+{
+    if (STmin <= 0x7F) // milliseconds
+        return STmin * 1000;
+    if (STmin >= 0xF1 && STmin <= 0xF9) // hundreds of microseconds
+        return (STmin - 0xF0) * 100;
+    return 0x7F * 1000; // reserved values mean longest time
+}
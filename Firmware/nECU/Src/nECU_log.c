@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @file    nECU_log.c
+ * @brief   This file provides code for tokenised binary log. Call sites store
+ *          format ID and raw arguments, text is rebuilt on PC from ELF file.
+ ******************************************************************************
+ */
+
+#include "nECU_log.h"
+
+static nECU_Log_Record Log_Buffer[LOG_QUEUE_LEN];
+static nECU_Queue Log_Queue = QUEUE_STATIC_INIT(Log_Buffer); // filled from any context, records written before start are kept
+static uint8_t Log_Tx_Buffer[LOG_TX_BUFFER_LEN];               // frames of current UART transfer
+static uint32_t Log_Dropped = 0;                               // queue overflows already reported
+
+/* General functions */
+bool nECU_Log_Start(void) // start sending of records
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_Log))
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_Log);
+    }
+    if (!nECU_FlowControl_Working_Check(D_Log) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_Log);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Log);
+
+    return status;
+}
+bool nECU_Log_Stop(void) // stop sending, records are kept until queue is full
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Log) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Log);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Log);
+
+    return status;
+}
+void nECU_Log_Routine(void) // send queued records over UART, one transfer at the time
+{
+    if (!nECU_FlowControl_Working_Check(D_Log)) // Check if currently working
+    {
+        nECU_FlowControl_Error_Do(D_Log);
+        return; // Break
+    }
+
+    if (PC_UART.gState == HAL_UART_STATE_READY) // UART is shared with PC, scope and printf
+    {
+        uint16_t length = 0;
+        nECU_Log_Record record;
+        while ((length + LOG_FRAME_LEN(LOG_ARGS_MAX)) <= LOG_TX_BUFFER_LEN && nECU_Queue_Pop(&Log_Queue, &record))
+            length += nECU_Log_Encode(&record, &Log_Tx_Buffer[length]);
+
+        if (length > 0)
+            HAL_UART_Transmit_IT(&PC_UART, Log_Tx_Buffer, length); // completion releases this routine again (EVENT_UART_ID)
+    }
+
+    if (Log_Queue.overflow_count != Log_Dropped) // report lost records in the log itself, once there is space for it
+    {
+        uint32_t dropped = Log_Queue.overflow_count - Log_Dropped;
+        Log_Dropped += dropped;
+        nECU_LOG("Log dropped %lu records", dropped);
+    }
+
+    nECU_Debug_ProgramBlockData_Update(D_Log);
+}
+
+/* Records */
+void nECU_Log_Write(uint16_t format, uint8_t argc, uint32_t const *args) // store record, safe in interrupts
+{
+    nECU_Log_Record record;
+    record.timestamp = HAL_GetTick();
+    record.format = format;
+    record.argc = (argc > LOG_ARGS_MAX) ? LOG_ARGS_MAX : argc;
+    memcpy(record.args, args, record.argc * sizeof(uint32_t));
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // queue has single producer, interrupts may write records too
+    nECU_Queue_Push(&Log_Queue, &record);
+    __set_PRIMASK(primask);
+}
+static uint8_t nECU_Log_Encode(nECU_Log_Record const *record, uint8_t *frame) // write record as frame, returns frame length
+{
+    /* Frame (little endian):
+        [0]     LOG_SYNC
+        [1-2]   format ID
+        [3]     number of arguments
+        [4-7]   timestamp [ms]
+        [8-]    arguments, 4 bytes each
+        [last]  XOR of all bytes after sync
+    */
+    uint8_t length = 0;
+    frame[length++] = LOG_SYNC;
+    frame[length++] = record->format & 0xFF;
+    frame[length++] = record->format >> 8;
+    frame[length++] = record->argc;
+    for (uint8_t byte = 0; byte < 4; byte++)
+        frame[length++] = (record->timestamp >> (8 * byte)) & 0xFF;
+    for (uint8_t arg = 0; arg < record->argc; arg++)
+    {
+        for (uint8_t byte = 0; byte < 4; byte++)
+            frame[length++] = (record->args[arg] >> (8 * byte)) & 0xFF;
+    }
+
+    uint8_t checksum = 0;
+    for (uint8_t index = 1; index < length; index++)
+        checksum ^= frame[index];
+    frame[length++] = checksum;
+
+    return length;
+}
@@ -16,6 +16,8 @@ static uint8_t max = 0;
 static char bar[bar_len] = {0};
 static nECU_Delay max_decay;
 
+static nECU_LoopStats loop = {0};
+
 /* General code */
 void nECU_Start(void) // start executing program (mostly in main loop, some in background with interrupts)
 {
@@ -24,24 +26,16 @@ void nECU_Start(void) // start executing program (mostly in main loop, some in b
 
     if (!nECU_FlowControl_Initialize_Check(D_Main))
     {
-        status |= nECU_PC_Start();
-
-        status |= nECU_FLASH_Start(); // initialize FLASH module -> copy from FLASH to RAM
-        // nECU_EGT_Start();
-        status |= nECU_test(); // perform system and code tests
-
-        status |= Frame0_Start();
-        status |= Frame1_Start();
-        status |= Frame2_Start();
-        status |= nECU_CAN_Start();
-
-        status |= OnBoard_LED_Start();
+        status |= nECU_Boot_Start(D_Flash); // copy from FLASH to RAM, needed by tests
+        status |= nECU_test();              // perform system and code tests
+        status |= nECU_Boot_Start(D_Main);  // modules used by main loop, order comes from dependency table (nECU_boot.c)
 
         if (!status)
             status |= !nECU_FlowControl_Initialize_Do(D_Main);
     }
     if (!nECU_FlowControl_Working_Check(D_Main) && status == false)
     {
+        status |= nECU_Boot_Start(D_Watchdog); // release periodic routines, from now on critical routines have to check in
         if (!status)
         {
             status |= !nECU_FlowControl_Working_Do(D_Main);
@@ -58,6 +52,7 @@ void nECU_Start(void) // start executing program (mostly in main loop, some in b
     nECU_Delay_Start(&max_decay);
     nECU_TIM_PWM_Start(TIM_PWM_LED1_ID, 0);
     nECU_TIM_PWM_Start(TIM_PWM_LED2_ID, 0);
+    loop.last_cycles = nECU_CycleCounter_Get();
 }
 void nECU_main(void) // main rutine of the program
 {
@@ -71,20 +66,11 @@ void nECU_main(void) // main rutine of the program
         return;
     }
 
-    // call periodic functions
-    nECU_Knock_UpdatePeriodic();
-    nECU_EGT_Routine();
-    nECU_Menu_Routine();
-
-    // update all variables for CAN transmission
-    Frame0_PrepareBuffer();
-    Frame1_PrepareBuffer();
-    Frame2_PrepareBuffer();
-
-    // checks if its time to send packet
-    nECU_CAN_TX_CheckTime();
-
-    OnBoard_LED_Update();
+    // serve released tasks (rates are defined in nECU_scheduler.c)
+    bool busy = nECU_Scheduler_Run();
+    if (!busy) // nothing to do until next interrupt
+        nECU_Scheduler_Sleep();
+    nECU_Loop_Update(busy);
     // nECU_Debug_Periodic();
 
     // nECU_InputAnalog_ADC1_Routine(ADC1_VREF_ID);
@@ -115,11 +101,61 @@ void nECU_main(void) // main rutine of the program
 void nECU_Stop(void) // stop all peripherals (no interrupts will generate)
 {
     bool status = false;
-    status |= nECU_CAN_Stop();
-    status |= nECU_Knock_Stop();
+    status |= nECU_Boot_Stop(D_Main); // watchdog and scheduler first, nothing may run on data of main loop
     if (!status)
-        status |= nECU_FlowControl_Stop_Do(D_Main);
+        status |= !nECU_FlowControl_Stop_Do(D_Main);
+    status |= nECU_Boot_Release(D_Main); // modules used by main loop, in reverse start order
 
     if (status)
         nECU_FlowControl_Error_Do(D_Main);
 }
+
+/* Loop statistics */
+static void nECU_Loop_Update(bool busy) // account time of finished pass
+{
+    uint32_t now = nECU_CycleCounter_Get();
+    uint32_t cycles = now - loop.last_cycles;
+    loop.last_cycles = now;
+
+    uint32_t period = nECU_CycleCounter_toUs(cycles);
+    uint8_t bucket = (period > 0) ? (31 - __builtin_clz(period)) : 0; // log2 of period
+    if (bucket >= LOOP_HISTOGRAM_BUCKETS)
+        bucket = LOOP_HISTOGRAM_BUCKETS - 1;
+    loop.histogram[bucket]++;
+    for (nECU_Loop_Reader reader = 0; reader < LOOP_READER_MAX; reader++) // reset by interrupt between compare and store leaves this pass for next read, nothing is lost
+        if (period > loop.period_max[reader])
+            loop.period_max[reader] = period;
+
+    if (busy)
+        loop.busy_cycles += cycles;
+    else
+        loop.idle_cycles += cycles;
+
+    uint32_t window = loop.busy_cycles + loop.idle_cycles;
+    if (window >= (SystemCoreClock / 1000) * LOOP_LOAD_WINDOW) // window completed
+    {
+        loop.load = ((uint64_t)loop.busy_cycles * 1000) / window;
+        loop.busy_cycles = 0;
+        loop.idle_cycles = 0;
+    }
+}
+nECU_LoopStats *nECU_Loop_getPointer(void) // returns pointer to loop statistics
+{
+    return &loop;
+}
+uint32_t nECU_Loop_getPeriodMax(nECU_Loop_Reader reader) // returns longest pass since last call of the same reader [us]
+{
+    uint32_t period_max = loop.period_max[reader];
+    loop.period_max[reader] = 0;
+    return period_max;
+}
+void nECU_Loop_Report(void) // print loop statistics over UART
+{
+    printf("CPU load %u.%u%%, longest pass %lu us\n\r", loop.load / 10, loop.load % 10, (unsigned long)nECU_Loop_getPeriodMax(LOOP_READER_REPORT));
+    for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++)
+    {
+        if (loop.histogram[bucket] == 0)
+            continue;
+        printf("%8lu - %8lu us: %lu\n\r", (unsigned long)((bucket > 0) ? (1UL << bucket) : 0), (unsigned long)((1UL << (bucket + 1)) - 1), (unsigned long)loop.histogram[bucket]);
+    }
+}
\ No newline at end of file
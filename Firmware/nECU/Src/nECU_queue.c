@@ -0,0 +1,174 @@
+/**
+ ******************************************************************************
+ * @file    nECU_queue.c
+ * @brief   This file provides code for lock-free single producer, single
+ *          consumer ring queues used to pass events out of interrupts.
+ *          Indexes run freely and are masked on access, so full and empty
+ *          states are distinguished without spare element. Code does not
+ *          depend on HAL and can be built for host.
+ ******************************************************************************
+ */
+
+#include "nECU_queue.h"
+
+/* General functions */
+bool nECU_Queue_Init(nECU_Queue *queue, void *buffer, uint16_t element_size, uint32_t length) // prepare queue over given buffer, returns true on error
+{
+    if (queue == NULL || buffer == NULL || element_size == 0 || !QUEUE_IS_POW2(length)) // Break if invalid data
+        return true;
+
+    queue->buffer = (uint8_t *)buffer;
+    queue->element_size = element_size;
+    queue->mask = length - 1;
+    atomic_store_explicit(&queue->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&queue->tail, 0, memory_order_relaxed);
+    queue->push_count = 0;
+    queue->overflow_count = 0;
+    queue->peak = 0;
+    return false;
+}
+
+/* Producer side */
+bool nECU_Queue_Push(nECU_Queue *queue, void const *element) // copy element into queue, returns false if queue was full
+{
+    if (queue == NULL || queue->buffer == NULL || element == NULL) // Break if invalid data
+        return false;
+
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire); // slot is free only after consumer copied it out
+    uint32_t count = head - tail;
+    if (count > queue->mask) // full
+    {
+        queue->overflow_count++;
+        return false;
+    }
+
+    memcpy(&queue->buffer[(head & queue->mask) * queue->element_size], element, queue->element_size);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release); // publish element after it was written
+
+    queue->push_count++;
+    if (count + 1 > queue->peak)
+        queue->peak = count + 1;
+    return true;
+}
+
+/* Consumer side */
+bool nECU_Queue_Pop(nECU_Queue *queue, void *element) // copy oldest element out of queue, returns false if queue was empty
+{
+    if (queue == NULL || queue->buffer == NULL || element == NULL) // Break if invalid data
+        return false;
+
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire); // element content is visible once head is
+    if (head == tail) // empty
+        return false;
+
+    memcpy(element, &queue->buffer[(tail & queue->mask) * queue->element_size], queue->element_size);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release); // hand slot back after it was read
+    return true;
+}
+void nECU_Queue_Flush(nECU_Queue *queue) // drop all queued elements
+{
+    if (queue == NULL) // Break if invalid data
+        return;
+
+    atomic_store_explicit(&queue->tail, atomic_load_explicit(&queue->head, memory_order_acquire), memory_order_release);
+}
+
+/* Any side */
+uint32_t nECU_Queue_Count(nECU_Queue *queue) // returns number of queued elements
+{
+    if (queue == NULL) // Break if invalid data
+        return 0;
+
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    return head - tail;
+}
+
+/* Test */
+static bool nECU_Queue_test_Order(void) // test FIFO order, full and empty states
+{
+    nECU_Queue queue;
+    uint16_t buffer[4 + 1]; // too large buffer to test data spilage
+    buffer[4] = 0;
+
+    if (!nECU_Queue_Init(&queue, buffer, sizeof(uint16_t), 3)) // length not power of two
+        return false;
+    if (nECU_Queue_Init(&queue, buffer, sizeof(uint16_t), 4))
+        return false;
+
+    uint16_t value = 0;
+    if (nECU_Queue_Pop(&queue, &value)) // empty at start
+        return false;
+
+    for (uint16_t i = 1; i <= 4; i++)
+        if (!nECU_Queue_Push(&queue, &i))
+            return false;
+    uint16_t extra = 5;
+    if (nECU_Queue_Push(&queue, &extra)) // full
+        return false;
+    if (queue.overflow_count != 1 || queue.peak != 4 || nECU_Queue_Count(&queue) != 4)
+        return false;
+    if (buffer[4] != 0) // spilage
+        return false;
+
+    for (uint16_t i = 1; i <= 4; i++)
+        if (!nECU_Queue_Pop(&queue, &value) || value != i)
+            return false;
+    if (nECU_Queue_Pop(&queue, &value))
+        return false;
+
+    return true;
+}
+static bool nECU_Queue_test_Wrap(void) // test index wrap around and flush
+{
+    nECU_Queue queue;
+    nECU_Event buffer[2];
+    if (nECU_Queue_Init(&queue, buffer, sizeof(nECU_Event), 2))
+        return false;
+
+    // start close to index overflow
+    atomic_store(&queue.head, UINT32_MAX - 1);
+    atomic_store(&queue.tail, UINT32_MAX - 1);
+    nECU_Event in = {0}, out = {0};
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        in.timestamp = i;
+        in.data = (uint16_t)(i * 3);
+        if (!nECU_Queue_Push(&queue, &in))
+            return false;
+        if (!nECU_Queue_Pop(&queue, &out) || out.timestamp != in.timestamp || out.data != in.data)
+            return false;
+    }
+
+    nECU_Queue_Push(&queue, &in);
+    nECU_Queue_Push(&queue, &in);
+    nECU_Queue_Flush(&queue);
+    if (nECU_Queue_Count(&queue) != 0 || nECU_Queue_Pop(&queue, &out))
+        return false;
+
+    return true;
+}
+bool nECU_Queue_test(bool logging_enable) // Run test
+{
+    if (logging_enable)
+        printf("Started test of nECU_queue.c\n\r");
+
+    if (!nECU_Queue_test_Order())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Queue_test_Order()\n\r");
+        return false;
+    }
+    if (!nECU_Queue_test_Wrap())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Queue_test_Wrap()\n\r");
+        return false;
+    }
+
+    if (logging_enable)
+        printf("OK\n\r");
+    return true;
+}
@@ -0,0 +1,275 @@
+/**
+ ******************************************************************************
+ * @file    nECU_scheduler.c
+ * @brief   This file provides code for time triggered cooperative scheduling
+ *          of main loop routines.
+ ******************************************************************************
+ */
+
+#include "nECU_scheduler.h"
+#include "nECU_xcp.h"
+
+static nECU_Task Task_List[TASK_ID_MAX] = {0};
+static nECU_Task_Config const Task_Config_List[TASK_ID_MAX] = {
+    [TASK_KNOCK_ID] = {nECU_Knock_UpdatePeriodic, 1, 0, 300, D_Knock, SCHEDULER_EVENT(EVENT_ADC3_ID)},
+    [TASK_FRAME2_ID] = {Frame2_Routine, 10, 0, 300, D_Frame_Stock_ID, SCHEDULER_EVENT(EVENT_ADC1_ID)}, // same rate as frame transmission, frames are composed by TX timer
+    [TASK_CAN_TX_ID] = {nECU_CAN_TX_CheckTime, 1, 0, 50, D_CAN_TX, 0},
+    [TASK_MENU_ID] = {nECU_Menu_Routine, 20, 2, 100, D_Menu, 0},
+    [TASK_FRAME0_ID] = {Frame0_Routine, 100, 3, 300, D_Frame_Speed_ID, 0},
+    [TASK_FRAME1_ID] = {Frame1_Routine, 100, 5, 100, D_Frame_EGT_ID, 0},
+    [TASK_EGT_ID] = {nECU_EGT_Routine, 50, 4, 200, D_EGT1, SCHEDULER_EVENT(EVENT_SPI_ID)},                   // routine handles all sensors
+    [TASK_LED_ID] = {OnBoard_LED_Update, 10, 6, 50, D_OnboardLED, 0},
+    [TASK_PC_ID] = {nECU_PC_Routine, 10, 8, 200, D_PC, SCHEDULER_EVENT(EVENT_UART_ID)},
+    [TASK_SCOPE_ID] = {nECU_Scope_Routine, 5, 1, 500, D_Scope, SCHEDULER_EVENT(EVENT_UART_ID)},              // one UART chunk per call
+    [TASK_LOG_ID] = {nECU_Log_Routine, 10, 3, 100, D_Log, SCHEDULER_EVENT(EVENT_UART_ID)},                     // one UART transfer per call
+    [TASK_WATCHDOG_ID] = {nECU_Watchdog_Routine, 10, 9, 50, D_Watchdog, 0},
+}; // List of tasks: routine, period [ms], offset [ms], budget [us], program block, releasing events
+static volatile uint32_t scheduler_events = 0; // pending events (SCHEDULER_EVENT bits)
+
+_Static_assert(QUEUE_IS_POW2(EVENT_QUEUE_LEN), "EVENT_QUEUE_LEN has to be power of two");
+static nECU_Event Event_Buffer_List[EVENT_ID_MAX][EVENT_QUEUE_LEN];
+static nECU_Queue Event_Queue_List[EVENT_ID_MAX] = {
+    [EVENT_ADC1_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_ADC1_ID]),
+    [EVENT_ADC2_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_ADC2_ID]),
+    [EVENT_ADC3_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_ADC3_ID]),
+    [EVENT_CAN_RX_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_CAN_RX_ID]),
+    [EVENT_TIM_IC_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_TIM_IC_ID]),
+    [EVENT_SPI_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_SPI_ID]),
+    [EVENT_UART_ID] = QUEUE_STATIC_INIT(Event_Buffer_List[EVENT_UART_ID]),
+}; // One queue per source, each source posts only from its own interrupt, main loop is the only consumer
+static bool const Event_Consumed_List[EVENT_ID_MAX] = {
+    [EVENT_ADC1_ID] = true, // nECU_ADC1_Routine
+    [EVENT_ADC2_ID] = true, // nECU_ADC2_Routine
+    [EVENT_ADC3_ID] = true, // nECU_ADC3_Routine
+}; // Sources read by module routines, others are drained by dispatcher
+static uint32_t Event_Latency_List[EVENT_ID_MAX] = {0}; // maximal time from post to take [us]
+static volatile bool scheduler_running = false;
+static volatile nECU_Module_ID scheduler_block = D_ID_MAX; // block of task being executed
+
+/* General functions */
+bool nECU_Scheduler_Start(void)
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_Scheduler))
+    {
+        for (nECU_Task_ID current_ID = 0; current_ID < TASK_ID_MAX; current_ID++)
+        {
+            if (Task_Config_List[current_ID].Routine == NULL || Task_Config_List[current_ID].period == 0)
+                status |= true;
+            memset(&Task_List[current_ID], 0, sizeof(nECU_Task));
+            Task_List[current_ID].countdown = Task_Config_List[current_ID].offset + 1;
+        }
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_Scheduler);
+    }
+    if (!nECU_FlowControl_Working_Check(D_Scheduler) && status == false)
+    {
+        scheduler_events = 0;
+        scheduler_running = true;
+#if SCHEDULER_SLEEP == true
+        HAL_DBGMCU_EnableDBGSleepMode(); // keep debugger connected while sleeping
+#endif
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_Scheduler);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Scheduler);
+
+    return status;
+}
+bool nECU_Scheduler_Stop(void)
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Scheduler) && status == false)
+    {
+        scheduler_running = false;
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Scheduler);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Scheduler);
+
+    return status;
+}
+bool nECU_Scheduler_Run(void) // serve highest priority released task, returns false if nothing was due
+{
+    if (!nECU_FlowControl_Working_Check(D_Scheduler)) // Check if currently working
+    {
+        nECU_FlowControl_Error_Do(D_Scheduler);
+        return false; // Break
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t events = scheduler_events;
+    scheduler_events = 0;
+    __set_PRIMASK(primask);
+    if (events) // release tasks waiting for data
+        for (nECU_Task_ID current_ID = 0; current_ID < TASK_ID_MAX; current_ID++)
+            if (Task_Config_List[current_ID].events & events)
+                Task_List[current_ID].released = true;
+    nECU_Scheduler_Event_Drain();
+
+    for (nECU_Task_ID current_ID = 0; current_ID < TASK_ID_MAX; current_ID++)
+    {
+        nECU_Task *task = &Task_List[current_ID];
+        if (!task->released)
+            continue;
+        task->released = false;
+
+        uint32_t start = nECU_CycleCounter_Get();
+        scheduler_block = Task_Config_List[current_ID].block;
+        nECU_PROFILE_ENTER(Task_Config_List[current_ID].block);
+        Task_Config_List[current_ID].Routine();
+        nECU_PROFILE_EXIT(Task_Config_List[current_ID].block);
+        scheduler_block = D_ID_MAX;
+        uint32_t exec = nECU_CycleCounter_toUs(nECU_CycleCounter_Get() - start);
+        nECU_XCP_Event(XCP_EVENT_TASK(current_ID)); // DAQ lists bound to this task, outside of its budget
+
+        task->run_count++;
+        if (exec > task->exec_max)
+            task->exec_max = exec;
+        if (exec > Task_Config_List[current_ID].budget)
+            task->over_budget_count++;
+
+        nECU_Debug_ProgramBlockData_Update(D_Scheduler);
+        return true; // rescan, so that higher priority tasks released meanwhile go first
+    }
+
+    nECU_Debug_ProgramBlockData_Update(D_Scheduler);
+    return false;
+}
+
+void nECU_Scheduler_Sleep(void) // wait for next interrupt if nothing is pending
+{
+#if SCHEDULER_SLEEP == true
+    __disable_irq(); // interrupt arriving after the check still ends WFI, it is served once enabled
+    if (!nECU_Scheduler_isPending())
+    {
+        __DSB();
+        __WFI();
+    }
+    __enable_irq();
+#endif
+}
+static bool nECU_Scheduler_isPending(void) // returns true if any task or event waits for dispatcher
+{
+    if (scheduler_events)
+        return true;
+    for (nECU_Task_ID current_ID = 0; current_ID < TASK_ID_MAX; current_ID++)
+        if (Task_List[current_ID].released)
+            return true;
+    return false;
+}
+
+/* Interrupt functions */
+void nECU_Scheduler_Tick(void) // release tasks, to be called from 1ms timer interrupt
+{
+    if (!scheduler_running)
+        return;
+
+    for (nECU_Task_ID current_ID = 0; current_ID < TASK_ID_MAX; current_ID++)
+    {
+        nECU_Task *task = &Task_List[current_ID];
+        if (--(task->countdown) > 0)
+            continue;
+
+        task->countdown = Task_Config_List[current_ID].period;
+        if (task->released) // previous release still waiting
+            task->missed_count++;
+        task->released = true;
+    }
+}
+
+bool nECU_Scheduler_Event(nECU_Event_ID ID, uint16_t data) // queue timestamped event, to be called only from interrupt of given source, returns false if event was lost
+{
+    if (ID >= EVENT_ID_MAX) // Break if invalid ID
+        return false;
+
+    nECU_Event event = {
+        .timestamp = nECU_CycleCounter_Get(),
+        .data = data,
+        .ID = ID,
+    };
+    bool queued = nECU_Queue_Push(&Event_Queue_List[ID], &event);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // interrupts of different priority can set bits at once
+    scheduler_events |= SCHEDULER_EVENT(ID);
+    __set_PRIMASK(primask);
+    return queued;
+}
+
+/* Event queues */
+bool nECU_Scheduler_Event_Get(nECU_Event_ID ID, nECU_Event *event) // take oldest event of given source, returns false if none
+{
+    if (ID >= EVENT_ID_MAX || event == NULL) // Break if invalid data
+        return false;
+
+    if (!nECU_Queue_Pop(&Event_Queue_List[ID], event))
+        return false;
+
+    uint32_t latency = nECU_CycleCounter_toUs(nECU_CycleCounter_Get() - event->timestamp);
+    if (latency > Event_Latency_List[ID])
+        Event_Latency_List[ID] = latency;
+    return true;
+}
+void nECU_Scheduler_Event_Flush(nECU_Event_ID ID) // drop queued events of given source
+{
+    if (ID >= EVENT_ID_MAX) // Break if invalid ID
+        return;
+
+    nECU_Queue_Flush(&Event_Queue_List[ID]);
+}
+static void nECU_Scheduler_Event_Drain(void) // take events which are not consumed by module routines
+{
+    nECU_Event event;
+    for (nECU_Event_ID current_ID = 0; current_ID < EVENT_ID_MAX; current_ID++)
+    {
+        if (Event_Consumed_List[current_ID])
+            continue;
+        while (nECU_Scheduler_Event_Get(current_ID, &event))
+            ; // only latency is tracked, data was already handled in interrupt
+    }
+}
+void nECU_Scheduler_Event_Report(void) // print queue statistics to PC
+{
+    static const char *const Event_Name_List[EVENT_ID_MAX] = {
+        [EVENT_ADC1_ID] = "ADC1",
+        [EVENT_ADC2_ID] = "ADC2",
+        [EVENT_ADC3_ID] = "ADC3",
+        [EVENT_CAN_RX_ID] = "CAN_RX",
+        [EVENT_TIM_IC_ID] = "TIM_IC",
+        [EVENT_SPI_ID] = "SPI",
+        [EVENT_UART_ID] = "UART",
+    };
+
+    printf("Event\tposted\tlost\tpeak\tlatency max [us]\n\r");
+    for (nECU_Event_ID current_ID = 0; current_ID < EVENT_ID_MAX; current_ID++)
+    {
+        nECU_Queue *queue = &Event_Queue_List[current_ID];
+        printf("%s\t%lu\t%lu\t%lu/%lu\t%lu\n\r", Event_Name_List[current_ID],
+               (unsigned long)queue->push_count, (unsigned long)queue->overflow_count,
+               (unsigned long)queue->peak, (unsigned long)(queue->mask + 1),
+               (unsigned long)Event_Latency_List[current_ID]);
+    }
+}
+
+nECU_Task *nECU_Scheduler_getPointer(nECU_Task_ID ID) // returns pointer to task statistics
+{
+    if (ID >= TASK_ID_MAX) // Break if invalid ID
+        return NULL;
+
+    return &Task_List[ID];
+}
+nECU_Module_ID nECU_Scheduler_getRunning(void) // returns block of task being executed, D_ID_MAX if none
+{
+    return scheduler_block;
+}
+nECU_Queue *nECU_Scheduler_Event_getPointer(nECU_Event_ID ID) // returns pointer to event queue
+{
+    if (ID >= EVENT_ID_MAX) // Break if invalid ID
+        return NULL;
+
+    return &Event_Queue_List[ID];
+}
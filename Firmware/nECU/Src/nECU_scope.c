@@ -0,0 +1,270 @@
+/**
+ ******************************************************************************
+ * @file    nECU_scope.c
+ * @brief   This file provides code for high rate burst capture of MAP and
+ *          BackPressure sensors, sent to PC over UART.
+ ******************************************************************************
+ */
+
+#include "nECU_scope.h"
+
+#if SCOPE_CHANNEL_COUNT != 2
+#error "Capture packing assumes two channels per sample set"
+#endif
+
+static nECU_Scope scope = {0};
+
+/* General functions */
+bool nECU_Scope_Start(void)
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_Scope))
+    {
+        status |= nECU_PC_Start();
+        status |= nECU_UART_Init(&(scope.uart), &PC_UART, scope.out_buf);
+        scope.state = SCOPE_STATE_IDLE;
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_Scope);
+    }
+    if (!nECU_FlowControl_Working_Check(D_Scope) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_Scope);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Scope);
+
+    return status;
+}
+bool nECU_Scope_Stop(void)
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Scope) && status == false)
+    {
+        status |= nECU_Scope_Abort();
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Scope);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Scope);
+
+    return status;
+}
+void nECU_Scope_Routine(void)
+{
+    if (!nECU_FlowControl_Working_Check(D_Scope)) // Check if currently working
+    {
+        nECU_FlowControl_Error_Do(D_Scope);
+        return; // Break
+    }
+
+    switch (scope.state)
+    {
+    case SCOPE_STATE_CAPTURED:
+        scope.header_sent = false;
+        scope.sent = 0;
+        scope.checksum_a = 0;
+        scope.checksum_b = 0;
+        scope.state = SCOPE_STATE_SENDING;
+        if (nECU_ADC1_Scope_Exit()) // resume normal scanning before slow transmission
+        {
+            scope.state = SCOPE_STATE_IDLE;
+            nECU_FlowControl_Error_Do(D_Scope);
+        }
+        break;
+    case SCOPE_STATE_SENDING:
+        if (nECU_UART_Tx_Busy(&(scope.uart))) // wait for previous part
+            break;
+        if (!scope.header_sent)
+            nECU_Scope_Send_Header();
+        else if (nECU_Scope_Send_Payload())
+            scope.state = SCOPE_STATE_IDLE;
+        break;
+    default:
+        break;
+    }
+
+    nECU_Debug_ProgramBlockData_Update(D_Scope);
+}
+
+/* Capture control */
+bool nECU_Scope_Arm(nECU_Scope_Trigger trigger, nECU_ADC1_ID channel, uint16_t level, uint16_t pre, uint16_t post) // start burst capture, returns true if not possible
+{
+    if (!nECU_FlowControl_Working_Check(D_Scope) || scope.state != SCOPE_STATE_IDLE)
+        return true;
+    if (trigger >= SCOPE_TRIGGER_MAX || channel >= SCOPE_CHANNEL_COUNT) // scope channels are first ranks of GENERAL_ADC
+        return true;
+    if (post == 0 || (pre + post) > SCOPE_WINDOW_MAX) // window has to fit in one half of ring buffer
+        return true;
+
+    scope.trigger = trigger;
+    scope.trigger_channel = channel;
+    scope.level = level;
+    scope.pre = pre;
+    scope.post = post;
+    scope.manual_request = false;
+    scope.written = 0;
+    scope.previous = UINT16_MAX; // first sample can not be an edge
+    scope.state = SCOPE_STATE_ARMED;
+
+    if (nECU_ADC1_Scope_Enter(scope.in_buffer, SCOPE_DMA_LEN))
+    {
+        scope.state = SCOPE_STATE_IDLE;
+        return true;
+    }
+    return false;
+}
+void nECU_Scope_Trigger_Manual(void) // request trigger of armed capture
+{
+    if (scope.state == SCOPE_STATE_ARMED)
+        scope.manual_request = true;
+}
+bool nECU_Scope_Abort(void) // drop capture and return to normal scanning
+{
+    nECU_Scope_State previous = scope.state;
+    scope.state = SCOPE_STATE_IDLE; // ignore further DMA callbacks
+
+    switch (previous)
+    {
+    case SCOPE_STATE_ARMED:
+    case SCOPE_STATE_TRIGGERED:
+    case SCOPE_STATE_CAPTURED:
+        return nECU_ADC1_Scope_Exit();
+    case SCOPE_STATE_SENDING:
+        return (HAL_OK != nECU_UART_Tx_Abort(&(scope.uart)));
+    default:
+        break;
+    }
+    return false;
+}
+nECU_Scope_State nECU_Scope_getState(void) // returns current state of capture
+{
+    return scope.state;
+}
+
+/* Interrupt functions */
+void nECU_Scope_ADC_Callback(bool second_half) // to be called when half of burst buffer was filled
+{
+    if (scope.state != SCOPE_STATE_ARMED && scope.state != SCOPE_STATE_TRIGGERED)
+        return;
+
+    uint16_t *half = &scope.in_buffer[second_half ? (SCOPE_DMA_LEN / 2) : 0];
+    uint32_t first = scope.written; // number of first sample set in this half
+    scope.written += SCOPE_DEPTH / 2;
+
+    if (scope.state == SCOPE_STATE_ARMED)
+    {
+        for (uint32_t set = 0; set < (SCOPE_DEPTH / 2); set++)
+        {
+            uint16_t value = half[(set * SCOPE_CHANNEL_COUNT) + scope.trigger_channel];
+            bool triggered = false;
+            if ((first + set) >= scope.pre) // wait until pre trigger part is filled
+            {
+                switch (scope.trigger)
+                {
+                case SCOPE_TRIGGER_MANUAL:
+                    triggered = scope.manual_request;
+                    break;
+                case SCOPE_TRIGGER_LEVEL:
+                    triggered = (value >= scope.level);
+                    break;
+                case SCOPE_TRIGGER_RISING:
+                    triggered = (scope.previous < scope.level) && (value >= scope.level);
+                    break;
+                default:
+                    break;
+                }
+            }
+            scope.previous = value;
+
+            if (triggered)
+            {
+                scope.trigger_index = first + set;
+                scope.manual_request = false;
+                scope.state = SCOPE_STATE_TRIGGERED;
+                break;
+            }
+        }
+    }
+
+    if (scope.state == SCOPE_STATE_TRIGGERED && scope.written >= (scope.trigger_index + scope.post))
+    {
+        nECU_ADC1_Scope_Halt(); // freeze ring buffer until it is sent
+        scope.capture_tick = HAL_GetTick();
+        scope.state = SCOPE_STATE_CAPTURED;
+    }
+}
+
+/* Transmission */
+static void nECU_Scope_Send_Header(void) // compose and send capture header
+{
+    uint8_t *out = scope.out_buf;
+    uint16_t count = scope.pre + scope.post;
+    uint32_t rate = SCOPE_SAMPLE_RATE;
+
+    out[0] = SCOPE_SYNC_BYTE_1;
+    out[1] = SCOPE_SYNC_BYTE_2;
+    out[2] = SCOPE_FORMAT_VERSION;
+    out[3] = SCOPE_CHANNEL_COUNT;
+    out[4] = count & 0xFF;
+    out[5] = count >> 8;
+    out[6] = scope.pre & 0xFF;
+    out[7] = scope.pre >> 8;
+    out[8] = scope.trigger;
+    out[9] = scope.trigger_channel;
+    out[10] = scope.level & 0xFF;
+    out[11] = scope.level >> 8;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        out[12 + i] = (rate >> (8 * i)) & 0xFF;
+        out[16 + i] = (scope.capture_tick >> (8 * i)) & 0xFF;
+    }
+
+    scope.header_sent = true;
+    nECU_Scope_Transmit(SCOPE_HEADER_LEN);
+}
+static bool nECU_Scope_Send_Payload(void) // compose and send next chunk of samples (trailer after last one), returns true when all sent
+{
+    uint32_t total = scope.pre + scope.post;
+    uint32_t count = total - scope.sent;
+    if (count > SCOPE_UART_CHUNK)
+        count = SCOPE_UART_CHUNK;
+
+    uint16_t length = 0;
+    uint32_t set = scope.trigger_index - scope.pre + scope.sent; // oldest sample set not sent yet
+    for (uint32_t i = 0; i < count; i++, set++)
+    {
+        uint16_t *sample = &scope.in_buffer[(set % SCOPE_DEPTH) * SCOPE_CHANNEL_COUNT];
+        scope.out_buf[length++] = sample[0] & 0xFF;
+        scope.out_buf[length++] = ((sample[0] >> 8) & 0x0F) | ((sample[1] & 0x0F) << 4);
+        scope.out_buf[length++] = (sample[1] >> 4) & 0xFF;
+    }
+    nECU_Scope_Checksum_Update(scope.out_buf, length);
+    scope.sent += count;
+
+    bool done = (scope.sent >= total);
+    if (done) // add trailer
+    {
+        scope.out_buf[length++] = scope.checksum_a & 0xFF;
+        scope.out_buf[length++] = scope.checksum_b & 0xFF;
+        scope.out_buf[length++] = END_BYTE;
+    }
+
+    nECU_Scope_Transmit(length);
+    return done;
+}
+static void nECU_Scope_Transmit(uint16_t length) // send prepared part of capture
+{
+    scope.uart.length = length;
+    scope.uart.pending = true;
+    nECU_PC_Tx_Start_Callback();
+    nECU_UART_Tx(&(scope.uart));
+}
+static void nECU_Scope_Checksum_Update(uint8_t *data, uint16_t len) // Fletcher-16 over sent payload
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        scope.checksum_a = (scope.checksum_a + data[i]) % 255;
+        scope.checksum_b = (scope.checksum_b + scope.checksum_a) % 255;
+    }
+}
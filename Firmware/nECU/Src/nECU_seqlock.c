@@ -0,0 +1,200 @@
+/**
+ ******************************************************************************
+ * @file    nECU_seqlock.c
+ * @brief   This file provides code for sequence locks guarding multi word data
+ *          written in interrupts. Writer makes sequence odd while modifying,
+ *          reader copies data and repeats when sequence changed meanwhile.
+ *          Snapshot keeps two copies of data, writer fills the one hidden from
+ *          readers and flips them, so reader never has to repeat.
+ *          Code does not depend on HAL and can be built for host.
+ ******************************************************************************
+ */
+
+#include "nECU_seqlock.h"
+
+/* Writer side */
+void nECU_Seqlock_Write_Begin(nECU_Seqlock *lock) // mark guarded data as being modified
+{
+    uint32_t sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    atomic_store_explicit(&lock->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // odd sequence is visible before any data write
+}
+void nECU_Seqlock_Write_End(nECU_Seqlock *lock) // publish modified data
+{
+    uint32_t sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    atomic_store_explicit(&lock->sequence, sequence + 1, memory_order_release); // data writes are visible before even sequence
+}
+void nECU_Seqlock_Write(nECU_Seqlock *lock, void *dest, void const *src, uint16_t size) // copy whole data under lock
+{
+    if (lock == NULL || dest == NULL || src == NULL) // Break if pointers do not exist
+        return;
+
+    nECU_Seqlock_Write_Begin(lock);
+    nECU_Seqlock_Copy(dest, src, size);
+    nECU_Seqlock_Write_End(lock);
+}
+
+/* Reader side */
+uint32_t nECU_Seqlock_Read_Begin(nECU_Seqlock *lock) // returns sequence to be checked after data was copied
+{
+    return atomic_load_explicit(&lock->sequence, memory_order_acquire);
+}
+bool nECU_Seqlock_Read_Retry(nECU_Seqlock *lock, uint32_t start) // returns true if copy was torn and has to be repeated
+{
+    atomic_thread_fence(memory_order_acquire); // data reads complete before sequence is checked again
+    return (start & 1) || (atomic_load_explicit(&lock->sequence, memory_order_relaxed) != start);
+}
+bool nECU_Seqlock_Read(nECU_Seqlock *lock, void *dest, void const *src, uint16_t size, uint32_t *sequence) // copy consistent snapshot, returns false if writer did not let it
+{
+    if (lock == NULL || dest == NULL || src == NULL) // Break if pointers do not exist
+        return false;
+
+    for (uint8_t attempt = 0; attempt < SEQLOCK_READ_RETRIES; attempt++)
+    {
+        uint32_t start = nECU_Seqlock_Read_Begin(lock);
+        if (start & 1) // writer inside, on single core it is a transfer spanning many interrupts
+            continue;
+
+        nECU_Seqlock_Copy(dest, src, size);
+        if (nECU_Seqlock_Read_Retry(lock, start))
+            continue;
+
+        if (sequence != NULL)
+            *sequence = start;
+        return true;
+    }
+    return false;
+}
+static void nECU_Seqlock_Copy(volatile uint8_t *dest, volatile uint8_t const *src, uint16_t size) // byte copy that compiler can not merge or move
+{
+    while (size--)
+        *dest++ = *src++;
+}
+
+/* Double-buffered snapshot */
+void *nECU_Snapshot_Write_Begin(nECU_Snapshot *snap, void *buffers, uint16_t size) // returns buffer hidden from readers, to be filled with complete set
+{
+    if (snap == NULL || buffers == NULL) // Break if pointers do not exist
+        return NULL;
+
+    uint32_t sequence = atomic_load_explicit(&snap->sequence, memory_order_relaxed);
+    return (uint8_t *)buffers + ((sequence & 1) ^ 1) * size;
+}
+void nECU_Snapshot_Write_End(nECU_Snapshot *snap) // publish filled buffer
+{
+    if (snap == NULL) // Break if pointer does not exist
+        return;
+
+    uint32_t sequence = atomic_load_explicit(&snap->sequence, memory_order_relaxed);
+    atomic_store_explicit(&snap->sequence, sequence + 1, memory_order_release); // data writes are visible before buffers flip
+}
+uint32_t nECU_Snapshot_Read(nECU_Snapshot *snap, void *dest, void const *buffers, uint16_t size) // copy latest published set, returns its sequence (0 - nothing published yet)
+{
+    if (snap == NULL || dest == NULL || buffers == NULL) // Break if pointers do not exist
+        return 0;
+
+    uint32_t sequence = atomic_load_explicit(&snap->sequence, memory_order_acquire);
+    nECU_Seqlock_Copy(dest, (uint8_t const *)buffers + (sequence & 1) * size, size);
+    return sequence;
+}
+
+/* Test */
+static bool nECU_Seqlock_test_Read(void) // test snapshot and sequence of undisturbed reads
+{
+    nECU_Seqlock lock = {0};
+    uint32_t data[3] = {1, 2, 3}, copy[3] = {0}, sequence = 1;
+
+    if (!nECU_Seqlock_Read(&lock, copy, data, sizeof(data), &sequence) || sequence != 0)
+        return false;
+    if (memcmp(copy, data, sizeof(data)))
+        return false;
+
+    uint32_t update[3] = {4, 5, 6};
+    nECU_Seqlock_Write(&lock, data, update, sizeof(data));
+    if (!nECU_Seqlock_Read(&lock, copy, data, sizeof(data), &sequence) || sequence != 2)
+        return false;
+    if (memcmp(copy, update, sizeof(update)))
+        return false;
+
+    return true;
+}
+static bool nECU_Seqlock_test_Torn(void) // test detection of writer interrupting reader
+{
+    nECU_Seqlock lock = {0};
+    uint32_t data[2] = {1, 1};
+
+    // writer interrupts between reader copying halves
+    uint32_t start = nECU_Seqlock_Read_Begin(&lock);
+    uint32_t first = data[0];
+    nECU_Seqlock_Write_Begin(&lock);
+    data[0] = 2;
+    data[1] = 2;
+    nECU_Seqlock_Write_End(&lock);
+    uint32_t second = data[1];
+    if (first == second || !nECU_Seqlock_Read_Retry(&lock, start))
+        return false;
+
+    // reader can not get snapshot while writer is inside
+    uint32_t copy[2] = {0};
+    nECU_Seqlock_Write_Begin(&lock);
+    if (nECU_Seqlock_Read(&lock, copy, data, sizeof(data), NULL))
+        return false;
+    nECU_Seqlock_Write_End(&lock);
+    if (!nECU_Seqlock_Read(&lock, copy, data, sizeof(data), NULL) || copy[0] != 2 || copy[1] != 2)
+        return false;
+
+    return true;
+}
+static bool nECU_Seqlock_test_Snapshot(void) // test that reader sees only complete sets
+{
+    nECU_Snapshot snap = {0};
+    uint32_t buffers[2][2] = {0}, copy[2] = {1, 1};
+
+    if (nECU_Snapshot_Read(&snap, copy, buffers, sizeof(copy)) != 0 || copy[0] != 0 || copy[1] != 0)
+        return false;
+
+    for (uint32_t set = 1; set <= 3; set++)
+    {
+        // reader interrupts writer in the middle of filling a set
+        uint32_t *next = nECU_Snapshot_Write_Begin(&snap, buffers, sizeof(copy));
+        next[0] = set;
+        if (nECU_Snapshot_Read(&snap, copy, buffers, sizeof(copy)) != set - 1 || copy[0] != copy[1] || copy[0] != set - 1)
+            return false;
+        next[1] = set;
+        nECU_Snapshot_Write_End(&snap);
+
+        if (nECU_Snapshot_Read(&snap, copy, buffers, sizeof(copy)) != set || copy[0] != set || copy[1] != set)
+            return false;
+    }
+
+    return true;
+}
+bool nECU_Seqlock_test(bool logging_enable) // Run test
+{
+    if (logging_enable)
+        printf("Started test of nECU_seqlock.c\n\r");
+
+    if (!nECU_Seqlock_test_Read())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Seqlock_test_Read()\n\r");
+        return false;
+    }
+    if (!nECU_Seqlock_test_Torn())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Seqlock_test_Torn()\n\r");
+        return false;
+    }
+
+    if (!nECU_Seqlock_test_Snapshot())
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on nECU_Seqlock_test_Snapshot()\n\r");
+        return false;
+    }
+
+    if (logging_enable)
+        printf("OK\n\r");
+    return true;
+}
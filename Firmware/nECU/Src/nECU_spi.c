@@ -23,6 +23,7 @@ void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi) // called when successfully
   SPI_Data_List[current_ID].CS_pin->State = GPIO_PIN_SET;
   HAL_GPIO_WritePin(SPI_Data_List[current_ID].CS_pin->GPIOx, SPI_Data_List[current_ID].CS_pin->GPIO_Pin, SPI_Data_List[current_ID].CS_pin->State);
   SPI_Data_List[current_ID].data_Pending = true;
+  nECU_Scheduler_Event(EVENT_SPI_ID, current_ID);
   switch (current_ID)
   {
   case SPI_EGT_ID:
@@ -70,7 +70,9 @@ void nECU_OX_Routine(void) // update narrowband lambda structure
 
     /* Output update */
     /* simple algorithm that linearly scale heater voltage with engine coolant temperature */
-    float coolant = nECU_CAN_RX_getValue(CAN_RX_Coolant_ID);
+    int32_t coolant_CAN = OXYGEN_COOLANT_DEFAULT;
+    nECU_CAN_RX_getValid(CAN_RX_Coolant_ID, &coolant_CAN); // keeps default if main ECU stopped sending
+    float coolant = coolant_CAN;
     UNUSED(coolant);
     // OX.Heater_Infill = nECU_Table_Interpolate(&OX.Coolant_min, &OX.Infill_max, &OX.Coolant_max, &OX.Infill_min, &coolant);
     // OX.Heater.htim->Instance->CCR1 = (OX.Heater_Infill * (OX.Heater.htim->Init.Period + 1)) / 100;
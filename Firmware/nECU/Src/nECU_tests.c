@@ -140,6 +140,48 @@ bool nECU_codetest_run(void) // run tests of type codetest
         nECU_codetest_error();
         status |= true;
     }
+    if (!nECU_Queue_test(true))
+    {
+        printf("Test failed on nECU_Queue_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_Seqlock_test(true))
+    {
+        printf("Test failed on nECU_Seqlock_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_Boot_test(true))
+    {
+        printf("Test failed on nECU_Boot_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_CAN_test(true))
+    {
+        printf("Test failed on nECU_CAN_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_Frame_test(true))
+    {
+        printf("Test failed on nECU_Frame_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_ISOTP_test(true))
+    {
+        printf("Test failed on nECU_ISOTP_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
+    if (!nECU_XCP_test(true))
+    {
+        printf("Test failed on nECU_XCP_test()\n\r");
+        nECU_codetest_error();
+        status |= true;
+    }
     printf("DONE!\n\r");
     return status;
 }
@@ -179,8 +221,11 @@ void nECU_IGF_Test(void) // checks readout compared to CAN frame data
         nECU_FreqInput_Start(FREQ_IGF_ID);
         IGF_test_Initialized = true;
     }
-    float CAN_RPM = nECU_CAN_RX_getValue(CAN_RX_RPM_ID); // 20 is a divider value from MaxxECU config
-    float RPM_difference = 0;                            // difference between RPM data
+    int32_t CAN_RPM_raw = 0;
+    if (!nECU_CAN_RX_getValid(CAN_RX_RPM_ID, &CAN_RPM_raw)) // nothing to compare with
+        return;
+    float CAN_RPM = CAN_RPM_raw; // 20 is a divider value from MaxxECU config
+    float RPM_difference = 0;    // difference between RPM data
 
     nECU_FreqInput_Routine(FREQ_IGF_ID);                // update value
     if (CAN_RPM > nECU_FreqInput_getValue(FREQ_IGF_ID)) // calculate difference
@@ -23,6 +23,7 @@ static TIM_HandleTypeDef *TIM_Handle_List[TIM_ID_MAX] = {
     [TIM_FRAME_ID] = &htim6,
     [TIM_PWM_LED1_ID] = &htim10,
     [TIM_PWM_LED2_ID] = &htim11,
+    [TIM_CAN_TX_ID] = &htim7,
 }; // Lists handles for each ID
 static const uint32_t TIM_ActiveChannel_Lookup[HAL_TIM_ACTIVE_CHANNEL_4 + 1] = {
     [HAL_TIM_ACTIVE_CHANNEL_1] = TIM_CHANNEL_1,
@@ -82,11 +83,26 @@ nECU_InputCapture *nECU_TIM_IC_getPointer(nECU_TIM_ID ID, uint32_t Channel) // p
 
   return &(TIM_List[ID].IC[Channel]);
 }
+bool nECU_TIM_IC_Read(nECU_InputCapture *ic, nECU_InputCapture_Data *data, uint32_t *sequence) // copy consistent IC data, returns true if it changed since given sequence
+{
+  if (ic == NULL || data == NULL || sequence == NULL) // Break if pointers do not exist
+    return false;
+
+  uint32_t current = 0;
+  if (!nECU_Seqlock_Read(&ic->lock, data, &ic->data, sizeof(nECU_InputCapture_Data), &current))
+    return false; // capture in progress, try next time
+  if (current == *sequence)
+    return false;
+
+  *sequence = current;
+  return true;
+}
 
 /* Callback functions */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
-  UNUSED(htim);
+  if (htim == TIM_Handle_List[TIM_CAN_TX_ID]) // 1 ms release of periodic CAN frames, independent of main loop
+    nECU_CAN_TX_Timer_Callback();
 }
 void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
 {
@@ -102,6 +118,7 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
     return;
 
   nECU_TIM_IC_Callback(TIM_IC_FREQ_ID);
+  nECU_Scheduler_Event(EVENT_TIM_IC_ID, current_ID); // TIM3 and TIM4 share preemption priority, so queue keeps single producer
 }
 
 /* Used for simple time tracking */
@@ -131,6 +148,21 @@ bool nECU_TickTrack_Update(nECU_TickTrack *inst) // callback to get difference
   return false;
 }
 
+/* Cycle counter */
+void nECU_CycleCounter_Init(void) // enable DWT cycle counter
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+uint32_t nECU_CycleCounter_Get(void) // returns current CPU cycle count (wraps around)
+{
+  return DWT->CYCCNT;
+}
+uint32_t nECU_CycleCounter_toUs(uint32_t cycles) // convert number of cycles to microseconds
+{
+  return cycles / (SystemCoreClock / 1000000);
+}
+
 /* Non-blocking delay */
 bool *nECU_Delay_DoneFlag(nECU_Delay *inst) // return done flag pointer of non-blocking delay
 {
@@ -206,11 +238,9 @@ bool nECU_TIM_Init(nECU_TIM_ID ID) // initialize structure and precalculate vari
   for (uint8_t channel = 0; channel < sizeof(TIM_List[ID].Channels) / sizeof(TIM_List[ID].Channels[0]); channel++) // zero out every position of the list
   {
     TIM_List[ID].Channels[channel] = TIM_Channel_NONE;
-    TIM_List[ID].IC[channel].CCR_High = 0;
-    TIM_List[ID].IC[channel].CCR_Low = 0;
     TIM_List[ID].IC[channel].CCR_prev = 0;
-    TIM_List[ID].IC[channel].frequency = 0;
-    TIM_List[ID].IC[channel].newData = false;
+    memset(&TIM_List[ID].IC[channel].data, 0, sizeof(nECU_InputCapture_Data));
+    atomic_init(&TIM_List[ID].IC[channel].lock.sequence, 0);
     TIM_List[ID].IC[channel].Digi_Input = DigiInput_ID_MAX;
   }
 
@@ -455,20 +485,22 @@ static bool nECU_TIM_IC_Callback(nECU_TIM_ID ID) // callback function to calcula
   nECU_DigitalInput_Routine(TIM_List[ID].IC[channel_ic].Digi_Input);
 
   /* If GPIO was defined: Detect edge and calculate times */
+  nECU_InputCapture_Data *data = &TIM_List[ID].IC[channel_ic].data;
+  nECU_Seqlock_Write_Begin(&TIM_List[ID].IC[channel_ic].lock); // fields below have to be read as a set
   if (TIM_List[ID].IC[channel_ic].Digi_Input < DigiInput_ID_MAX)
   {
     if (nECU_DigitalInput_getValue(TIM_List[ID].IC[channel_ic].Digi_Input))
-      TIM_List[ID].IC[channel_ic].CCR_Low = Difference;
+      data->CCR_Low = Difference;
     else
-      TIM_List[ID].IC[channel_ic].CCR_High = Difference;
+      data->CCR_High = Difference;
 
-    TIM_List[ID].IC[channel_ic].frequency = nECU_FloatToUint(TIM_List[ID].refClock / (TIM_List[ID].IC[channel_ic].CCR_High + TIM_List[ID].IC[channel_ic].CCR_Low), 16);
+    data->frequency = nECU_FloatToUint(TIM_List[ID].refClock / (data->CCR_High + data->CCR_Low), 16);
   }
   else
-    TIM_List[ID].IC[channel_ic].frequency = nECU_FloatToUint(TIM_List[ID].refClock / (Difference * 2), 16);
+    data->frequency = nECU_FloatToUint(TIM_List[ID].refClock / (Difference * 2), 16);
+  nECU_Seqlock_Write_End(&TIM_List[ID].IC[channel_ic].lock);
 
   TIM_List[ID].IC[channel_ic].CCR_prev = CurrentCCR;
-  TIM_List[ID].IC[channel_ic].newData = true;
   return false;
 }
 
@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ * @file    nECU_watchdog.c
+ * @brief   This file provides code for hardware watchdog (IWDG) fed only when
+ *          all critical modules checked in on time. Module that starved the
+ *          watchdog is kept in retained RAM until supervision recovers, and
+ *          reported after reset.
+ ******************************************************************************
+ */
+
+#include "nECU_watchdog.h"
+
+static nECU_Watchdog_Client const Watchdog_Client_List[] = {
+    {D_Main, 20},            // main loop pass
+    {D_Scheduler, 20},       // dispatcher
+    {D_Knock, 50},           // 1ms task, ignition retard
+    {D_CAN_TX, 50},          // 1ms task, frame transmission
+    {D_Frame_Stock_ID, 100}, // 10ms task, stock sensors frame
+}; // List of critical modules, checked only while they are working
+
+static nECU_Watchdog_Record watchdog_retained WATCHDOG_RETAINED; // survives reset, valid only after non power reset
+static nECU_Watchdog_Record watchdog_previous = {0};             // record of previous run, copied at start
+static nECU_Reset_Cause watchdog_reset_cause = RESET_CAUSE_UNKNOWN;
+static volatile bool watchdog_supervising = false;          // routine decides about feeding
+static volatile bool watchdog_hardware = false;             // IWDG started
+static volatile uint8_t watchdog_hold = 0;                  // depth of nested long blocking operations
+static uint16_t watchdog_hold_timeout[WATCHDOG_HOLD_DEPTH]; // timeout of each nested operation [ms]
+static volatile uint32_t watchdog_manager_tick = 0;         // tick of last manager pass
+static uint32_t watchdog_start_tick = 0;                    // modules are measured from this tick at most
+
+/* General functions */
+bool nECU_Watchdog_Start(void) // read reset cause and start IWDG
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_Watchdog))
+    {
+        watchdog_reset_cause = nECU_Watchdog_ReadResetCause();
+        if (watchdog_reset_cause == RESET_CAUSE_POWER) // retained RAM holds random data
+            memset(&watchdog_retained, 0, sizeof(nECU_Watchdog_Record));
+        else if (watchdog_reset_cause == RESET_CAUSE_IWDG)
+        {
+            watchdog_retained.reset_count++;
+            if (watchdog_retained.magic == WATCHDOG_RECORD_MAGIC)
+            {
+                watchdog_previous = watchdog_retained;
+                nECU_Debug_error_mesage temp;
+                nECU_Debug_Message_Set(&temp, watchdog_previous.starved, nECU_ERROR_WATCHDOG_ID);
+            }
+        }
+        watchdog_retained.magic = 0; // record only for this run
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_Watchdog);
+    }
+    if (!nECU_FlowControl_Working_Check(D_Watchdog) && status == false)
+    {
+        watchdog_start_tick = HAL_GetTick();
+        watchdog_manager_tick = watchdog_start_tick;
+        watchdog_supervising = true;
+#if WATCHDOG_ENABLE == true
+        nECU_Watchdog_Hardware_Start();
+#endif
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_Watchdog);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Watchdog);
+
+    return status;
+}
+bool nECU_Watchdog_Stop(void) // stop supervision, IWDG is then fed from SysTick
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_Watchdog) && status == false)
+    {
+        watchdog_supervising = false;
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_Watchdog);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_Watchdog);
+
+    return status;
+}
+void nECU_Watchdog_Routine(void) // feed IWDG if every critical module checked in within its deadline
+{
+    if (!nECU_FlowControl_Working_Check(D_Watchdog)) // Check if currently working
+    {
+        nECU_FlowControl_Error_Do(D_Watchdog);
+        return; // Break
+    }
+
+    uint32_t now = HAL_GetTick();
+    watchdog_manager_tick = now;
+    if (watchdog_hold) // Break, routine called from inside of blocking operation
+        return;
+    bool healthy = true;
+    for (uint8_t index = 0; index < sizeof(Watchdog_Client_List) / sizeof(Watchdog_Client_List[0]); index++)
+    {
+        nECU_Module_ID ID = Watchdog_Client_List[index].ID;
+        if (!nECU_FlowControl_Working_Check(ID)) // only working modules check in
+            continue;
+
+        nECU_TickTrack *track = &(nECU_Debug_ProgramBlockData_getPointer_Block(ID)->Update_ticks);
+        uint32_t last = track->previousTick;
+        if ((int32_t)(watchdog_start_tick - last) > 0) // not updated since supervision started
+            last = watchdog_start_tick;
+        uint32_t age = (now - last) * track->convFactor;
+        if (age > Watchdog_Client_List[index].deadline)
+        {
+            nECU_Watchdog_Record_Set(ID, age);
+            healthy = false;
+            break;
+        }
+    }
+
+    if (healthy)
+    {
+        nECU_Watchdog_Hardware_Refresh();
+        watchdog_retained.magic = 0; // recovered, reset that may follow has other cause
+    }
+
+    nECU_Debug_ProgramBlockData_Update(D_Watchdog);
+}
+void nECU_Watchdog_Hold(uint16_t timeout) // allow blocking operation (like flash erase) to take up to timeout [ms], can be nested
+{
+    if (watchdog_hold < WATCHDOG_HOLD_DEPTH)
+        watchdog_hold_timeout[watchdog_hold] = timeout;
+    watchdog_hold++;
+    if (watchdog_hardware)
+        nECU_Watchdog_Hardware_Config(WATCHDOG_HOLD_PRESCALER, (timeout / 8) + 1);
+}
+void nECU_Watchdog_Release(void) // end blocking operation, outermost one returns to normal timeout and deadlines are counted from now
+{
+    if (!watchdog_hold)
+        return;
+
+    watchdog_hold--;
+    if (watchdog_hold) // enclosing operation continues, its timeout is counted from now
+    {
+        uint8_t outer = (watchdog_hold < WATCHDOG_HOLD_DEPTH) ? watchdog_hold : WATCHDOG_HOLD_DEPTH;
+        if (watchdog_hardware)
+            nECU_Watchdog_Hardware_Config(WATCHDOG_HOLD_PRESCALER, (watchdog_hold_timeout[outer - 1] / 8) + 1);
+        return;
+    }
+
+    if (watchdog_hardware)
+        nECU_Watchdog_Hardware_Config(WATCHDOG_PRESCALER, WATCHDOG_TIMEOUT - 1);
+    watchdog_start_tick = HAL_GetTick();
+    watchdog_manager_tick = watchdog_start_tick;
+}
+
+static nECU_Reset_Cause nECU_Watchdog_ReadResetCause(void) // decode and clear RCC reset flags
+{
+    nECU_Reset_Cause cause = RESET_CAUSE_UNKNOWN;
+    if (__HAL_RCC_GET_FLAG(RCC_FLAG_BORRST) || __HAL_RCC_GET_FLAG(RCC_FLAG_PORRST)) // power on sets pin flag too, check first
+        cause = RESET_CAUSE_POWER;
+    else if (__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST))
+        cause = RESET_CAUSE_IWDG;
+    else if (__HAL_RCC_GET_FLAG(RCC_FLAG_WWDGRST))
+        cause = RESET_CAUSE_WWDG;
+    else if (__HAL_RCC_GET_FLAG(RCC_FLAG_LPWRRST))
+        cause = RESET_CAUSE_LOWPOWER;
+    else if (__HAL_RCC_GET_FLAG(RCC_FLAG_SFTRST))
+        cause = RESET_CAUSE_SOFTWARE;
+    else if (__HAL_RCC_GET_FLAG(RCC_FLAG_PINRST))
+        cause = RESET_CAUSE_PIN;
+
+    __HAL_RCC_CLEAR_RESET_FLAGS(); // flags are sticky, next reset has to be distinguished
+    return cause;
+}
+static void nECU_Watchdog_Record_Set(nECU_Module_ID starved, uint32_t age) // store starving module in retained RAM
+{
+    if (watchdog_retained.magic == WATCHDOG_RECORD_MAGIC) // keep first detection
+        return;
+
+    watchdog_retained.starved = starved;
+    watchdog_retained.running = nECU_Scheduler_getRunning();
+    watchdog_retained.age = age;
+    watchdog_retained.uptime = HAL_GetTick() - watchdog_start_tick;
+    watchdog_retained.magic = WATCHDOG_RECORD_MAGIC;
+}
+static void nECU_Watchdog_Hardware_Start(void) // configure and start IWDG
+{
+    __HAL_DBGMCU_FREEZE_IWDG(); // do not reset when halted by debugger
+
+    IWDG->KR = WATCHDOG_KEY_START;
+    nECU_Watchdog_Hardware_Config(WATCHDOG_PRESCALER, WATCHDOG_TIMEOUT - 1);
+    watchdog_hardware = true;
+}
+static void nECU_Watchdog_Hardware_Config(uint8_t prescaler, uint16_t reload) // write IWDG timing and reload counter
+{
+    if (reload > IWDG_RLR_RL) // limit to register width
+        reload = IWDG_RLR_RL;
+
+    IWDG->KR = WATCHDOG_KEY_ACCESS;
+    IWDG->PR = prescaler;
+    IWDG->RLR = reload;
+
+    uint32_t start = HAL_GetTick();
+    while ((IWDG->SR & (IWDG_SR_PVU | IWDG_SR_RVU)) && (HAL_GetTick() - start) < 50) // registers are updated in LSI domain
+        ;
+    IWDG->KR = WATCHDOG_KEY_REFRESH;
+}
+static void nECU_Watchdog_Hardware_Refresh(void) // reload IWDG counter
+{
+    if (watchdog_hardware)
+        IWDG->KR = WATCHDOG_KEY_REFRESH;
+}
+
+/* Interrupt functions */
+void nECU_Watchdog_Tick(void) // detect stalled main loop, to be called from 1ms timer interrupt
+{
+    if (!watchdog_hardware)
+        return;
+
+    if (!watchdog_supervising) // orderly stop, keep device running
+    {
+        nECU_Watchdog_Hardware_Refresh();
+        return;
+    }
+    if (watchdog_hold) // blocking operation, reload set by 'nECU_Watchdog_Hold' is its only deadline
+        return;
+
+    uint32_t age = HAL_GetTick() - watchdog_manager_tick;
+    if (age > WATCHDOG_MANAGER_DEADLINE) // manager does not run, blame block executed right now
+        nECU_Watchdog_Record_Set(D_Watchdog, age);
+}
+
+nECU_Reset_Cause nECU_Watchdog_getResetCause(void) // returns cause of last reset
+{
+    return watchdog_reset_cause;
+}
+nECU_Watchdog_Record *nECU_Watchdog_getRecord(void) // returns record of watchdog reset, NULL if last reset was not caused by watchdog
+{
+    if (watchdog_previous.magic != WATCHDOG_RECORD_MAGIC)
+        return NULL;
+
+    return &watchdog_previous;
+}
+void nECU_Watchdog_Report(void) // print reset cause and watchdog record over UART
+{
+    static const char *const Reset_Cause_Name_List[RESET_CAUSE_UNKNOWN + 1] = {
+        [RESET_CAUSE_POWER] = "power on",
+        [RESET_CAUSE_PIN] = "reset pin",
+        [RESET_CAUSE_SOFTWARE] = "software",
+        [RESET_CAUSE_IWDG] = "independent watchdog",
+        [RESET_CAUSE_WWDG] = "window watchdog",
+        [RESET_CAUSE_LOWPOWER] = "low power",
+        [RESET_CAUSE_UNKNOWN] = "unknown",
+    };
+
+    printf("Reset cause: %s, watchdog resets since power on: %lu\n\r", Reset_Cause_Name_List[watchdog_reset_cause], (unsigned long)watchdog_retained.reset_count);
+    nECU_Watchdog_Record *record = nECU_Watchdog_getRecord();
+    if (record == NULL)
+        return;
+
+    printf("Starved by: %s, no check in for %lu ms, after %lu ms of run\n\r", nECU_FlowControl_getName(record->starved), (unsigned long)record->age, (unsigned long)record->uptime);
+    if (record->running < D_ID_MAX)
+        printf("Dispatcher was executing: %s\n\r", nECU_FlowControl_getName(record->running));
+}
@@ -0,0 +1,615 @@
+/**
+ ******************************************************************************
+ * @file    nECU_xcp.c
+ * @brief   This file provides code for XCP on CAN slave.
+ *          Measurement by upload and DAQ lists sampled on scheduler tasks and
+ *          ADC callbacks, calibration by download into RAM calibration page.
+ ******************************************************************************
+ */
+
+#include "nECU_xcp.h"
+
+static nECU_XCP XCP_Slave = {0};
+
+_Static_assert(XCP_PID_MAX < XCP_CMD_ALLOC_ODT_ENTRY, "absolute ODT numbers overlap XCP command PIDs");
+
+/* General functions */
+bool nECU_XCP_Start(void) // prepare slave on 'hcan1'
+{
+    bool status = false;
+    if (!nECU_FlowControl_Initialize_Check(D_XCP))
+    {
+        nECU_XCP_Init(&XCP_Slave, XCP_DTO_ID, nECU_XCP_CAN_Send);
+        if (!status)
+            status |= !nECU_FlowControl_Initialize_Do(D_XCP);
+    }
+    if (!nECU_FlowControl_Working_Check(D_XCP) && status == false)
+    {
+        if (!status)
+            status |= !nECU_FlowControl_Working_Do(D_XCP);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_XCP);
+
+    return status;
+}
+bool nECU_XCP_Stop(void) // stop DAQ and disconnect
+{
+    bool status = false;
+    if (nECU_FlowControl_Working_Check(D_XCP) && status == false)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq(); // slave is used by CAN and ADC interrupts
+        nECU_XCP_DAQ_Free(&XCP_Slave);
+        XCP_Slave.connected = false;
+        __set_PRIMASK(primask);
+        if (!status)
+            status |= !nECU_FlowControl_Stop_Do(D_XCP);
+    }
+    if (status)
+        nECU_FlowControl_Error_Do(D_XCP);
+
+    return status;
+}
+void nECU_XCP_RX_Handler(nECU_CAN_RX_Frame_ID ID, uint8_t const *data, uint8_t length) // command from 'XCP_CRO_ID' received (called from interrupt)
+{
+    UNUSED(ID);
+    if (!nECU_FlowControl_Working_Check(D_XCP))
+        return;
+    nECU_XCP_Command(&XCP_Slave, data, length);
+}
+void nECU_XCP_Event(uint16_t channel) // sample DAQ lists of given event channel
+{
+    if (!XCP_Slave.connected) // quick exit, called after every task
+        return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // configuration can change from CAN interrupt, ODT has to be consistent
+    nECU_XCP_Event_Sample(&XCP_Slave, channel);
+    __set_PRIMASK(primask);
+}
+
+/* Slave functions, work on any bus */
+void nECU_XCP_Init(nECU_XCP *xcp, uint32_t DTO_ID, bool (*send)(uint32_t, uint8_t const *, uint8_t)) // prepare slave structure
+{
+    memset(xcp, 0, sizeof(*xcp));
+    xcp->DTO_ID = DTO_ID;
+    xcp->send = send;
+}
+void nECU_XCP_Command(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length) // process command and send response
+{
+    if (length == 0)
+        return;
+    if (!xcp->connected && cmd[0] != XCP_CMD_CONNECT) // slave stays silent until connected
+        return;
+
+    uint8_t res[8] = {XCP_PID_RES};
+    uint8_t res_length = 1;
+    uint8_t result = XCP_PID_RES;
+    xcp->command_count++;
+
+    switch (cmd[0])
+    {
+    case XCP_CMD_CONNECT:
+        xcp->connected = true;
+        res[1] = XCP_RESOURCE_CAL_PAG | XCP_RESOURCE_DAQ;
+        res[2] = 0x00; // Intel byte order, byte granularity, no block mode
+        res[3] = 8;    // MAX_CTO
+        res[4] = 8;    // MAX_DTO, little endian
+        res[5] = 0;
+        res[6] = 0x01; // protocol layer version
+        res[7] = 0x01; // transport layer version
+        res_length = 8;
+        break;
+    case XCP_CMD_DISCONNECT:
+        nECU_XCP_DAQ_Free(xcp);
+        xcp->connected = false;
+        break;
+    case XCP_CMD_GET_STATUS:
+        res[1] = nECU_XCP_isRunning(xcp) ? XCP_STATUS_DAQ_RUNNING : 0;
+        res[2] = 0; // no resource is protected
+        res[3] = 0;
+        res[4] = 0; // session configuration ID
+        res[5] = 0;
+        res_length = 6;
+        break;
+    case XCP_CMD_SYNCH:
+        result = XCP_ERR_CMD_SYNCH; // expected answer to SYNCH is this error
+        break;
+    case XCP_CMD_SET_MTA:
+    case XCP_CMD_UPLOAD:
+    case XCP_CMD_SHORT_UPLOAD:
+    case XCP_CMD_DOWNLOAD:
+    case XCP_CMD_SET_CAL_PAGE:
+    case XCP_CMD_GET_CAL_PAGE:
+        result = nECU_XCP_Command_Memory(xcp, cmd, length, res, &res_length);
+        break;
+    case XCP_CMD_SET_DAQ_PTR:
+    case XCP_CMD_WRITE_DAQ:
+    case XCP_CMD_SET_DAQ_LIST_MODE:
+    case XCP_CMD_START_STOP_DAQ_LIST:
+    case XCP_CMD_START_STOP_SYNCH:
+    case XCP_CMD_GET_DAQ_PROCESSOR_INFO:
+    case XCP_CMD_FREE_DAQ:
+    case XCP_CMD_ALLOC_DAQ:
+    case XCP_CMD_ALLOC_ODT:
+    case XCP_CMD_ALLOC_ODT_ENTRY:
+        result = nECU_XCP_Command_DAQ(xcp, cmd, length, res, &res_length);
+        break;
+    default:
+        result = XCP_ERR_CMD_UNKNOWN;
+        break;
+    }
+
+    if (result != XCP_PID_RES) // negative response
+    {
+        res[0] = XCP_PID_ERR;
+        res[1] = result;
+        res_length = 2;
+        xcp->error_count++;
+    }
+    else
+        xcp->previous = cmd[0];
+    xcp->send(xcp->DTO_ID, res, res_length);
+}
+void nECU_XCP_Event_Sample(nECU_XCP *xcp, uint16_t channel) // send DTOs of running DAQ lists of given event channel
+{
+    for (uint8_t daq = 0; daq < xcp->daq_count; daq++)
+    {
+        nECU_XCP_DAQ *list = &(xcp->daq[daq]);
+        if (!list->running || list->event != channel)
+            continue;
+        if (--list->prescaler_count) // not this time
+            continue;
+        list->prescaler_count = list->prescaler;
+
+        for (uint8_t odt = 0; odt < list->odt_count; odt++)
+        {
+            uint8_t frame[1 + XCP_DTO_PAYLOAD_MAX];
+            uint8_t length = 1;
+            frame[0] = (daq * XCP_ODT_MAX) + odt; // absolute ODT number
+            for (uint8_t entry = 0; entry < list->odt[odt].entry_count; entry++)
+            {
+                nECU_XCP_ODT_Entry const *current = &(list->odt[odt].entry[entry]);
+                if (length + current->size > sizeof(frame)) // never past DTO, whatever configuration says
+                    break;
+                memcpy(&frame[length], (uint8_t const *)current->address, current->size);
+                length += current->size;
+            }
+            if (xcp->send(xcp->DTO_ID, frame, length))
+                xcp->overload_count++;
+            else
+                xcp->dto_count++;
+        }
+    }
+}
+static uint8_t nECU_XCP_Command_Memory(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t *res, uint8_t *res_length) // memory access commands, returns error code or XCP_PID_RES
+{
+    switch (cmd[0])
+    {
+    case XCP_CMD_SET_MTA:
+        if (length < 8)
+            return XCP_ERR_CMD_SYNTAX;
+        xcp->MTA = nECU_XCP_getDword(&cmd[4]);
+        return XCP_PID_RES;
+
+    case XCP_CMD_SHORT_UPLOAD:
+        if (length < 8)
+            return XCP_ERR_CMD_SYNTAX;
+        xcp->MTA = nECU_XCP_getDword(&cmd[4]);
+        // fall through
+    case XCP_CMD_UPLOAD:
+        if (length < 2)
+            return XCP_ERR_CMD_SYNTAX;
+        if (cmd[1] == 0 || cmd[1] > 7) // response has to fit single frame
+            return XCP_ERR_OUT_OF_RANGE;
+        if (!nECU_XCP_isReadable(xcp->MTA, cmd[1]))
+            return XCP_ERR_ACCESS_DENIED;
+        nECU_Calibration_Read(xcp->MTA, &res[1], cmd[1]);
+        xcp->MTA += cmd[1];
+        *res_length = 1 + cmd[1];
+        return XCP_PID_RES;
+
+    case XCP_CMD_DOWNLOAD:
+        if (length < 2 || cmd[1] == 0 || cmd[1] > 6 || length < 2 + cmd[1])
+            return XCP_ERR_CMD_SYNTAX;
+        if (!nECU_Calibration_isInside(xcp->MTA, cmd[1])) // only calibration page can be written
+            return XCP_ERR_ACCESS_DENIED;
+        if (nECU_Calibration_Write(xcp->MTA, &cmd[2], cmd[1])) // reference page selected
+            return XCP_ERR_WRITE_PROTECTED;
+        xcp->MTA += cmd[1];
+        return XCP_PID_RES;
+
+    case XCP_CMD_SET_CAL_PAGE:
+        if (length < 4)
+            return XCP_ERR_CMD_SYNTAX;
+        if (cmd[2] != 0 && !(cmd[1] & XCP_PAGE_MODE_ALL)) // single segment
+            return XCP_ERR_SEGMENT_NOT_VALID;
+        if (nECU_Calibration_setPage(cmd[3], cmd[1] & XCP_PAGE_MODE_ECU, cmd[1] & XCP_PAGE_MODE_XCP))
+            return XCP_ERR_PAGE_NOT_VALID;
+        return XCP_PID_RES;
+
+    case XCP_CMD_GET_CAL_PAGE:
+        if (length < 3)
+            return XCP_ERR_CMD_SYNTAX;
+        if (cmd[2] != 0)
+            return XCP_ERR_SEGMENT_NOT_VALID;
+        res[1] = 0;
+        res[2] = 0;
+        res[3] = nECU_Calibration_getPage(cmd[1] == XCP_PAGE_MODE_XCP);
+        *res_length = 4;
+        return XCP_PID_RES;
+
+    default:
+        return XCP_ERR_CMD_UNKNOWN;
+    }
+}
+static uint8_t nECU_XCP_Command_DAQ(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t *res, uint8_t *res_length) // DAQ commands, returns error code or XCP_PID_RES
+{
+    uint16_t daq = (length >= 4) ? (cmd[2] | (cmd[3] << 8)) : 0; // most commands carry DAQ list number at the same place
+
+    switch (cmd[0])
+    {
+    case XCP_CMD_GET_DAQ_PROCESSOR_INFO:
+        res[1] = XCP_DAQ_PROPERTIES;
+        res[2] = XCP_DAQ_MAX; // MAX_DAQ, little endian
+        res[3] = 0;
+        res[4] = XCP_EVENT_MAX & 0xFF; // MAX_EVENT_CHANNEL, little endian
+        res[5] = XCP_EVENT_MAX >> 8;
+        res[6] = 0; // MIN_DAQ, no predefined lists
+        res[7] = XCP_DAQ_KEY_BYTE;
+        *res_length = 8;
+        return XCP_PID_RES;
+
+    case XCP_CMD_FREE_DAQ:
+        nECU_XCP_DAQ_Free(xcp);
+        return XCP_PID_RES;
+
+    case XCP_CMD_ALLOC_DAQ:
+        if (length < 4)
+            return XCP_ERR_CMD_SYNTAX;
+        if (nECU_XCP_isRunning(xcp))
+            return XCP_ERR_DAQ_ACTIVE;
+        if (xcp->daq_count) // lists have to be freed first
+            return XCP_ERR_SEQUENCE;
+        if (daq > XCP_DAQ_MAX)
+            return XCP_ERR_MEMORY_OVERFLOW;
+        memset(xcp->daq, 0, sizeof(xcp->daq));
+        xcp->daq_count = daq;
+        for (uint8_t current = 0; current < daq; current++) // sample every event until SET_DAQ_LIST_MODE says otherwise
+            xcp->daq[current].prescaler = 1;
+        return XCP_PID_RES;
+
+    case XCP_CMD_ALLOC_ODT:
+        if (length < 5)
+            return XCP_ERR_CMD_SYNTAX;
+        if (nECU_XCP_isRunning(xcp))
+            return XCP_ERR_DAQ_ACTIVE;
+        if (xcp->previous != XCP_CMD_ALLOC_DAQ && xcp->previous != XCP_CMD_ALLOC_ODT) // entries of ODTs already written must not be resized
+            return XCP_ERR_SEQUENCE;
+        if (daq >= xcp->daq_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        if (cmd[4] > XCP_ODT_MAX)
+            return XCP_ERR_MEMORY_OVERFLOW;
+        memset(xcp->daq[daq].odt, 0, sizeof(xcp->daq[daq].odt));
+        xcp->daq[daq].odt_count = cmd[4];
+        return XCP_PID_RES;
+
+    case XCP_CMD_ALLOC_ODT_ENTRY:
+        if (length < 6)
+            return XCP_ERR_CMD_SYNTAX;
+        if (nECU_XCP_isRunning(xcp))
+            return XCP_ERR_DAQ_ACTIVE;
+        if (xcp->previous != XCP_CMD_ALLOC_ODT && xcp->previous != XCP_CMD_ALLOC_ODT_ENTRY) // only ODTs allocated in this sequence, none of them written yet
+            return XCP_ERR_SEQUENCE;
+        if (daq >= xcp->daq_count || cmd[4] >= xcp->daq[daq].odt_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        if (cmd[5] > XCP_ODT_ENTRY_MAX)
+            return XCP_ERR_MEMORY_OVERFLOW;
+        memset(xcp->daq[daq].odt[cmd[4]].entry, 0, sizeof(xcp->daq[daq].odt[cmd[4]].entry));
+        xcp->daq[daq].odt[cmd[4]].entry_count = cmd[5];
+        return XCP_PID_RES;
+
+    case XCP_CMD_SET_DAQ_PTR:
+        if (length < 6)
+            return XCP_ERR_CMD_SYNTAX;
+        if (daq >= xcp->daq_count || cmd[4] >= xcp->daq[daq].odt_count || cmd[5] >= xcp->daq[daq].odt[cmd[4]].entry_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        if (xcp->daq[daq].running)
+            return XCP_ERR_DAQ_ACTIVE;
+        xcp->ptr_daq = daq;
+        xcp->ptr_odt = cmd[4];
+        xcp->ptr_entry = cmd[5];
+        return XCP_PID_RES;
+
+    case XCP_CMD_WRITE_DAQ:
+    {
+        if (length < 8)
+            return XCP_ERR_CMD_SYNTAX;
+        if (xcp->ptr_daq >= xcp->daq_count || xcp->daq[xcp->ptr_daq].running)
+            return XCP_ERR_SEQUENCE;
+        nECU_XCP_ODT *odt = &(xcp->daq[xcp->ptr_daq].odt[xcp->ptr_odt]);
+        if (xcp->ptr_entry >= odt->entry_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        uint32_t address = nECU_XCP_getDword(&cmd[4]);
+        if (cmd[1] != 0xFF || cmd[2] == 0) // bit access is not supported
+            return XCP_ERR_OUT_OF_RANGE;
+        if (!nECU_XCP_isReadable(address, cmd[2]))
+            return XCP_ERR_ACCESS_DENIED;
+
+        uint8_t size = cmd[2];
+        for (uint8_t entry = 0; entry < odt->entry_count; entry++) // whole ODT has to fit frame after PID
+            if (entry != xcp->ptr_entry)
+                size += odt->entry[entry].size;
+        if (size > XCP_DTO_PAYLOAD_MAX)
+            return XCP_ERR_DAQ_CONFIG;
+
+        odt->entry[xcp->ptr_entry].address = address;
+        odt->entry[xcp->ptr_entry].size = cmd[2];
+        xcp->ptr_entry++;
+        return XCP_PID_RES;
+    }
+
+    case XCP_CMD_SET_DAQ_LIST_MODE:
+    {
+        if (length < 8)
+            return XCP_ERR_CMD_SYNTAX;
+        if (daq >= xcp->daq_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        uint16_t event = cmd[4] | (cmd[5] << 8);
+        if (event >= XCP_EVENT_MAX)
+            return XCP_ERR_OUT_OF_RANGE;
+        if (cmd[1] & XCP_DAQ_MODE_TIMESTAMP)
+            return XCP_ERR_CMD_SYNTAX;
+        if (xcp->daq[daq].running)
+            return XCP_ERR_DAQ_ACTIVE;
+        xcp->daq[daq].mode = cmd[1];
+        xcp->daq[daq].event = event;
+        xcp->daq[daq].prescaler = cmd[6] ? cmd[6] : 1;
+        return XCP_PID_RES;
+    }
+
+    case XCP_CMD_START_STOP_DAQ_LIST:
+        if (length < 4)
+            return XCP_ERR_CMD_SYNTAX;
+        if (daq >= xcp->daq_count)
+            return XCP_ERR_OUT_OF_RANGE;
+        switch (cmd[1])
+        {
+        case XCP_START_STOP_STOP:
+            xcp->daq[daq].running = false;
+            break;
+        case XCP_START_STOP_START:
+            xcp->daq[daq].prescaler_count = xcp->daq[daq].prescaler;
+            xcp->daq[daq].running = true;
+            break;
+        case XCP_START_STOP_SELECT:
+            xcp->daq[daq].selected = true;
+            break;
+        default:
+            return XCP_ERR_OUT_OF_RANGE;
+        }
+        res[1] = daq * XCP_ODT_MAX; // FIRST_PID
+        *res_length = 2;
+        return XCP_PID_RES;
+
+    case XCP_CMD_START_STOP_SYNCH:
+        if (length < 2)
+            return XCP_ERR_CMD_SYNTAX;
+        for (uint8_t current = 0; current < xcp->daq_count; current++)
+        {
+            nECU_XCP_DAQ *list = &(xcp->daq[current]);
+            if (cmd[1] == XCP_SYNCH_STOP_ALL)
+                list->running = false;
+            else if (list->selected && cmd[1] == XCP_SYNCH_START_SELECTED)
+            {
+                list->prescaler_count = list->prescaler;
+                list->running = true;
+            }
+            else if (list->selected && cmd[1] == XCP_SYNCH_STOP_SELECTED)
+                list->running = false;
+            list->selected = false;
+        }
+        return XCP_PID_RES;
+
+    default:
+        return XCP_ERR_CMD_UNKNOWN;
+    }
+}
+static void nECU_XCP_DAQ_Free(nECU_XCP *xcp) // stop and drop all DAQ lists
+{
+    memset(xcp->daq, 0, sizeof(xcp->daq));
+    xcp->daq_count = 0;
+    xcp->ptr_daq = 0;
+    xcp->ptr_odt = 0;
+    xcp->ptr_entry = 0;
+}
+static bool nECU_XCP_isRunning(nECU_XCP const *xcp) // returns true if any DAQ list is running
+{
+    for (uint8_t daq = 0; daq < xcp->daq_count; daq++)
+        if (xcp->daq[daq].running)
+            return true;
+    return false;
+}
+static bool nECU_XCP_isReadable(uint32_t address, uint8_t size) // returns true if range lies in flash or RAM
+{
+    if (address >= FLASH_BASE && (address - FLASH_BASE) + size <= XCP_FLASH_SIZE)
+        return true;
+    if (address >= SRAM1_BASE && (address - SRAM1_BASE) + size <= XCP_SRAM_SIZE)
+        return true;
+    if (address >= CCMDATARAM_BASE && (address - CCMDATARAM_BASE) + size <= XCP_CCM_SIZE)
+        return true;
+    return false; // peripherals are not accessible, reading some registers clears flags
+}
+static uint32_t nECU_XCP_getDword(uint8_t const *data) // little endian address from command
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+static bool nECU_XCP_CAN_Send(uint32_t ID, uint8_t const *data, uint8_t length) // output of slave to 'hcan1' TX queue
+{
+    return nECU_CAN_TX_Send(ID, data, length);
+}
+
+/* Test */
+static uint8_t XCP_Test_Frame[8];   // last frame sent by test slave
+static uint8_t XCP_Test_Length = 0; // length of last frame, 0 if nothing was sent
+
+static bool nECU_XCP_test_Send(uint32_t ID, uint8_t const *data, uint8_t length) // captures last frame of test slave
+{
+    UNUSED(ID);
+    memcpy(XCP_Test_Frame, data, length);
+    XCP_Test_Length = length;
+    return false;
+}
+static bool nECU_XCP_test_Command(nECU_XCP *xcp, uint8_t const *cmd, uint8_t length, uint8_t expected) // send command, returns true if response starts with expected PID
+{
+    XCP_Test_Length = 0;
+    nECU_XCP_Command(xcp, cmd, length);
+    return XCP_Test_Length > 0 && XCP_Test_Frame[0] == expected;
+}
+bool nECU_XCP_test(bool logging_enable) // Run test
+{
+    if (logging_enable)
+        printf("Started test of nECU_xcp.c\n\r");
+
+    static nECU_XCP xcp;
+    static uint32_t measured32 = 0x12345678;
+    static uint16_t measured16 = 0xBEEF;
+    nECU_XCP_Init(&xcp, XCP_DTO_ID, nECU_XCP_test_Send);
+
+    // silent until connected, then basic session commands
+    uint8_t get_status[] = {XCP_CMD_GET_STATUS};
+    uint8_t connect[] = {XCP_CMD_CONNECT, 0};
+    XCP_Test_Length = 0;
+    nECU_XCP_Command(&xcp, get_status, sizeof(get_status));
+    if (XCP_Test_Length != 0 || !nECU_XCP_test_Command(&xcp, connect, sizeof(connect), XCP_PID_RES) || XCP_Test_Frame[3] != 8)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on connect\n\r");
+        return false;
+    }
+
+    // measurement by upload
+    uint32_t address = (uint32_t)&measured32;
+    uint8_t short_upload[] = {XCP_CMD_SHORT_UPLOAD, 4, 0, 0, address, address >> 8, address >> 16, address >> 24};
+    if (!nECU_XCP_test_Command(&xcp, short_upload, sizeof(short_upload), XCP_PID_RES) || memcmp(&XCP_Test_Frame[1], &measured32, 4))
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on upload\n\r");
+        return false;
+    }
+
+    // calibration of working page, reference page is write protected
+    float value = 0.25f;
+    uint32_t revision = nECU_Calibration_getRevision();
+    address = (uint32_t)&(nECU_Calibration_get()->general_alpha);
+    uint8_t set_mta[] = {XCP_CMD_SET_MTA, 0, 0, 0, address, address >> 8, address >> 16, address >> 24};
+    uint8_t download[6] = {XCP_CMD_DOWNLOAD, 4};
+    memcpy(&download[2], &value, sizeof(value));
+    uint8_t page_flash[] = {XCP_CMD_SET_CAL_PAGE, XCP_PAGE_MODE_ECU | XCP_PAGE_MODE_XCP, 0, CALIBRATION_PAGE_FLASH};
+    uint8_t page_ram[] = {XCP_CMD_SET_CAL_PAGE, XCP_PAGE_MODE_ECU | XCP_PAGE_MODE_XCP, 0, CALIBRATION_PAGE_RAM};
+    bool status = false;
+    status |= !nECU_XCP_test_Command(&xcp, set_mta, sizeof(set_mta), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, download, sizeof(download), XCP_PID_RES);
+    status |= nECU_Calibration_get()->general_alpha != value || nECU_Calibration_getRevision() == revision;
+    status |= !nECU_XCP_test_Command(&xcp, page_flash, sizeof(page_flash), XCP_PID_RES);
+    status |= nECU_Calibration_get()->general_alpha != GENERAL_SMOOTH_ALPHA;
+    status |= !nECU_XCP_test_Command(&xcp, set_mta, sizeof(set_mta), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, download, sizeof(download), XCP_PID_ERR) || XCP_Test_Frame[1] != XCP_ERR_WRITE_PROTECTED;
+    short_upload[4] = address; // working page address reads reference page through overlay
+    short_upload[5] = address >> 8;
+    short_upload[6] = address >> 16;
+    short_upload[7] = address >> 24;
+    float reference = GENERAL_SMOOTH_ALPHA;
+    status |= !nECU_XCP_test_Command(&xcp, short_upload, sizeof(short_upload), XCP_PID_RES) || memcmp(&XCP_Test_Frame[1], &reference, 4);
+    status |= !nECU_XCP_test_Command(&xcp, page_ram, sizeof(page_ram), XCP_PID_RES);
+    nECU_Calibration_Reset();
+    if (status)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on calibration\n\r");
+        return false;
+    }
+
+    // DAQ list with single ODT of two entries
+    uint32_t address32 = (uint32_t)&measured32, address16 = (uint32_t)&measured16;
+    uint8_t free_daq[] = {XCP_CMD_FREE_DAQ};
+    uint8_t alloc_daq[] = {XCP_CMD_ALLOC_DAQ, 0, 1, 0};
+    uint8_t alloc_odt[] = {XCP_CMD_ALLOC_ODT, 0, 0, 0, 1};
+    uint8_t alloc_entry[] = {XCP_CMD_ALLOC_ODT_ENTRY, 0, 0, 0, 0, 2};
+    uint8_t set_ptr[] = {XCP_CMD_SET_DAQ_PTR, 0, 0, 0, 0, 0};
+    uint8_t set_ptr_invalid[] = {XCP_CMD_SET_DAQ_PTR, 0, 0, 0, 0, 2};
+    uint8_t write32[] = {XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, address32, address32 >> 8, address32 >> 16, address32 >> 24};
+    uint8_t write16[] = {XCP_CMD_WRITE_DAQ, 0xFF, 2, 0, address16, address16 >> 8, address16 >> 16, address16 >> 24};
+    uint8_t mode[] = {XCP_CMD_SET_DAQ_LIST_MODE, 0, 0, 0, XCP_TEST_EVENT, 0, 2, 0}; // every second event
+    uint8_t start[] = {XCP_CMD_START_STOP_DAQ_LIST, XCP_START_STOP_START, 0, 0};
+    uint8_t disconnect[] = {XCP_CMD_DISCONNECT};
+    status |= !nECU_XCP_test_Command(&xcp, free_daq, sizeof(free_daq), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_daq, sizeof(alloc_daq), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_odt, sizeof(alloc_odt), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_entry, sizeof(alloc_entry), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, set_ptr_invalid, sizeof(set_ptr_invalid), XCP_PID_ERR);
+    status |= !nECU_XCP_test_Command(&xcp, set_ptr, sizeof(set_ptr), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, write32, sizeof(write32), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, write16, sizeof(write16), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, mode, sizeof(mode), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, start, sizeof(start), XCP_PID_RES) || XCP_Test_Frame[1] != 0;
+    if (status)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on DAQ configuration\n\r");
+        return false;
+    }
+
+    XCP_Test_Length = 0;
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT + 1); // other channel
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT);     // skipped by prescaler
+    status |= XCP_Test_Length != 0;
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT);
+    status |= XCP_Test_Length != 7 || XCP_Test_Frame[0] != 0;
+    status |= memcmp(&XCP_Test_Frame[1], &measured32, 4) || memcmp(&XCP_Test_Frame[5], &measured16, 2);
+    status |= !nECU_XCP_test_Command(&xcp, disconnect, sizeof(disconnect), XCP_PID_RES);
+    XCP_Test_Length = 0;
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT);
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT);
+    status |= XCP_Test_Length != 0;
+    if (status)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on DAQ sampling\n\r");
+        return false;
+    }
+
+    // allocation only in order and while stopped, DTO is never overrun
+    uint8_t stop[] = {XCP_CMD_START_STOP_DAQ_LIST, XCP_START_STOP_STOP, 0, 0};
+    uint8_t alloc_entry_max[] = {XCP_CMD_ALLOC_ODT_ENTRY, 0, 0, 0, 0, XCP_ODT_ENTRY_MAX};
+    status |= !nECU_XCP_test_Command(&xcp, connect, sizeof(connect), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_odt, sizeof(alloc_odt), XCP_PID_ERR) || XCP_Test_Frame[1] != XCP_ERR_SEQUENCE;
+    status |= !nECU_XCP_test_Command(&xcp, free_daq, sizeof(free_daq), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_daq, sizeof(alloc_daq), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_odt, sizeof(alloc_odt), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_entry, sizeof(alloc_entry), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, set_ptr, sizeof(set_ptr), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, write32, sizeof(write32), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, start, sizeof(start), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_entry_max, sizeof(alloc_entry_max), XCP_PID_ERR) || XCP_Test_Frame[1] != XCP_ERR_DAQ_ACTIVE;
+    status |= !nECU_XCP_test_Command(&xcp, stop, sizeof(stop), XCP_PID_RES);
+    status |= !nECU_XCP_test_Command(&xcp, alloc_entry_max, sizeof(alloc_entry_max), XCP_PID_ERR) || XCP_Test_Frame[1] != XCP_ERR_SEQUENCE; // would grow written ODT
+    xcp.daq[0].odt[0].entry[1].address = address32; // ODT longer than DTO anyway
+    xcp.daq[0].odt[0].entry[1].size = 4;
+    status |= !nECU_XCP_test_Command(&xcp, start, sizeof(start), XCP_PID_RES);
+    XCP_Test_Length = 0;
+    nECU_XCP_Event_Sample(&xcp, XCP_TEST_EVENT);
+    status |= XCP_Test_Length != 5 || memcmp(&XCP_Test_Frame[1], &measured32, 4);
+    status |= !nECU_XCP_test_Command(&xcp, disconnect, sizeof(disconnect), XCP_PID_RES);
+    if (status)
+    {
+        if (logging_enable)
+            printf("\n\rFAIL on DAQ allocation\n\r");
+        return false;
+    }
+
+    if (logging_enable)
+        printf("OK\n\r");
+    return true;
+}